@@ -0,0 +1,326 @@
+/*
+    Composite_System Class, series/parallel/feedback connection of two discrete systems
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPOSITE_SYSTEM_H
+#define COMPOSITE_SYSTEM_H
+
+/*! \file Composite_System.h
+    \brief This class represents the series, parallel or feedback connection of two discrete systems.
+*/
+
+#include <sun_systems_lib/Discrete_System_Interface.h>
+#include <algorithm>
+#include <vector>
+
+namespace sun
+{
+//!  Composite_System class: series, parallel or feedback connection of two discrete systems.
+/*!
+    The two systems are cloned, the signals between them run through buffers allocated by the constructor, so a step
+    does not allocate if the two systems do not.
+
+    \verbatim
+    SERIES:    u -> [first] -> [second] -> y
+    PARALLEL:  y = first(u) + second(u)
+    FEEDBACK:  u1(k) = u(k) + sign*y2(k-1),  y(k) = y1(k) = first(u1(k)),  y2(k) = second(y1(k))
+    \endverbatim
+
+    The feedback loop of generic (nonlinear) systems is broken with a one step delay on the feedback path
+    (Composition::makeFeedbackDelayed()).
+    For linear systems Composition::feedback() builds the exact (delay free) closed loop.
+
+    simulate_block() of SERIES and PARALLEL runs the block simulation of each system on chunks of SIMULATION_CHUNK
+    samples.
+
+    \sa Composition
+*/
+class Composite_System : public Discrete_System_Interface
+{
+public:
+  //! Type of connection
+  enum Type
+  {
+    SERIES,
+    PARALLEL,
+    FEEDBACK
+  };
+
+  //! Number of samples of the block buffers of simulate_block()
+  static const std::size_t SIMULATION_CHUNK = 256;
+
+private:
+  Composite_System();
+
+protected:
+  //! Connection type
+  Type type_;
+
+  //! First system (forward path for FEEDBACK)
+  Discrete_System_Interface_Ptr first_;
+
+  //! Second system (feedback path for FEEDBACK)
+  Discrete_System_Interface_Ptr second_;
+
+  //! Sign of the feedback
+  double sign_;
+
+  //! Output (for internal reference)
+  TooN::Vector<> output_;
+
+  //! INTERNAL Buffers: output of first_ (SERIES), output of second_ (PARALLEL, FEEDBACK), input of first_ (FEEDBACK)
+  TooN::Vector<> y1_, y2_, u1_;
+
+  //! INTERNAL Block buffers of simulate_block()
+  std::vector<double> block1_, block2_;
+
+  //! INTERNAL check the dimensions of the connection
+  void chek_dimensions() const
+  {
+    bool ok = true;
+    switch (type_)
+    {
+      case SERIES:
+        ok = first_->getSizeOutput() == second_->getSizeInput();
+        break;
+      case PARALLEL:
+        ok = first_->getSizeInput() == second_->getSizeInput() && first_->getSizeOutput() == second_->getSizeOutput();
+        break;
+      case FEEDBACK:
+        ok = first_->getSizeOutput() == second_->getSizeInput() && second_->getSizeOutput() == first_->getSizeInput();
+        break;
+    }
+    if (!ok)
+    {
+      throw std::invalid_argument("[Composite_System] Invalid dimensions of the systems");
+    }
+  }
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    \param type connection type
+    \param first first system (forward path for FEEDBACK), it is cloned
+    \param second second system (feedback path for FEEDBACK), it is cloned
+    \param sign sign of the feedback (default -1, negative feedback), used only by FEEDBACK
+  */
+  Composite_System(Type type, const Discrete_System_Interface& first, const Discrete_System_Interface& second,
+                   double sign = -1.0)
+    : type_(type)
+    , first_(first.clone())
+    , second_(second.clone())
+    , sign_(sign)
+    , output_(TooN::Zeros((type == SERIES) ? second.getSizeOutput() : first.getSizeOutput()))
+    , y1_(TooN::Zeros(first.getSizeOutput()))
+    , y2_(TooN::Zeros(second.getSizeOutput()))
+    , u1_(TooN::Zeros(first.getSizeInput()))
+  {
+    chek_dimensions();
+    if (type_ == SERIES)
+    {
+      block1_.resize(SIMULATION_CHUNK * first_->getSizeOutput());
+    }
+    else if (type_ == PARALLEL)
+    {
+      block2_.resize(SIMULATION_CHUNK * second_->getSizeOutput());
+    }
+  }
+
+  //! Copy Constructor, the systems are cloned
+  Composite_System(const Composite_System& sys)
+    : Discrete_System_Interface(sys)
+    , type_(sys.type_)
+    , first_(sys.first_->clone())
+    , second_(sys.second_->clone())
+    , sign_(sys.sign_)
+    , output_(sys.output_)
+    , y1_(sys.y1_)
+    , y2_(sys.y2_)
+    , u1_(sys.u1_)
+    , block1_(sys.block1_)
+    , block2_(sys.block2_)
+  {
+  }
+
+  virtual Composite_System* clone() const override
+  {
+    return new Composite_System(*this);
+  }
+
+  //! Destructor
+  virtual ~Composite_System() override = default;
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  //! Get the connection type
+  inline Type getType() const
+  {
+    return type_;
+  }
+
+  //! Get the first system (forward path for FEEDBACK)
+  inline const Discrete_System_Interface& getFirst() const
+  {
+    return *first_;
+  }
+
+  //! Get the second system (feedback path for FEEDBACK)
+  inline const Discrete_System_Interface& getSecond() const
+  {
+    return *second_;
+  }
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return first_->getSizeInput();
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return output_.size();
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  virtual const TooN::Vector<>& apply(const TooN::Vector<>& u_k) override
+  {
+    apply_into(u_k, output_);
+    return output_;
+  }
+
+  virtual void apply_into(const TooN::Vector<>& u_k, TooN::Vector<>& y_k) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    switch (type_)
+    {
+      case SERIES:
+        first_->apply_into(u_k, y1_);
+        second_->apply_into(y1_, y_k);
+        break;
+      case PARALLEL:
+        first_->apply_into(u_k, y_k);
+        second_->apply_into(u_k, y2_);
+        for (int i = 0; i < y_k.size(); i++)
+          y_k[i] += y2_[i];
+        break;
+      case FEEDBACK:
+        for (int i = 0; i < u1_.size(); i++)
+          u1_[i] = u_k[i] + sign_ * y2_[i];
+        first_->apply_into(u1_, y_k);
+        second_->apply_into(y_k, y2_);
+        break;
+    }
+    if (&y_k != &output_)
+    {
+      for (int i = 0; i < y_k.size(); i++)
+        output_[i] = y_k[i];
+    }
+  }
+
+  //! Simulate the system on a whole input trajectory
+  /*!
+    SERIES and PARALLEL run the simulate_block() of the two systems on chunks of SIMULATION_CHUNK samples,
+    FEEDBACK runs sample by sample.
+    \sa Discrete_System_Interface::simulate_block()
+  */
+  virtual void simulate_block(const double* U, double* Y, std::size_t num_samples) override
+  {
+    if (type_ == FEEDBACK)
+    {
+      Discrete_System_Interface::simulate_block(U, Y, num_samples);
+      return;
+    }
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    if (num_samples == 0)
+    {
+      return;
+    }
+    const unsigned int m = getSizeInput();
+    const unsigned int p = getSizeOutput();
+    const std::size_t max_chunk = SIMULATION_CHUNK;
+    for (std::size_t k0 = 0; k0 < num_samples; k0 += max_chunk)
+    {
+      const std::size_t chunk = std::min(num_samples - k0, max_chunk);
+      const double* U_k = U + k0 * m;
+      double* Y_k = Y + k0 * p;
+      if (type_ == SERIES)
+      {
+        first_->simulate_block(U_k, block1_.data(), chunk);
+        second_->simulate_block(block1_.data(), Y_k, chunk);
+      }
+      else
+      {
+        first_->simulate_block(U_k, Y_k, chunk);
+        second_->simulate_block(U_k, block2_.data(), chunk);
+        for (std::size_t i = 0; i < chunk * p; i++)
+          Y_k[i] += block2_[i];
+      }
+    }
+    for (unsigned int i = 0; i < p; i++)
+    {
+      output_[i] = Y[(num_samples - 1) * p + i];
+    }
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  virtual void reset() override
+  {
+    first_->reset();
+    second_->reset();
+    output_ = TooN::Zeros;
+    y1_ = TooN::Zeros;
+    y2_ = TooN::Zeros;
+    u1_ = TooN::Zeros;
+  }
+
+  virtual void display() const override
+  {
+    static const char* type_names[] = { "SERIES", "PARALLEL", "FEEDBACK" };
+    std::cout << "Composite_System " << type_names[type_] << ": " << getSizeInput() << " inputs, " << getSizeOutput()
+              << " outputs" << std::endl;
+    if (type_ == FEEDBACK)
+    {
+      std::cout << "sign: " << sign_ << std::endl;
+    }
+    std::cout << "first:" << std::endl;
+    first_->display();
+    std::cout << "second:" << std::endl;
+    second_->display();
+    getInstrumentation().display();
+    std::cout << "Composite_System [END]" << std::endl;
+  }
+
+  /*==============================================*/
+};
+
+using Composite_System_Ptr = std::unique_ptr<Composite_System>;
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,373 @@
+/*
+    Composition Class, series/parallel/feedback connection of discrete systems
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPOSITION_H
+#define COMPOSITION_H
+
+/*! \file Composition.h
+    \brief Series, parallel and feedback connection of discrete systems
+*/
+
+#include <sun_systems_lib/Composition/Composite_System.h>
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <sun_systems_lib/SS/SS_LINEAR_MODAL.h>
+#include <sun_systems_lib/SS/SS_LINEAR_SPARSE.h>
+#include <sun_systems_lib/SS/SS_Realization.h>
+#include <TooN/LU.h>
+
+namespace sun
+{
+//!  Composition class: static functions for the series, parallel and feedback connection of discrete systems.
+/*!
+    series(), parallel() and feedback() fuse two SS_LINEAR systems in a single SS_LINEAR (one fused matrix-vector
+    product per step instead of one per system plus the copies between them).
+    The state of the result is [x1; x2], initialized with the states of the two systems.
+
+    makeSeries() and makeParallel() take generic systems: if both are linear (isLinear()) they are converted with
+    toSS_LINEAR() and fused, otherwise they are connected by a Composite_System. The result is the same system in
+    both cases.
+    The feedback is different: makeFeedback() builds the exact closed loop and it accepts only linear systems,
+    makeFeedbackDelayed() builds a Composite_System with a one step delay on the feedback path for any system.
+
+    Connections (as in Composite_System):
+    \verbatim
+    SERIES:    u -> [sys1] -> [sys2] -> y
+    PARALLEL:  y = sys1(u) + sys2(u)
+    FEEDBACK:  u1 = u + sign*y2,  y = y1 = fwd(u1),  y2 = bwd(y1)
+    \endverbatim
+
+    The fused feedback is the exact closed loop (the algebraic loop of the feedthrough is solved once here).
+
+    \sa Composite_System, SS_Realization
+*/
+class Composition
+{
+private:
+  Composition();
+
+  //! INTERNAL M(r0:, c0:) = B
+  static void setBlock(TooN::Matrix<>& M, int r0, int c0, const TooN::Matrix<>& B)
+  {
+    for (int i = 0; i < B.num_rows(); i++)
+    {
+      for (int j = 0; j < B.num_cols(); j++)
+        M(r0 + i, c0 + j) = B(i, j);
+    }
+  }
+
+  //! INTERNAL v(i0:) = w
+  static void setBlock(TooN::Vector<>& v, int i0, const TooN::Vector<>& w)
+  {
+    for (int i = 0; i < w.size(); i++)
+    {
+      v[i0 + i] = w[i];
+    }
+  }
+
+  //! INTERNAL X = P^-1 Q
+  static TooN::Matrix<> solve(const TooN::Matrix<>& P, const TooN::Matrix<>& Q)
+  {
+    TooN::LU<> lu(P);
+    if (lu.get_info() != 0)
+    {
+      throw std::runtime_error("[Composition::feedback] Ill-posed feedback loop, the algebraic loop is singular");
+    }
+    return lu.backsub(Q);
+  }
+
+  //! INTERNAL Build the SS_LINEAR with state [x1; x2]
+  static SS_LINEAR makeSS(const TooN::Matrix<>& A, const TooN::Matrix<>& B, const TooN::Matrix<>& C,
+                          const TooN::Matrix<>& D, const SS_LINEAR& sys1, const SS_LINEAR& sys2)
+  {
+    SS_LINEAR ss(A, B, C, D);
+    TooN::Vector<> x = TooN::Zeros(A.num_rows());
+    setBlock(x, 0, sys1.getState());
+    setBlock(x, sys1.getSizeState(), sys2.getState());
+    ss.setState(x);
+    return ss;
+  }
+
+public:
+  //! True if the system is linear and can be converted by toSS_LINEAR()
+  /*!
+    The linear systems are SS_LINEAR, SS_LINEAR_MODAL, SS_LINEAR_SPARSE, TF_SISO, TF_SOS (and derived classes) and
+    TF_MIMO with TF_SISO or TF_SOS elements.
+  */
+  static bool isLinear(const Discrete_System_Interface& sys)
+  {
+    if (dynamic_cast<const SS_LINEAR*>(&sys) || dynamic_cast<const SS_LINEAR_MODAL*>(&sys) ||
+        dynamic_cast<const SS_LINEAR_SPARSE*>(&sys) || dynamic_cast<const TF_SISO*>(&sys) ||
+        dynamic_cast<const TF_SOS*>(&sys))
+    {
+      return true;
+    }
+    if (const TF_MIMO* mimo = dynamic_cast<const TF_MIMO*>(&sys))
+    {
+      for (unsigned int i = 0; i < mimo->getSizeOutput(); i++)
+      {
+        for (unsigned int j = 0; j < mimo->getSizeInput(); j++)
+        {
+          const SISO_System_Interface& siso = mimo->getSISO(i, j);
+          if (!dynamic_cast<const TF_SISO*>(&siso) && !dynamic_cast<const TF_SOS*>(&siso))
+          {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  //! Convert a linear system in a SS_LINEAR
+  /*!
+    The state space systems keep their (physical) state, the transfer functions are realized from rest
+    (SS_Realization::minimalRealization()), their internal memory is not transferred.
+    \param sys linear system (see isLinear())
+    \return the SS_LINEAR system
+  */
+  static SS_LINEAR toSS_LINEAR(const Discrete_System_Interface& sys)
+  {
+    if (const SS_LINEAR* ss = dynamic_cast<const SS_LINEAR*>(&sys))
+    {
+      return *ss;
+    }
+    if (const SS_LINEAR_MODAL* ss = dynamic_cast<const SS_LINEAR_MODAL*>(&sys))
+    {
+      SS_LINEAR out(ss->getA(), ss->getB(), ss->getC(), ss->getD());
+      out.setState(ss->getState());
+      return out;
+    }
+    if (const SS_LINEAR_SPARSE* ss = dynamic_cast<const SS_LINEAR_SPARSE*>(&sys))
+    {
+      SS_LINEAR out(ss->getA().toDense(), ss->getB().toDense(), ss->getC().toDense(), ss->getD().toDense());
+      out.setState(ss->getState());
+      return out;
+    }
+    if (const SISO_System_Interface* siso = dynamic_cast<const SISO_System_Interface*>(&sys))
+    {
+      return SS_Realization::minimalRealization(*siso);
+    }
+    if (const TF_MIMO* mimo = dynamic_cast<const TF_MIMO*>(&sys))
+    {
+      return SS_Realization::minimalRealization(*mimo);
+    }
+    throw std::invalid_argument("[Composition::toSS_LINEAR] The system is not linear");
+  }
+
+  /*=============LINEAR===========================*/
+
+  //! Series connection of two SS_LINEAR, u -> [sys1] -> [sys2] -> y
+  /*!
+    \verbatim
+    A = [A1 0; B2*C1*A1 A2],  B = [B1; B2*(C1*B1 + D1)],  C = [D2*C1 C2],  D = D2*D1
+    \endverbatim
+  */
+  static SS_LINEAR series(const SS_LINEAR& sys1, const SS_LINEAR& sys2)
+  {
+    if (sys1.getSizeOutput() != sys2.getSizeInput())
+    {
+      throw std::invalid_argument("[Composition::series] Invalid dimensions of the systems");
+    }
+    const TooN::Matrix<>&A1 = sys1.getA(), &B1 = sys1.getB(), &C1 = sys1.getC(), &D1 = sys1.getD();
+    const TooN::Matrix<>&A2 = sys2.getA(), &B2 = sys2.getB(), &C2 = sys2.getC(), &D2 = sys2.getD();
+    const int n1 = A1.num_rows();
+    const int n2 = A2.num_rows();
+    const int m = B1.num_cols();
+    const int p = C2.num_rows();
+
+    TooN::Matrix<> A = TooN::Zeros(n1 + n2, n1 + n2), B(n1 + n2, m), C(p, n1 + n2);
+    setBlock(A, 0, 0, A1);
+    setBlock(A, n1, 0, B2 * (C1 * A1));
+    setBlock(A, n1, n1, A2);
+    setBlock(B, 0, 0, B1);
+    setBlock(B, n1, 0, B2 * (C1 * B1 + D1));
+    setBlock(C, 0, 0, D2 * C1);
+    setBlock(C, 0, n1, C2);
+    return makeSS(A, B, C, D2 * D1, sys1, sys2);
+  }
+
+  //! Parallel connection of two SS_LINEAR, y = sys1(u) + sys2(u)
+  /*!
+    \verbatim
+    A = [A1 0; 0 A2],  B = [B1; B2],  C = [C1 C2],  D = D1 + D2
+    \endverbatim
+  */
+  static SS_LINEAR parallel(const SS_LINEAR& sys1, const SS_LINEAR& sys2)
+  {
+    if (sys1.getSizeInput() != sys2.getSizeInput() || sys1.getSizeOutput() != sys2.getSizeOutput())
+    {
+      throw std::invalid_argument("[Composition::parallel] Invalid dimensions of the systems");
+    }
+    const int n1 = sys1.getSizeState();
+    const int n2 = sys2.getSizeState();
+    const int m = sys1.getSizeInput();
+    const int p = sys1.getSizeOutput();
+
+    TooN::Matrix<> A = TooN::Zeros(n1 + n2, n1 + n2), B(n1 + n2, m), C(p, n1 + n2);
+    setBlock(A, 0, 0, sys1.getA());
+    setBlock(A, n1, n1, sys2.getA());
+    setBlock(B, 0, 0, sys1.getB());
+    setBlock(B, n1, 0, sys2.getB());
+    setBlock(C, 0, 0, sys1.getC());
+    setBlock(C, 0, n1, sys2.getC());
+    return makeSS(A, B, C, sys1.getD() + sys2.getD(), sys1, sys2);
+  }
+
+  //! Feedback connection of two SS_LINEAR, u1 = u + sign*y2, y = y1 = fwd(u1), y2 = bwd(y1)
+  /*!
+    Exact closed loop, without delays. With E1 = C1*B1 + D1, E2 = C2*B2 + D2 the state update is
+    \verbatim
+    y1(k) = (I - sign*E1*E2)^-1 * (C1*A1*x1(k-1) + sign*E1*C2*A2*x2(k-1) + E1*u(k))
+    u1(k) = u(k) + sign*(C2*A2*x2(k-1) + E2*y1(k))
+    x1(k) = A1*x1(k-1) + B1*u1(k),  x2(k) = A2*x2(k-1) + B2*y1(k)
+    \endverbatim
+    and the output is y(k) = (I - sign*D1*D2)^-1 * (C1*x1(k) + sign*D1*C2*x2(k) + D1*u(k)).
+    \param fwd forward system
+    \param bwd feedback system
+    \param sign sign of the feedback (default -1, negative feedback)
+    \return the closed loop system
+    \throw std::runtime_error if the algebraic loop is singular
+  */
+  static SS_LINEAR feedback(const SS_LINEAR& fwd, const SS_LINEAR& bwd, double sign = -1.0)
+  {
+    if (fwd.getSizeOutput() != bwd.getSizeInput() || bwd.getSizeOutput() != fwd.getSizeInput())
+    {
+      throw std::invalid_argument("[Composition::feedback] Invalid dimensions of the systems");
+    }
+    const TooN::Matrix<>&A1 = fwd.getA(), &B1 = fwd.getB(), &C1 = fwd.getC(), &D1 = fwd.getD();
+    const TooN::Matrix<>&A2 = bwd.getA(), &B2 = bwd.getB(), &C2 = bwd.getC(), &D2 = bwd.getD();
+    const int n1 = A1.num_rows();
+    const int n2 = A2.num_rows();
+    const int n = n1 + n2;
+    const int m = B1.num_cols();
+    const int p = C1.num_rows();
+    const TooN::Matrix<> Im = TooN::Identity(m);
+    const TooN::Matrix<> Ip = TooN::Identity(p);
+
+    const TooN::Matrix<> E1 = C1 * B1 + D1;
+    const TooN::Matrix<> E2 = C2 * B2 + D2;
+    const TooN::Matrix<> C2A2 = C2 * A2;
+
+    // y1(k) = Y*[x1(k-1); x2(k-1); u(k)]
+    TooN::Matrix<> R(p, n + m);
+    setBlock(R, 0, 0, C1 * A1);
+    setBlock(R, 0, n1, sign * (E1 * C2A2));
+    setBlock(R, 0, n, E1);
+    const TooN::Matrix<> Y = solve(Ip - sign * (E1 * E2), R);
+
+    // u1(k) = U1*[x1(k-1); x2(k-1); u(k)]
+    TooN::Matrix<> U1 = TooN::Zeros(m, n + m);
+    setBlock(U1, 0, n1, sign * C2A2);
+    setBlock(U1, 0, n, Im);
+    U1 += sign * (E2 * Y);
+
+    // [x1(k); x2(k)] = [A B]*[x1(k-1); x2(k-1); u(k)]
+    TooN::Matrix<> AB = TooN::Zeros(n, n + m);
+    setBlock(AB, 0, 0, A1);
+    setBlock(AB, n1, n1, A2);
+    const TooN::Matrix<> X1 = B1 * U1;
+    const TooN::Matrix<> X2 = B2 * Y;
+    for (int j = 0; j < n + m; j++)
+    {
+      for (int i = 0; i < n1; i++)
+        AB(i, j) += X1(i, j);
+      for (int i = 0; i < n2; i++)
+        AB(n1 + i, j) += X2(i, j);
+    }
+
+    // y(k) = [C D]*[x1(k); x2(k); u(k)]
+    TooN::Matrix<> S(p, n + m);
+    setBlock(S, 0, 0, C1);
+    setBlock(S, 0, n1, sign * (D1 * C2));
+    setBlock(S, 0, n, D1);
+    const TooN::Matrix<> CD = solve(Ip - sign * (D1 * D2), S);
+
+    return makeSS(AB.slice(0, 0, n, n), AB.slice(0, n, n, m), CD.slice(0, 0, p, n), CD.slice(0, n, p, m), fwd, bwd);
+  }
+
+  /*==============================================*/
+
+  /*=============GENERIC==========================*/
+
+  //! Series connection, u -> [sys1] -> [sys2] -> y
+  /*!
+    \return a SS_LINEAR if both systems are linear (isLinear()), a Composite_System otherwise
+  */
+  static Discrete_System_Interface_Ptr makeSeries(const Discrete_System_Interface& sys1,
+                                                  const Discrete_System_Interface& sys2)
+  {
+    if (isLinear(sys1) && isLinear(sys2))
+    {
+      return Discrete_System_Interface_Ptr(new SS_LINEAR(series(toSS_LINEAR(sys1), toSS_LINEAR(sys2))));
+    }
+    return Discrete_System_Interface_Ptr(new Composite_System(Composite_System::SERIES, sys1, sys2));
+  }
+
+  //! Parallel connection, y = sys1(u) + sys2(u)
+  /*!
+    \return a SS_LINEAR if both systems are linear (isLinear()), a Composite_System otherwise
+  */
+  static Discrete_System_Interface_Ptr makeParallel(const Discrete_System_Interface& sys1,
+                                                    const Discrete_System_Interface& sys2)
+  {
+    if (isLinear(sys1) && isLinear(sys2))
+    {
+      return Discrete_System_Interface_Ptr(new SS_LINEAR(parallel(toSS_LINEAR(sys1), toSS_LINEAR(sys2))));
+    }
+    return Discrete_System_Interface_Ptr(new Composite_System(Composite_System::PARALLEL, sys1, sys2));
+  }
+
+  //! Feedback connection, u1 = u + sign*y2, y = y1 = fwd(u1), y2 = bwd(y1)
+  /*!
+    The result is the exact closed loop SS_LINEAR, see feedback().
+    The exact loop of generic systems is not available, see makeFeedbackDelayed() for the connection with a one step
+    delay on the feedback path.
+    \throw std::invalid_argument if one of the systems is not linear (isLinear())
+  */
+  static Discrete_System_Interface_Ptr makeFeedback(const Discrete_System_Interface& fwd,
+                                                    const Discrete_System_Interface& bwd, double sign = -1.0)
+  {
+    if (!isLinear(fwd) || !isLinear(bwd))
+    {
+      throw std::invalid_argument("[Composition::makeFeedback] Both systems have to be linear, use "
+                                  "makeFeedbackDelayed() for generic systems");
+    }
+    return Discrete_System_Interface_Ptr(new SS_LINEAR(feedback(toSS_LINEAR(fwd), toSS_LINEAR(bwd), sign)));
+  }
+
+  //! Feedback with a one step delay on the feedback path, u1 = u + sign*y2(k-1), y = y1 = fwd(u1), y2 = bwd(y1)
+  /*!
+    The result is always a Composite_System (Composite_System::FEEDBACK), for any kind of system (linear or not).
+    It is not the same system of makeFeedback(), the delay changes the closed loop dynamics.
+  */
+  static Discrete_System_Interface_Ptr makeFeedbackDelayed(const Discrete_System_Interface& fwd,
+                                                           const Discrete_System_Interface& bwd, double sign = -1.0)
+  {
+    return Discrete_System_Interface_Ptr(new Composite_System(Composite_System::FEEDBACK, fwd, bwd, sign));
+  }
+
+  /*==============================================*/
+};
+
+}  // namespace sun
+
+#endif
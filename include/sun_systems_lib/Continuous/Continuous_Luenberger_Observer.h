@@ -109,6 +109,7 @@ public:
   inline virtual const TooN::Vector<> obs_state_fcn(const TooN::Vector<>& x_hat, const TooN::Vector<>& u,
                                                     const TooN::Vector<>& y) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
     return system_->state_fcn(x_hat, u) + L_ * (y - system_->output_fcn(x_hat, u));
   }
 
@@ -136,6 +137,7 @@ public:
   inline virtual const TooN::Vector<> obs_output_fcn(const TooN::Vector<>& x_hat,
                                                      const TooN::Vector<>& u) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
     return system_->output_fcn(x_hat, u);
   }
 
@@ -164,6 +166,7 @@ public:
   inline virtual const TooN::Matrix<> obs_jacob_state_fcn(const TooN::Vector<>& x_hat, const TooN::Vector<>& u,
                                                           const TooN::Vector<>& y) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
     return system_->jacob_state_fcn(x_hat, u) - L_ * system_->jacob_output_fcn(x_hat, u);
   }
 
@@ -191,6 +194,7 @@ public:
   inline virtual const TooN::Matrix<> obs_jacob_output_fcn(const TooN::Vector<>& x_hat,
                                                            const TooN::Vector<>& u) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
     return system_->jacob_output_fcn(x_hat, u);
   }
 
@@ -238,7 +242,13 @@ public:
   */
   virtual void display() const
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Continuous_Luenberger_Observer" CRESET << std::endl;
+    std::cout << "Continuous_Luenberger_Observer:" << std::endl
+              << "L:" << std::endl
+              << L_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "Observed system:" << std::endl;
+    system_->display();
+    std::cout << "Continuous_Luenberger_Observer [END]" << std::endl;
   }
 
   //! [Internal function]
@@ -202,7 +202,9 @@ public:
   */
   virtual void display() const
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Continuous_Observer_Interface" CRESET << std::endl;
+    std::cout << "Continuous_Observer: " << getSizeRealInput() << " inputs, " << getSizeOutput() << " measures, "
+              << getSizeState() << " states" << std::endl;
+    getInstrumentation().display();
   }
 };
 
@@ -35,6 +35,7 @@ namespace sun
 {
 typedef boost::function<TooN::Vector<>(const TooN::Vector<>&, const TooN::Vector<>&)> SS_FCN;
 typedef boost::function<TooN::Matrix<>(const TooN::Vector<>&, const TooN::Vector<>&)> SS_JACOB_FCN;
+typedef boost::function<void(const TooN::Vector<>&, const TooN::Vector<>&, TooN::Vector<>&)> SS_FCN_INTO;
 }  // namespace sun
 #endif
 
@@ -70,6 +71,9 @@ protected:
   //! output function Jacobian fcn F = jac_output(x,u)
   SS_JACOB_FCN jacob_output_fcn_;
 
+  //! Optional allocation free state and output functions (NULL = use state_fcn_ and output_fcn_)
+  SS_FCN_INTO state_fcn_into_, output_fcn_into_;
+
   //! state dimention
   unsigned int dim_state_;
   
@@ -137,26 +141,63 @@ public:
 
   inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
     return state_fcn_(x_k_1, u_k);
   }
 
   inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
     return output_fcn_(x_k, u_k);
   }
 
   inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_k_1,
                                                       const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
     return jacob_state_fcn_(x_k_1, u_k);
   }
 
   inline virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k,
                                                        const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
     return jacob_output_fcn_(x_k, u_k);
   }
 
+  inline virtual void state_fcn_into(const TooN::Vector<>& x, const TooN::Vector<>& u,
+                                     TooN::Vector<>& x_dot) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    if (state_fcn_into_)
+      state_fcn_into_(x, u, x_dot);
+    else
+      x_dot = state_fcn_(x, u);
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x, const TooN::Vector<>& u,
+                                      TooN::Vector<>& y) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    if (output_fcn_into_)
+      output_fcn_into_(x, u, y);
+    else
+      y = output_fcn_(x, u);
+  }
+
+  //! Set the allocation free versions of the state and output functions
+  /*!
+    They are used by the discretizators instead of the functions given in the constructor,
+    they must compute the same values.
+    \param state_fcn_into state function f(x,u,x_dot), x_dot is the output (NULL = not used)
+    \param output_fcn_into output function h(x,u,y), y is the output (NULL = not used)
+  */
+  void setFcnsInto(const SS_FCN_INTO& state_fcn_into, const SS_FCN_INTO& output_fcn_into)
+  {
+    state_fcn_into_ = state_fcn_into;
+    output_fcn_into_ = output_fcn_into;
+  }
+
   virtual const unsigned int getSizeInput() const override
   {
     return dim_input_;
@@ -174,7 +215,12 @@ public:
 
   virtual void display() const
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Continuous_System_Interface" CRESET << std::endl;
+    std::cout << "Continuous_System: " << dim_input_ << " inputs, " << dim_output_ << " outputs, " << dim_state_
+              << " states" << std::endl
+              << "Functions are defined run-time" << (state_fcn_into_ ? " (allocation free state_fcn_into)" : "")
+              << std::endl;
+    getInstrumentation().display();
+    std::cout << "Continuous_System [END]" << std::endl;
   }
 };
 
@@ -27,6 +27,7 @@
 */
 
 #include <TooN/TooN.h>
+#include <sun_systems_lib/Utils/Instrumentation.h>
 #include <memory>
 
 #ifndef SUN_COLORS
@@ -67,10 +68,15 @@ namespace sun
 
     You can't directly simulate a continuous system, you have to discretize it. See Discretizator_Interface, RK4.
 
-    \sa Continuous_System, Discretizator_Interface, RK4
+    If SUN_SYSTEMS_LIB_INSTRUMENTATION is defined, each object counts and times its function calls
+    (see getInstrumentation()).
+
+    \sa Continuous_System, Discretizator_Interface, RK4, Instrumentation
 */
 class Continuous_System_Interface
 {
+  SUN_SYSTEMS_LIB_INSTRUMENTATION_MEMBER
+
 private:
 protected:
 public:
@@ -116,6 +122,31 @@ public:
   */
   virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x, const TooN::Vector<>& u) const = 0;
 
+  //!  The state function, the state derivative is written in caller provided storage
+  /*!
+      Same of state_fcn(), x_dot must have the size of the state.
+      The default implementation calls state_fcn(), override it to avoid the heap allocations (see RK4).
+      \param x The system state
+      \param u The system input
+      \param x_dot The state derivative
+  */
+  virtual void state_fcn_into(const TooN::Vector<>& x, const TooN::Vector<>& u, TooN::Vector<>& x_dot) const
+  {
+    x_dot = state_fcn(x, u);
+  }
+
+  //!  The output function, the output is written in caller provided storage
+  /*!
+      Same of output_fcn(), y must have the size of the output.
+      \param x The system state
+      \param u The system input
+      \param y The system output
+  */
+  virtual void output_fcn_into(const TooN::Vector<>& x, const TooN::Vector<>& u, TooN::Vector<>& y) const
+  {
+    y = output_fcn(x, u);
+  }
+
   //!  The input size
   /*!
       \return the system input size
@@ -137,7 +168,9 @@ public:
   //! Display the system on the std out
   virtual void display() const
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Continuous_System_Interface" CRESET << std::endl;
+    std::cout << "Continuous_System: " << getSizeInput() << " inputs, " << getSizeOutput() << " outputs, "
+              << getSizeState() << " states" << std::endl;
+    getInstrumentation().display();
   }
 };
 
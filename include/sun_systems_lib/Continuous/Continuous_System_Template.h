@@ -0,0 +1,218 @@
+/*
+    Continuous_System_Template Class, generic continuous system with the functions as template parameters
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CONTINUOUS_SYSTEM_TEMPLATE_H
+#define CONTINUOUS_SYSTEM_TEMPLATE_H
+
+/*! \file Continuous_System_Template.h
+    \brief This class implements a generic continuous state space System with inlined functions
+*/
+
+#include <sun_systems_lib/Continuous/Continuous_System_Interface.h>
+#include <sun_systems_lib/Utils/Fcn_Invoker.h>
+
+namespace sun
+{
+//!  Continuous_System_Template class: generic continuous system with the functions as template parameters.
+/*!
+    Same of Continuous_System, but the functions are stored by value with their own type (lambdas, functors)
+    instead of boost::function, so the calls are direct and can be inlined:
+
+    x_dot = f(x,u)
+
+    y = h(x,u)
+
+    Each function can be given in the allocation free form f(x,u,out) or in the form out = f(x,u)
+    (see Fcn_Invoker). The Jacobians are optional (No_Jacobian throws).
+    The class is final: RK4_Template calls the functions of a Continuous_System_Template without virtual dispatch.
+    Use makeContinuousSystem() to deduce the template parameters.
+
+    \sa Continuous_System, RK4_Template, Fcn_Invoker
+*/
+template <class State_Fcn, class Output_Fcn, class Jacob_State_Fcn = No_Jacobian,
+          class Jacob_Output_Fcn = No_Jacobian>
+class Continuous_System_Template final : public Continuous_System_Interface
+{
+private:
+  Continuous_System_Template();
+
+protected:
+  //! state function x_dot = f(x,u)
+  State_Fcn state_fcn_;
+
+  //! output function y = h(x,u)
+  Output_Fcn output_fcn_;
+
+  //! state function Jacobian fcn F = jac_state(x,u)
+  Jacob_State_Fcn jacob_state_fcn_;
+
+  //! output function Jacobian fcn H = jac_output(x,u)
+  Jacob_Output_Fcn jacob_output_fcn_;
+
+  //! Dimensions
+  unsigned int dim_state_, dim_output_, dim_input_;
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    \param dim_state State dimension
+    \param dim_output Output dimension
+    \param dim_input Input dimension
+    \param state_fcn state function x_dot = f(x,u)
+    \param output_fcn output function y = h(x,u)
+    \param jacob_state_fcn state function Jacobian fcn F = jac_state(x,u) (default No_Jacobian)
+    \param jacob_output_fcn output function Jacobian fcn H = jac_output(x,u) (default No_Jacobian)
+  */
+  Continuous_System_Template(unsigned int dim_state, unsigned int dim_output, unsigned int dim_input,
+                             const State_Fcn& state_fcn, const Output_Fcn& output_fcn,
+                             const Jacob_State_Fcn& jacob_state_fcn = Jacob_State_Fcn(),
+                             const Jacob_Output_Fcn& jacob_output_fcn = Jacob_Output_Fcn())
+    : state_fcn_(state_fcn)
+    , output_fcn_(output_fcn)
+    , jacob_state_fcn_(jacob_state_fcn)
+    , jacob_output_fcn_(jacob_output_fcn)
+    , dim_state_(dim_state)
+    , dim_output_(dim_output)
+    , dim_input_(dim_input)
+  {
+  }
+
+  //! Copy constructor
+  Continuous_System_Template(const Continuous_System_Template& ss) = default;
+
+  //! Clone Constructor
+  virtual Continuous_System_Template* clone() const override
+  {
+    return new Continuous_System_Template(*this);
+  }
+
+  virtual ~Continuous_System_Template() override = default;
+
+  /*==============================================*/
+
+  /*=============SS FUNCTIONS=====================*/
+
+  inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x, const TooN::Vector<>& u) const override
+  {
+    TooN::Vector<> x_dot(dim_state_);
+    state_fcn_into(x, u, x_dot);
+    return x_dot;
+  }
+
+  inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x, const TooN::Vector<>& u) const override
+  {
+    TooN::Vector<> y(dim_output_);
+    output_fcn_into(x, u, y);
+    return y;
+  }
+
+  inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x, const TooN::Vector<>& u) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    TooN::Matrix<> F(dim_state_, dim_state_);
+    Fcn_Invoker::into(jacob_state_fcn_, x, u, F);
+    return F;
+  }
+
+  inline virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x,
+                                                       const TooN::Vector<>& u) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    TooN::Matrix<> H(dim_output_, dim_state_);
+    Fcn_Invoker::into(jacob_output_fcn_, x, u, H);
+    return H;
+  }
+
+  inline virtual void state_fcn_into(const TooN::Vector<>& x, const TooN::Vector<>& u,
+                                     TooN::Vector<>& x_dot) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    Fcn_Invoker::into(state_fcn_, x, u, x_dot);
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x, const TooN::Vector<>& u,
+                                      TooN::Vector<>& y) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    Fcn_Invoker::into(output_fcn_, x, u, y);
+  }
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return dim_input_;
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return dim_output_;
+  }
+
+  virtual const unsigned int getSizeState() const override
+  {
+    return dim_state_;
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  virtual void display() const override
+  {
+    std::cout << "Continuous_System_Template: " << dim_input_ << " inputs, " << dim_output_ << " outputs, "
+              << dim_state_ << " states" << std::endl
+              << "Functions are defined at compile time" << std::endl;
+    getInstrumentation().display();
+    std::cout << "Continuous_System_Template [END]" << std::endl;
+  }
+
+  /*==============================================*/
+};
+
+//! Build a Continuous_System_Template deducing the types of the functions, the Jacobians are not defined
+template <class State_Fcn, class Output_Fcn>
+Continuous_System_Template<State_Fcn, Output_Fcn> makeContinuousSystem(unsigned int dim_state, unsigned int dim_output,
+                                                                       unsigned int dim_input,
+                                                                       const State_Fcn& state_fcn,
+                                                                       const Output_Fcn& output_fcn)
+{
+  return Continuous_System_Template<State_Fcn, Output_Fcn>(dim_state, dim_output, dim_input, state_fcn, output_fcn);
+}
+
+//! Build a Continuous_System_Template deducing the types of the functions and of the Jacobians
+template <class State_Fcn, class Output_Fcn, class Jacob_State_Fcn, class Jacob_Output_Fcn>
+Continuous_System_Template<State_Fcn, Output_Fcn, Jacob_State_Fcn, Jacob_Output_Fcn>
+makeContinuousSystem(unsigned int dim_state, unsigned int dim_output, unsigned int dim_input,
+                     const State_Fcn& state_fcn, const Output_Fcn& output_fcn, const Jacob_State_Fcn& jacob_state_fcn,
+                     const Jacob_Output_Fcn& jacob_output_fcn)
+{
+  return Continuous_System_Template<State_Fcn, Output_Fcn, Jacob_State_Fcn, Jacob_Output_Fcn>(
+      dim_state, dim_output, dim_input, state_fcn, output_fcn, jacob_state_fcn, jacob_output_fcn);
+}
+
+}  // namespace sun
+
+#endif
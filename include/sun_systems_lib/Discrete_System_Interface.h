@@ -27,7 +27,9 @@
 */
 
 #include <TooN/TooN.h>
+#include <sun_systems_lib/Utils/Instrumentation.h>
 #include <memory>
+#include <stdexcept>
 
 #ifndef SUN_COLORS
 #define SUN_COLORS
@@ -71,10 +73,14 @@ namespace sun
 
     It stores the internal system state
 
-    \sa Discretizator_Interface, RK4
+    If SUN_SYSTEMS_LIB_INSTRUMENTATION is defined, each object counts and times its calls (see getInstrumentation()).
+
+    \sa Discretizator_Interface, RK4, Instrumentation
 */
 class Discrete_System_Interface
 {
+  SUN_SYSTEMS_LIB_INSTRUMENTATION_MEMBER
+
 private:
 protected:
 public:
@@ -93,6 +99,85 @@ public:
   */
   virtual const TooN::Vector<>& apply(const TooN::Vector<>& u_k) = 0;
 
+  //! Apply the system, the output is written in caller provided storage
+  /*!
+    Same of apply(), y_k must have the size of the output.
+    No heap allocation is performed if the system implements an allocation free apply() (the SS systems
+    do it through SS_Interface::state_fcn_into() and SS_Interface::output_fcn_into()).
+    \param u_k Input at the current step u(k)
+    \param y_k output y(k)
+  */
+  virtual void apply_into(const TooN::Vector<>& u_k, TooN::Vector<>& y_k)
+  {
+    y_k = apply(u_k);
+  }
+
+  //! Simulate the system on a whole input trajectory
+  /*!
+    Row-major trajectories: the sample k is the row k, U has getSizeInput() columns, Y has getSizeOutput() columns.
+    It is equivalent to
+
+    \verbatim
+    for (k = 0; k < num_samples; k++)
+      Y[k] = apply(U[k]);
+    \endverbatim
+
+    The final state is the same of the sample by sample execution.
+    The default implementation calls apply_into(), derived classes override it with a specialized loop.
+    \param U input trajectory, size num_samples*getSizeInput()
+    \param Y output trajectory, size num_samples*getSizeOutput(), it must not overlap U
+    \param num_samples number of samples
+  */
+  virtual void simulate_block(const double* U, double* Y, std::size_t num_samples)
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    const unsigned int size_input = getSizeInput();
+    const unsigned int size_output = getSizeOutput();
+    TooN::Vector<> u_k(size_input), y_k(size_output);
+    for (std::size_t k = 0; k < num_samples; k++)
+    {
+      for (unsigned int i = 0; i < size_input; i++)
+      {
+        u_k[i] = U[k * size_input + i];
+      }
+      apply_into(u_k, y_k);
+      for (unsigned int i = 0; i < size_output; i++)
+      {
+        Y[k * size_output + i] = y_k[i];
+      }
+    }
+  }
+
+  //! Simulate the system on a whole input trajectory, the output is written in Y
+  /*!
+    The rows are the samples: U is num_samples x getSizeInput(), Y is num_samples x getSizeOutput().
+    The matrices are row-major, the data are passed to simulate_block() without copies.
+  */
+  void simulate_into(const TooN::Matrix<>& U, TooN::Matrix<>& Y)
+  {
+    if (U.num_cols() != (int)getSizeInput() || Y.num_cols() != (int)getSizeOutput() || Y.num_rows() != U.num_rows())
+    {
+      throw std::invalid_argument("[Discrete_System_Interface::simulate_into] Invalid matrix dimensions");
+    }
+    if (U.num_rows() != 0)
+    {
+      simulate_block(U.get_data_ptr(), Y.get_data_ptr(), U.num_rows());
+    }
+  }
+
+  //! Simulate the system on a whole input trajectory
+  /*!
+    \param U input trajectory num_samples x getSizeInput(), the row k is u(k)
+    \return output trajectory num_samples x getSizeOutput(), the row k is y(k)
+    \sa simulate_into(), simulate_block()
+  */
+  TooN::Matrix<> simulate(const TooN::Matrix<>& U)
+  {
+    TooN::Matrix<> Y(U.num_rows(), getSizeOutput());
+    simulate_into(U, Y);
+    return Y;
+  }
+
   //! Reset the system
   /*!
     Reset the system state to a zero value
@@ -108,7 +193,8 @@ public:
   //! Dysplay the system on the std out
   virtual void display() const
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Discrete_System_Interface" CRESET << std::endl;
+    std::cout << "Discrete_System: " << getSizeInput() << " inputs, " << getSizeOutput() << " outputs" << std::endl;
+    getInstrumentation().display();
   }
 };
 
@@ -104,7 +104,10 @@ public:
 
   virtual void display() const override
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Discretizator_Interface" CRESET << std::endl;
+    std::cout << "Discretizator: " << getSizeInput() << " inputs, " << getSizeOutput() << " outputs, "
+              << getSizeState() << " states" << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
   }
 };
 
@@ -0,0 +1,256 @@
+/*
+    Exact_Discretizator Class, exact discretization of linear continuous systems
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EXACT_DISCRETIZATOR_H
+#define EXACT_DISCRETIZATOR_H
+
+/*! \file Exact_Discretizator.h
+    \brief Exact (zero order hold and first order hold) discretization of linear continuous systems
+*/
+
+#include <sun_systems_lib/Continuous/Continuous_System_Interface.h>
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <sun_systems_lib/Utils/Matrix_Exponential.h>
+
+namespace sun
+{
+//!  Exact_Discretizator class: static functions for the exact discretization of linear continuous systems.
+/*!
+    The linear continuous system
+
+    \verbatim
+    x_dot = A*x + B*u
+    y = C*x + D*u
+    \endverbatim
+
+    is discretized with sampling time Ts in a SS_LINEAR (x(k) = Ad*x(k-1) + Bd*u(k), y(k) = Cd*x(k) + Dd*u(k)).
+    The exponentials are computed once (Matrix_Exponential::expm()), the discrete system has no integration error
+    and each step is a single fused matrix-vector product.
+
+    The input u(k) of a step is the input on the interval (t(k-1), t(k)], as in RK4:
+
+    - ZOH: u is constant on the interval, as in RK4::state_fcn() with use_previous_input_everywhere = false.
+      Ad = e^(A*Ts), Bd = int_0^Ts e^(A*s) ds B, Cd = C, Dd = D.
+    - FOH: u goes linearly from u(k-1) to u(k), as in RK4::apply(). The memory of u(k-1) is moved in the state:
+      the state of the discrete system is xi(k) = x(k) + M*u(k), with M = Ad^-1*(G1-G2), and
+
+      \verbatim
+      Ad = e^(A*Ts), Bd = G2 + M, Cd = C, Dd = D - C*M
+      \endverbatim
+
+      where G1 is the ZOH input matrix and G2 = 1/Ts int_0^Ts e^(A*s) (Ts-s) ds B.
+
+    The integrals are the blocks of the exponential of an augmented matrix (Van Loan).
+
+    \sa RK4, SS_LINEAR, Matrix_Exponential
+*/
+class Exact_Discretizator
+{
+private:
+  Exact_Discretizator();
+
+  //! INTERNAL check the dimensions of A, B, C, D
+  static void chek_dimensions(const TooN::Matrix<>& A, const TooN::Matrix<>& B, const TooN::Matrix<>& C,
+                              const TooN::Matrix<>& D)
+  {
+    if (A.num_rows() != A.num_cols() || A.num_rows() != B.num_rows() || A.num_cols() != C.num_cols() ||
+        B.num_cols() != D.num_cols() || C.num_rows() != D.num_rows())
+    {
+      throw std::invalid_argument("[Exact_Discretizator] Invalid matrix dimensions");
+    }
+  }
+
+public:
+  //! Hold of the input between two samples
+  enum Hold
+  {
+    ZOH,  //!< Zero order hold, u constant on the sampling interval
+    FOH   //!< First order hold, u linear between two samples
+  };
+
+  //! Discretize the state equation with a zero order hold
+  /*!
+    \param A continuous state matrix
+    \param B continuous input matrix
+    \param Ts sampling time
+    \param Ad discrete state matrix (output)
+    \param Bd discrete input matrix (output)
+  */
+  static void zoh(const TooN::Matrix<>& A, const TooN::Matrix<>& B, double Ts, TooN::Matrix<>& Ad,
+                  TooN::Matrix<>& Bd)
+  {
+    if (!(Ts > 0.0))
+    {
+      throw std::invalid_argument("[Exact_Discretizator] The sampling time has to be positive");
+    }
+    const int n = A.num_rows();
+    const int m = B.num_cols();
+
+    // e^([A B; 0 0]*Ts) = [Ad Bd; 0 I]
+    TooN::Matrix<> M = TooN::Zeros(n + m, n + m);
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < n; j++)
+        M(i, j) = A(i, j) * Ts;
+      for (int j = 0; j < m; j++)
+        M(i, n + j) = B(i, j) * Ts;
+    }
+    const TooN::Matrix<> E = Matrix_Exponential::expm(M);
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < n; j++)
+        Ad(i, j) = E(i, j);
+      for (int j = 0; j < m; j++)
+        Bd(i, j) = E(i, n + j);
+    }
+  }
+
+  //! Discretize the state equation with a first order hold
+  /*!
+    \param A continuous state matrix
+    \param B continuous input matrix
+    \param Ts sampling time
+    \param Ad discrete state matrix e^(A*Ts) (output)
+    \param G1 int_0^Ts e^(A*s) ds B (output)
+    \param G2 1/Ts int_0^Ts e^(A*s) (Ts-s) ds B (output)
+  */
+  static void foh(const TooN::Matrix<>& A, const TooN::Matrix<>& B, double Ts, TooN::Matrix<>& Ad,
+                  TooN::Matrix<>& G1, TooN::Matrix<>& G2)
+  {
+    if (!(Ts > 0.0))
+    {
+      throw std::invalid_argument("[Exact_Discretizator] The sampling time has to be positive");
+    }
+    const int n = A.num_rows();
+    const int m = B.num_cols();
+
+    // e^([A B 0; 0 0 I/Ts; 0 0 0]*Ts) = [Ad G1 G2; 0 I I; 0 0 I]
+    TooN::Matrix<> M = TooN::Zeros(n + 2 * m, n + 2 * m);
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < n; j++)
+        M(i, j) = A(i, j) * Ts;
+      for (int j = 0; j < m; j++)
+        M(i, n + j) = B(i, j) * Ts;
+    }
+    for (int i = 0; i < m; i++)
+    {
+      M(n + i, n + m + i) = 1.0;
+    }
+    const TooN::Matrix<> E = Matrix_Exponential::expm(M);
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < n; j++)
+        Ad(i, j) = E(i, j);
+      for (int j = 0; j < m; j++)
+      {
+        G1(i, j) = E(i, n + j);
+        G2(i, j) = E(i, n + m + j);
+      }
+    }
+  }
+
+  //! Discretize the linear system A, B, C, D
+  /*!
+    \param A continuous state matrix
+    \param B continuous input matrix
+    \param C output matrix
+    \param D feedthrough matrix
+    \param Ts sampling time
+    \param hold input hold (default ZOH), see the class description
+    \return the discrete system
+  */
+  static SS_LINEAR discretize(const TooN::Matrix<>& A, const TooN::Matrix<>& B, const TooN::Matrix<>& C,
+                              const TooN::Matrix<>& D, double Ts, Hold hold = ZOH)
+  {
+    chek_dimensions(A, B, C, D);
+    const int n = A.num_rows();
+    const int m = B.num_cols();
+
+    TooN::Matrix<> Ad(n, n), Bd(n, m);
+    if (hold == ZOH)
+    {
+      zoh(A, B, Ts, Ad, Bd);
+      return SS_LINEAR(Ad, Bd, C, D);
+    }
+
+    TooN::Matrix<> G1(n, m), G2(n, m);
+    foh(A, B, Ts, Ad, G1, G2);
+    // M = Ad^-1*(G1-G2), Ad = e^(A*Ts) is never singular
+    TooN::LU<> lu(Ad);
+    const TooN::Matrix<> M = lu.backsub(G1 - G2);
+    Bd = G2 + M;
+    return SS_LINEAR(Ad, Bd, C, D - C * M);
+  }
+
+  //! Discretize a linear continuous system
+  /*!
+    The matrices are extracted from the system: A and C are the Jacobians in (0,0), the columns of B and D are the
+    responses to the unit inputs f(0,e_j) and h(0,e_j).
+    The system has to be linear (f(0,0) = 0 and h(0,0) = 0 are checked).
+
+    \param system linear continuous system
+    \param Ts sampling time
+    \param hold input hold (default ZOH), see the class description
+    \return the discrete system
+  */
+  static SS_LINEAR discretize(const Continuous_System_Interface& system, double Ts, Hold hold = ZOH)
+  {
+    const int n = system.getSizeState();
+    const int m = system.getSizeInput();
+    const int p = system.getSizeOutput();
+    const TooN::Vector<> x0 = TooN::Zeros(n);
+    TooN::Vector<> u = TooN::Zeros(m);
+
+    const TooN::Vector<> f0 = system.state_fcn(x0, u);
+    const TooN::Vector<> h0 = system.output_fcn(x0, u);
+    for (int i = 0; i < n; i++)
+    {
+      if (f0[i] != 0.0)
+        throw std::invalid_argument("[Exact_Discretizator] The system is not linear, state_fcn(0,0) != 0");
+    }
+    for (int i = 0; i < p; i++)
+    {
+      if (h0[i] != 0.0)
+        throw std::invalid_argument("[Exact_Discretizator] The system is not linear, output_fcn(0,0) != 0");
+    }
+
+    const TooN::Matrix<> A = system.jacob_state_fcn(x0, u);
+    const TooN::Matrix<> C = system.jacob_output_fcn(x0, u);
+    TooN::Matrix<> B(n, m), D(p, m);
+    for (int j = 0; j < m; j++)
+    {
+      u = TooN::Zeros;
+      u[j] = 1.0;
+      const TooN::Vector<> f = system.state_fcn(x0, u);
+      const TooN::Vector<> h = system.output_fcn(x0, u);
+      for (int i = 0; i < n; i++)
+        B(i, j) = f[i];
+      for (int i = 0; i < p; i++)
+        D(i, j) = h[i];
+    }
+    return discretize(A, B, C, D, Ts, hold);
+  }
+};
+
+}  // namespace sun
+
+#endif
@@ -36,6 +36,10 @@ namespace sun
 /*!
     Is a State Space system obtained as RK4 discretizzation of a continuous system.
 
+    \warning state_fcn() and state_fcn_into() are const but write the internal workspaces (mean input and RK4
+    stages), so they are not thread-safe: do not call them concurrently on the same object, use a clone() per thread
+    (e.g. Ensemble_Runner).
+
     \sa Continuous_System_Interface, Discretizator_Interface, RK4, Discrete_System_Interface
 */
 
@@ -54,6 +58,9 @@ protected:
   //! Internal Var
   TooN::Matrix<> Identity_x_;
 
+  //! Workspaces of state_fcn_into(), the mean input and the RK4 stages
+  mutable TooN::Vector<> u_n_12_, k1_, k2_, k3_, k4_, x_tmp_;
+
   /*Config*/
   //! Configuration flag
   /*!
@@ -64,6 +71,48 @@ protected:
   */
   bool b_use_previous_input_everywhere_;
 
+  //! INTERNAL RK4 step on the continuous system sys, the mean input has to be in u_n_12_
+  /*!
+    System is the static type of the continuous system: a final class (e.g. Continuous_System_Template) makes the
+    calls direct, see RK4_Template.
+  */
+  template <class System>
+  inline void rk4Step(const System& sys, const TooN::Vector<>& x_n_1, const TooN::Vector<>& u_n,
+                      const TooN::Vector<>& u_n_1, TooN::Vector<>& x_n) const
+  {
+    const int n = x_n_1.size();
+    sys.state_fcn_into(x_n_1, u_n_1, k1_);
+    for (int i = 0; i < n; i++)
+      x_tmp_[i] = x_n_1[i] + Ts_2_ * k1_[i];
+    sys.state_fcn_into(x_tmp_, u_n_12_, k2_);
+    for (int i = 0; i < n; i++)
+      x_tmp_[i] = x_n_1[i] + Ts_2_ * k2_[i];
+    sys.state_fcn_into(x_tmp_, u_n_12_, k3_);
+    for (int i = 0; i < n; i++)
+      x_tmp_[i] = x_n_1[i] + Ts_ * k3_[i];
+    sys.state_fcn_into(x_tmp_, u_n, k4_);
+
+    for (int i = 0; i < n; i++)
+      x_n[i] = x_n_1[i] + Ts_6_ * (k1_[i] + 2.0 * k2_[i] + 2.0 * k3_[i] + k4_[i]);
+  }
+
+  //! INTERNAL Jacobian of the RK4 step on the continuous system sys, see rk4Step()
+  template <class System>
+  inline TooN::Matrix<> rk4Jacobian(const System& sys, const TooN::Vector<>& x_n_1, const TooN::Vector<>& u_n,
+                                    const TooN::Vector<>& u_n_1, const TooN::Vector<>& u_n_12) const
+  {
+    TooN::Vector<> k1 = sys.state_fcn(x_n_1, u_n_1);
+    TooN::Vector<> k2 = sys.state_fcn(x_n_1 + Ts_2_ * k1, u_n_12);
+    TooN::Vector<> k3 = sys.state_fcn(x_n_1 + Ts_2_ * k2, u_n_12);
+
+    TooN::Matrix<> jac_k1 = sys.jacob_state_fcn(x_n_1, u_n_1);
+    TooN::Matrix<> jac_k2 = sys.jacob_state_fcn(x_n_1 + Ts_2_ * k1, u_n_12) * (Identity_x_ + Ts_2_ * jac_k1);
+    TooN::Matrix<> jac_k3 = sys.jacob_state_fcn(x_n_1 + Ts_2_ * k2, u_n_12) * (Identity_x_ + Ts_2_ * jac_k2);
+    TooN::Matrix<> jac_k4 = sys.jacob_state_fcn(x_n_1 + Ts_ * k3, u_n) * (Identity_x_ + Ts_ * jac_k3);
+
+    return Identity_x_ + Ts_6_ * (jac_k1 + 2.0 * jac_k2 + 2.0 * jac_k3 + jac_k4);  //=jac_n
+  }
+
   ////SS_Interface( const TooN::Vector<>& state, const TooN::Vector<>& output )
   ////            :state_(state),
   ////            output_(output)
@@ -89,6 +138,12 @@ public:
     , Ts_2_(Ts / 2.0)
     , Ts_6_(Ts / 6.0)
     , Identity_x_(TooN::Identity(system.getSizeState()))
+    , u_n_12_(TooN::Zeros(system.getSizeInput()))
+    , k1_(TooN::Zeros(system.getSizeState()))
+    , k2_(TooN::Zeros(system.getSizeState()))
+    , k3_(TooN::Zeros(system.getSizeState()))
+    , k4_(TooN::Zeros(system.getSizeState()))
+    , x_tmp_(TooN::Zeros(system.getSizeState()))
     , b_use_previous_input_everywhere_(use_previous_input_everywhere)
   {
   }
@@ -102,6 +157,12 @@ public:
     , Ts_2_(ss.Ts_2_)
     , Ts_6_(ss.Ts_6_)
     , Identity_x_(ss.Identity_x_)
+    , u_n_12_(ss.u_n_12_)
+    , k1_(ss.k1_)
+    , k2_(ss.k2_)
+    , k3_(ss.k3_)
+    , k4_(ss.k4_)
+    , x_tmp_(ss.x_tmp_)
     , b_use_previous_input_everywhere_(ss.b_use_previous_input_everywhere_)
   {
   }
@@ -135,14 +196,26 @@ public:
   inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x_n_1, const TooN::Vector<>& u_n,
                                                 const TooN::Vector<>& u_n_1) const
   {
-    TooN::Vector<> u_n_12 = estimateMeanInputs(u_n, u_n_1);
-
-    TooN::Vector<> k1 = system_->state_fcn(x_n_1, u_n_1);
-    TooN::Vector<> k2 = system_->state_fcn(x_n_1 + Ts_2_ * k1, u_n_12);
-    TooN::Vector<> k3 = system_->state_fcn(x_n_1 + Ts_2_ * k2, u_n_12);
-    TooN::Vector<> k4 = system_->state_fcn(x_n_1 + Ts_ * k3, u_n);
+    TooN::Vector<> x_n(x_n_1.size());
+    state_fcn_into(x_n_1, u_n, u_n_1, x_n);
+    return x_n;
+  }
 
-    return x_n_1 + Ts_6_ * (k1 + 2.0 * k2 + 2.0 * k3 + k4);  //=x_n
+  //! specific RK4 overload for state_fcn_into
+  /*!
+    Allocation free version of state_fcn(x_n_1, u_n, u_n_1), it uses the internal workspaces and the
+    state_fcn_into() of the continuous system.
+    \param x_n_1 previous state x(n-1)
+    \param u_n current input u(n)
+    \param u_n_1 previous input u(n-1)
+    \param x_n next state x(n), it must not be x_n_1
+  */
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_n_1, const TooN::Vector<>& u_n,
+                                     const TooN::Vector<>& u_n_1, TooN::Vector<>& x_n) const
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    estimateMeanInputs_into(u_n, u_n_1, u_n_12_);
+    rk4Step(*system_, x_n_1, u_n, u_n_1, x_n);
   }
 
   // To make this function stateless, i.e. u_k_1 = u_k, b_use_previous_input_everywhere_ must be false (this is the
@@ -157,9 +230,26 @@ public:
 
   inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
     return system_->output_fcn(x_k, u_k);
   }
 
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                     TooN::Vector<>& x_k) const override
+  {
+    if (b_use_previous_input_everywhere_)
+      state_fcn_into(x_k_1, u_k, u_n_1_, x_k);
+    else
+      state_fcn_into(x_k_1, u_k, u_k, x_k);
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                      TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    system_->output_fcn_into(x_k, u_k, y_k);
+  }
+
   //! specific RK4 overload for jacob_state_fcn
   /*!
     RK4 needs also the previous input (u(n-1)) to work, this becomes a state variable.
@@ -171,18 +261,8 @@ public:
   inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_n_1, const TooN::Vector<>& u_n,
                                                       const TooN::Vector<>& u_n_1) const
   {
-    TooN::Vector<> u_n_12 = estimateMeanInputs(u_n, u_n_1);
-
-    TooN::Vector<> k1 = system_->state_fcn(x_n_1, u_n_1);
-    TooN::Vector<> k2 = system_->state_fcn(x_n_1 + Ts_2_ * k1, u_n_12);
-    TooN::Vector<> k3 = system_->state_fcn(x_n_1 + Ts_2_ * k2, u_n_12);
-
-    TooN::Matrix<> jac_k1 = system_->jacob_state_fcn(x_n_1, u_n_1);
-    TooN::Matrix<> jac_k2 = system_->jacob_state_fcn(x_n_1 + Ts_2_ * k1, u_n_12) * (Identity_x_ + Ts_2_ * jac_k1);
-    TooN::Matrix<> jac_k3 = system_->jacob_state_fcn(x_n_1 + Ts_2_ * k2, u_n_12) * (Identity_x_ + Ts_2_ * jac_k2);
-    TooN::Matrix<> jac_k4 = system_->jacob_state_fcn(x_n_1 + Ts_ * k3, u_n) * (Identity_x_ + Ts_ * jac_k3);
-
-    return Identity_x_ + Ts_6_ * (jac_k1 + 2.0 * jac_k2 + 2.0 * jac_k3 + jac_k4);  //=jac_n
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    return rk4Jacobian(*system_, x_n_1, u_n, u_n_1, estimateMeanInputs(u_n, u_n_1));
   }
 
   // To make this function stateless, i.e. u_k_1 = u_k, b_use_previous_input_everywhere_ must be false (this is the
@@ -198,14 +278,17 @@ public:
 
   virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
     return system_->jacob_output_fcn(x_k, u_k);
   }
 
   virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
   {
-    state_ = state_fcn(state_, input, u_n_1_);
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    state_fcn_into(state_, input, u_n_1_, state_next_);
+    state_ = state_next_;
     u_n_1_ = input;
-    output_ = output_fcn(state_, input);
+    output_fcn_into(state_, input, output_);
     return output_;
   }
 
@@ -217,6 +300,17 @@ public:
     return (u_n + u_n_1) / 2.0;  //=u_n_12
   }
 
+  /*!
+    Allocation free version of estimateMeanInputs(), used by state_fcn_into().
+    A derived class that changes the interpolation has to override both.
+  */
+  inline virtual void estimateMeanInputs_into(const TooN::Vector<>& u_n, const TooN::Vector<>& u_n_1,
+                                              TooN::Vector<>& u_n_12) const
+  {
+    for (int i = 0; i < u_n.size(); i++)
+      u_n_12[i] = (u_n[i] + u_n_1[i]) / 2.0;
+  }
+
   virtual void reset() override
   {
     Discretizator_Interface::reset();
@@ -240,7 +334,13 @@ public:
 
   virtual void display() const override
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for RK4" CRESET << std::endl;
+    std::cout << "RK4:" << std::endl
+              << "Ts: " << Ts_ << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "Continuous system:" << std::endl;
+    system_->display();
+    std::cout << "RK4 [END]" << std::endl;
   }
 };
 
@@ -0,0 +1,143 @@
+/*
+    RK4_Template Class, Runge-Kutta 4 Discretizator of a continuous system of known type
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef RK4_TEMPLATE_H
+#define RK4_TEMPLATE_H
+
+/*! \file RK4_Template.h
+    \brief Runge-Kutta 4 Discretizator of a continuous system of known type
+*/
+
+#include <sun_systems_lib/Discretization/RK4.h>
+
+namespace sun
+{
+//!  RK4_Template class: Runge-Kutta 4 Discretizator of a continuous system of type System.
+/*!
+    Same of RK4 (it is a RK4), but the continuous system is called through its static type System.
+    If System is a final class (e.g. Continuous_System_Template) the calls of the RK4 stages and of the Jacobian are
+    direct, so the compiler can inline the user dynamics in the integrator.
+    Use makeRK4() to deduce the template parameter.
+
+    \sa RK4, Continuous_System_Template
+*/
+template <class System>
+class RK4_Template final : public RK4
+{
+private:
+  RK4_Template();
+
+protected:
+  //! The continuous system (owned by RK4::system_)
+  const System* typed_system_;
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    \param system continuous system to be discretized
+    \param Ts sampling time
+    \param use_previous_input_everywhere (default false) - configuration flag, see RK4
+  */
+  RK4_Template(const System& system, double Ts, bool use_previous_input_everywhere = false)
+    : RK4(system, Ts, use_previous_input_everywhere), typed_system_(static_cast<const System*>(system_.get()))
+  {
+  }
+
+  //! Copy Constructor
+  RK4_Template(const RK4_Template& ss) : RK4(ss), typed_system_(static_cast<const System*>(system_.get()))
+  {
+  }
+
+  virtual RK4_Template* clone() const override
+  {
+    return new RK4_Template(*this);
+  }
+
+  //! destructor
+  virtual ~RK4_Template() override = default;
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  //! Get the continuous system
+  inline const System& getSystem() const
+  {
+    return *typed_system_;
+  }
+
+  /*==============================================*/
+
+  /*=============SS FUNCTIONS=====================*/
+
+  // The 2 argument overloads and apply() of RK4 call the overrides below
+  using RK4::jacob_state_fcn;
+  using RK4::state_fcn_into;
+
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_n_1, const TooN::Vector<>& u_n,
+                                     const TooN::Vector<>& u_n_1, TooN::Vector<>& x_n) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    estimateMeanInputs_into(u_n, u_n_1, u_n_12_);
+    rk4Step(*typed_system_, x_n_1, u_n, u_n_1, x_n);
+  }
+
+  inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    return typed_system_->output_fcn(x_k, u_k);
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                      TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    typed_system_->output_fcn_into(x_k, u_k, y_k);
+  }
+
+  inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_n_1, const TooN::Vector<>& u_n,
+                                                      const TooN::Vector<>& u_n_1) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    return rk4Jacobian(*typed_system_, x_n_1, u_n, u_n_1, estimateMeanInputs(u_n, u_n_1));
+  }
+
+  virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    return typed_system_->jacob_output_fcn(x_k, u_k);
+  }
+
+  /*==============================================*/
+};
+
+//! Build a RK4_Template deducing the type of the continuous system
+template <class System>
+RK4_Template<System> makeRK4(const System& system, double Ts, bool use_previous_input_everywhere = false)
+{
+  return RK4_Template<System>(system, Ts, use_previous_input_everywhere);
+}
+
+}  // namespace sun
+
+#endif
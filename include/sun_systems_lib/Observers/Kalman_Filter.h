@@ -27,6 +27,7 @@
 */
 
 #include <sun_systems_lib/Observers/Observer_Interface.h>
+#include <sun_systems_lib/Utils/Dense_Kernels.h>
 #include "TooN/SVD.h"
 
 namespace sun
@@ -59,7 +60,7 @@ namespace sun
     \warning This class is not fully implemented, it can be used only as a Kalman_Filter, do NOT
     try to use it as Observer_Interface or SS_Interface because the inheritance is NOT fully implemented.
     
-    \warning Please,  use ONLY the specific kf apply method: kf_apply, obs_apply.
+    \warning Please,  use ONLY the specific kf apply method: kf_apply, obs_apply (or apply() with the full input).
 
     \warning Do not try to use the stateless *_fcn methods. Future implementations will handle this.
 
@@ -85,6 +86,13 @@ protected:
   //! Identity matrix. Internal Use
   TooN::Matrix<> Identity_x_;
 
+  //! Workspaces of obs_apply(), vectors: predicted state, predicted output, residual
+  TooN::Vector<> x_pred_, y_pred_, y_tilde_;
+  //! Workspaces of apply(), the observed system input and measure
+  TooN::Vector<> u_real_, y_meas_;
+  //! Workspaces of obs_apply(), matrices: F, F*P, P predicted, H, H*P predicted, S (Cholesky factor), K^T
+  TooN::Matrix<> F_, FP_, P_pred_, H_, HP_, S_, KT_;
+
   ////SS_Interface( const TooN::Vector<>& state, const TooN::Vector<>& output )
   ////            :state_(state),
   ////            output_(output)
@@ -109,12 +117,41 @@ public:
     , V_(V)
     , P_(W)
     , Identity_x_(TooN::Identity(system.getSizeState()))
+    , x_pred_(TooN::Zeros(system.getSizeState()))
+    , y_pred_(TooN::Zeros(system.getSizeOutput()))
+    , y_tilde_(TooN::Zeros(system.getSizeOutput()))
+    , u_real_(TooN::Zeros(system.getSizeInput()))
+    , y_meas_(TooN::Zeros(system.getSizeOutput()))
+    , F_(TooN::Zeros(system.getSizeState(), system.getSizeState()))
+    , FP_(TooN::Zeros(system.getSizeState(), system.getSizeState()))
+    , P_pred_(TooN::Zeros(system.getSizeState(), system.getSizeState()))
+    , H_(TooN::Zeros(system.getSizeOutput(), system.getSizeState()))
+    , HP_(TooN::Zeros(system.getSizeOutput(), system.getSizeState()))
+    , S_(TooN::Zeros(system.getSizeOutput(), system.getSizeOutput()))
+    , KT_(TooN::Zeros(system.getSizeOutput(), system.getSizeState()))
   {
   }
 
   //! Copy Constructor
   Kalman_Filter(const Kalman_Filter& ss)
-    : Observer_Interface(ss), system_(ss.system_->clone()), P_(ss.P_), W_(ss.W_), V_(ss.V_), Identity_x_(ss.Identity_x_)
+    : Observer_Interface(ss)
+    , system_(ss.system_->clone())
+    , P_(ss.P_)
+    , W_(ss.W_)
+    , V_(ss.V_)
+    , Identity_x_(ss.Identity_x_)
+    , x_pred_(ss.x_pred_)
+    , y_pred_(ss.y_pred_)
+    , y_tilde_(ss.y_tilde_)
+    , u_real_(ss.u_real_)
+    , y_meas_(ss.y_meas_)
+    , F_(ss.F_)
+    , FP_(ss.FP_)
+    , P_pred_(ss.P_pred_)
+    , H_(ss.H_)
+    , HP_(ss.HP_)
+    , S_(ss.S_)
+    , KT_(ss.KT_)
   {
   }
 
@@ -176,65 +213,96 @@ public:
     return obs_apply(u_k, y_k);
   }
 
+  //! Apply the EKF, compute the estimated output and update the internal state
+  /*!
+    The step runs on the *_fcn_into() methods of the observed system and on internal workspaces, it does not allocate
+    if they do not. The gain is computed with a Cholesky solve of S (W and V are covariances, S is symmetric positive
+    definite), the pseudo inverse of S is used only if the factorization fails.
+  */
   inline virtual const TooN::Vector<>& obs_apply(const TooN::Vector<>& u_k, const TooN::Vector<>& y_k) override
   {
-
-// TODO: review symbolism https://en.wikipedia.org/wiki/Extended_Kalman_filter
-
-#define u_k1 u_k
-
-#define x_hat_k_k state_
-#define x_hat_k1_k1 state_
-
-#define P_k_k P_
-#define P_k1_k1 P_
-
-#define W_k1 W_
-#define V_k V_
-
-#define y_hat_k_k output_
-
-    // x_hat_k1_k1 = x_hat_k_k;
-    // P_k1_k1 = P_k_k;
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    const int n = state_.size();
+    const int p = output_.size();
 
     /*PREDICT*/
     // predict state estimate
-    TooN::Vector<> x_hat_k_k1 = system_->state_fcn(x_hat_k1_k1, u_k1);
+    system_->state_fcn_into(state_, u_k, x_pred_);
 
-    // Predicted covariance estimate
-    TooN::Matrix<> F_k1 = system_->jacob_state_fcn(x_hat_k1_k1, u_k1);
-    TooN::Matrix<> P_k_k1 = F_k1 * P_k1_k1 * (F_k1.T()) + W_k1;
+    // Predicted covariance estimate P_pred = F*P*F^T + W
+    system_->jacob_state_fcn_into(state_, u_k, F_);
+    Dense_Kernels::multiply(F_, P_, FP_);
+    Dense_Kernels::multiplyTransposed(FP_, F_, P_pred_);
+    P_pred_ += W_;
 
     /*UPDATE*/
     // Innovation or measurement residual
-    TooN::Vector<> y_hat_k_k1 = system_->output_fcn(x_hat_k_k1, u_k1);
-    TooN::Vector<> y_tilde_k = y_k - y_hat_k_k1;
-
-    // Innovation (or residual) covariance
-    TooN::Matrix<> H_k = system_->jacob_output_fcn(x_hat_k_k1, u_k1);
-    TooN::Matrix<> S_k = H_k * P_k_k1 * (H_k.T()) + V_k;
-
-    // Near-optimal Kalman gain
-    TooN::SVD<> S_k_SVD(S_k);
-    TooN::Matrix<> K_k = P_k_k1 * (H_k.T()) * S_k_SVD.get_pinv();
-
-    // Update state estimate
-    x_hat_k_k = x_hat_k_k1 + K_k * y_tilde_k;
-
-    // Update covariance estimate
-    P_k_k = (Identity_x_ - K_k * H_k) * P_k_k1;
+    system_->output_fcn_into(x_pred_, u_k, y_pred_);
+    for (int i = 0; i < p; i++)
+      y_tilde_[i] = y_k[i] - y_pred_[i];
+
+    // Innovation (or residual) covariance S = H*P_pred*H^T + V
+    system_->jacob_output_fcn_into(x_pred_, u_k, H_);
+    Dense_Kernels::multiply(H_, P_pred_, HP_);
+    Dense_Kernels::multiplyTransposed(HP_, H_, S_);
+    S_ += V_;
+
+    // Near-optimal Kalman gain, K^T = S^-1 * H*P_pred (P_pred and S are symmetric)
+    KT_ = HP_;
+    if (Dense_Kernels::cholesky(S_))
+    {
+      Dense_Kernels::choleskySolve(S_, KT_);
+    }
+    else
+    {
+      Dense_Kernels::multiplyTransposed(HP_, H_, S_);
+      S_ += V_;
+      TooN::SVD<> S_k_SVD(S_);
+      KT_ = S_k_SVD.get_pinv() * HP_;
+    }
+
+    // Update state estimate x = x_pred + K*y_tilde
+    state_ = x_pred_;
+    Dense_Kernels::multiplyTransposeAdd(KT_, y_tilde_, state_);
+
+    // Update covariance estimate P = (I - K*H)*P_pred = P_pred - K*H*P_pred
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < n; j++)
+      {
+        double acc = 0.0;
+        for (int r = 0; r < p; r++)
+        {
+          acc += KT_(r, i) * HP_(r, j);
+        }
+        P_(i, j) = P_pred_(i, j) - acc;
+      }
+    }
 
     // Update Output
-    y_hat_k_k = system_->output_fcn(x_hat_k_k, u_k1);
+    system_->output_fcn_into(state_, u_k, output_);
 
-    return y_hat_k_k;
+    return output_;
+  }
 
-#undef x_hat_k_k
-#undef x_hat_k1_k1
-#undef P_k_k
-#undef P_k1_k1
-#undef W_k1
-#undef V_k
+  //! Apply the EKF as a Discrete_System_Interface, the input is [observed_system_input; observed_system_output]
+  /*!
+    It splits the input and calls obs_apply(), so the filter can be run by the generic runners
+    (e.g. Ensemble_Runner, simulate())
+  */
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& u_compleate_k) override
+  {
+    if (u_compleate_k.size() != u_real_.size() + y_meas_.size())
+    {
+      throw std::domain_error("[Kalman_Filter::apply(Vector)] The input size has to be the observed system input size + "
+                              "the output size");
+    }
+    const unsigned int size_real_input = u_real_.size();
+    for (unsigned int i = 0; i < size_real_input; i++)
+      u_real_[i] = u_compleate_k[i];
+    for (int i = 0; i < y_meas_.size(); i++)
+      y_meas_[i] = u_compleate_k[size_real_input + i];
+    return obs_apply(u_real_, y_meas_);
   }
 
   //! DO NOT USE THIS FUNCTION FOR Kalman_Filter
@@ -359,7 +427,18 @@ public:
 
   virtual void display() const override
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Kalman_Filter" CRESET << std::endl;
+    std::cout << "Kalman_Filter:" << std::endl
+              << "W:" << std::endl
+              << W_ << std::endl
+              << "V:" << std::endl
+              << V_ << std::endl
+              << "P:" << std::endl
+              << P_ << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "Observed system:" << std::endl;
+    system_->display();
+    std::cout << "Kalman_Filter [END]" << std::endl;
   }
 };
 
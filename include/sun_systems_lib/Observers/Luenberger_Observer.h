@@ -27,6 +27,7 @@
 */
 
 #include <sun_systems_lib/Observers/Observer_Interface.h>
+#include <sun_systems_lib/Utils/Dense_Kernels.h>
 
 namespace sun
 {
@@ -63,6 +64,9 @@ namespace sun
     In any case, you can use the specific observer methods: obs_state_fcn, obs_output_fcn, ... ,
     that take as input the observed_system_input and observed_system_output separately.
 
+    \warning obs_state_fcn_into() is const but writes the internal output error workspace, so it is not thread-safe:
+    do not call it concurrently on the same object, use a clone() per thread (e.g. Ensemble_Runner).
+
     \sa Linear_System_Interface, Kalman_Filter, Observer_Interface, Discrete_System_Interface
 */
 class Luenberger_Observer : public Observer_Interface
@@ -78,6 +82,9 @@ protected:
   //! Observer Gain Matrix
   TooN::Matrix<> L_;
 
+  //! Workspace of obs_state_fcn_into(), output error
+  mutable TooN::Vector<> y_err_;
+
   ////SS_Interface( const TooN::Vector<>& state, const TooN::Vector<>& output )
   ////            :state_(state),
   ////            output_(output)
@@ -96,7 +103,10 @@ public:
     \param L The observer gain matrix
   */
   Luenberger_Observer(const SS_Interface& system, const TooN::Matrix<>& L)
-    : Observer_Interface(system.getState(), system.getSizeOutput()), system_(system.clone()), L_(L)
+    : Observer_Interface(system.getState(), system.getSizeOutput())
+    , system_(system.clone())
+    , L_(L)
+    , y_err_(TooN::Zeros(system.getSizeOutput()))
   {
     if (!chek_dimensions())
     {
@@ -105,7 +115,8 @@ public:
   }
 
   //! Copy Constructor
-  Luenberger_Observer(const Luenberger_Observer& ss) : Observer_Interface(ss), system_(ss.system_->clone()), L_(ss.L_)
+  Luenberger_Observer(const Luenberger_Observer& ss)
+    : Observer_Interface(ss), system_(ss.system_->clone()), L_(ss.L_), y_err_(ss.y_err_)
   {
   }
 
@@ -130,9 +141,21 @@ public:
   inline virtual const TooN::Vector<> obs_state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
                                                     const TooN::Vector<>& y_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
     return system_->state_fcn(x_k_1, u_k) + L_ * (y_k - system_->output_fcn(x_k_1, u_k));
   }
 
+  inline virtual void obs_state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                         const TooN::Vector<>& y_k, TooN::Vector<>& x_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    system_->output_fcn_into(x_k_1, u_k, y_err_);
+    for (int i = 0; i < y_err_.size(); i++)
+      y_err_[i] = y_k[i] - y_err_[i];
+    system_->state_fcn_into(x_k_1, u_k, x_k);
+    Dense_Kernels::multiplyAdd(L_, y_err_, x_k);
+  }
+
   // inline virtual const TooN::Vector<> state_fcn( const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k ) const
   // override
   //{
@@ -146,9 +169,17 @@ public:
   inline virtual const TooN::Vector<> obs_output_fcn(const TooN::Vector<>& x_k,
                                                      const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
     return system_->output_fcn(x_k, u_k);
   }
 
+  inline virtual void obs_output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                          TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    system_->output_fcn_into(x_k, u_k, y_k);
+  }
+
   // inline virtual const TooN::Vector<> output_fcn( const TooN::Vector<>& x_k, const TooN::Vector<>& u_k ) const
   // override
   //{
@@ -162,6 +193,7 @@ public:
   inline virtual const TooN::Matrix<> obs_jacob_state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
                                                           const TooN::Vector<>& y_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
     return system_->jacob_state_fcn(x_k_1, u_k) - L_ * system_->jacob_output_fcn(x_k_1, u_k);
   }
 
@@ -177,6 +209,7 @@ public:
   inline virtual const TooN::Matrix<> obs_jacob_output_fcn(const TooN::Vector<>& x_k,
                                                            const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
     return system_->jacob_output_fcn(x_k, u_k);
   }
 
@@ -232,7 +265,14 @@ public:
 
   virtual void display() const override
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Luenberger_Observer" CRESET << std::endl;
+    std::cout << "Luenberger_Observer:" << std::endl
+              << "L:" << std::endl
+              << L_ << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "Observed system:" << std::endl;
+    system_->display();
+    std::cout << "Luenberger_Observer [END]" << std::endl;
   }
 
   virtual bool chek_dimensions() const
@@ -199,6 +199,29 @@ public:
   */
   virtual const TooN::Matrix<> obs_jacob_output_fcn(const TooN::Vector<>& x_hat_k, const TooN::Vector<>& u_k) const = 0;
 
+  //!  Observer State function, the estimated state is written in caller provided storage
+  /*!
+      Same of obs_state_fcn(), x_hat_k must have the size of the state and must not be x_hat_k_1.
+      The default implementation calls obs_state_fcn(), the derived classes override it to avoid the heap allocations.
+      The implementations can use internal workspaces: the calls on the same object are not reentrant.
+  */
+  virtual void obs_state_fcn_into(const TooN::Vector<>& x_hat_k_1, const TooN::Vector<>& u_k,
+                                  const TooN::Vector<>& y_k, TooN::Vector<>& x_hat_k) const
+  {
+    x_hat_k = obs_state_fcn(x_hat_k_1, u_k, y_k);
+  }
+
+  //!  Observer Output function, the estimated output is written in caller provided storage
+  /*!
+      Same of obs_output_fcn(), y_hat_k must have the size of the output.
+      \sa obs_state_fcn_into()
+  */
+  virtual void obs_output_fcn_into(const TooN::Vector<>& x_hat_k, const TooN::Vector<>& u_k,
+                                   TooN::Vector<>& y_hat_k) const
+  {
+    y_hat_k = obs_output_fcn(x_hat_k, u_k);
+  }
+
   //!  Observer as StateSpaceSystem - output function Jacobian H_obs(k) = jac_output(x_hat(k),u_compleate(k))
   /*!
       returns the output function Jacobian H_obs
@@ -225,14 +248,18 @@ public:
       y_hat(k) = h_obs(x(k),u(k))
     \endverbatim
 
+    The step runs on obs_state_fcn_into() and obs_output_fcn_into(), it does not allocate if they do not.
+
     \param u_k Observed System Input at the current step u(k)
     \param y_k Observed System Measure at the current step y(k)
     \return estimated system output y_hat(k)
   */
   virtual const TooN::Vector<>& obs_apply(const TooN::Vector<>& u_k, const TooN::Vector<>& y_k)
   {
-    state_ = obs_state_fcn(state_, u_k, y_k);
-    output_ = obs_output_fcn(state_, u_k);
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    obs_state_fcn_into(state_, u_k, y_k, state_next_);
+    state_ = state_next_;
+    obs_output_fcn_into(state_, u_k, output_);
     return output_;
   }
 
@@ -269,7 +296,10 @@ public:
 
   virtual void display() const override
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Observer_Interface" CRESET << std::endl;
+    std::cout << "Observer: " << getSizeRealInput() << " inputs, " << getSizeOutput() << " measures, "
+              << getSizeState() << " states" << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
   }
 
   //! [Internal] Build the full input
@@ -153,7 +153,9 @@ public:
 
   virtual void display() const override
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for Observer_SS_Incapsuler" CRESET << std::endl;
+    std::cout << "Observer_SS_Incapsuler:" << std::endl;
+    system_->display();
+    std::cout << "Observer_SS_Incapsuler [END]" << std::endl;
   }
 };
 
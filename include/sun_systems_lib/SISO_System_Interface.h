@@ -27,6 +27,7 @@
 */
 
 #include "sun_systems_lib/Discrete_System_Interface.h"
+#include <cstddef>
 
 namespace sun
 {
@@ -78,6 +79,36 @@ public:
   */
   virtual double apply(double u_k) = 0;
 
+  //! Apply the system to a block of samples
+  /*!
+    Process n samples at once, it is equivalent to
+
+    \verbatim
+    for (i = 0; i < n; i++)
+      out[i] = apply(in[i]);
+    \endverbatim
+
+    The final state is the same of the sample by sample execution.
+    Derived classes should override this method with a specialized loop.
+    \param in input samples u(k) ... u(k+n-1), size n
+    \param out output samples y(k) ... y(k+n-1), size n, it can be the same array of in
+    \param n number of samples
+  */
+  virtual void apply_block(const double* in, double* out, std::size_t n)
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    for (std::size_t i = 0; i < n; i++)
+    {
+      out[i] = apply(in[i]);
+    }
+  }
+
+  //! Simulate the system on a whole input trajectory, SISO systems run apply_block()
+  virtual void simulate_block(const double* U, double* Y, std::size_t num_samples) override
+  {
+    apply_block(U, Y, num_samples);
+  }
+
   virtual void reset() override = 0;
 
   virtual const unsigned int getSizeInput() const override
@@ -92,7 +123,8 @@ public:
 
   virtual void display() const override
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for SISO_System_Interface" CRESET << std::endl;
+    std::cout << "SISO_System" << std::endl;
+    getInstrumentation().display();
   }
 };
 
@@ -35,6 +35,7 @@ namespace sun
 {
 typedef boost::function<TooN::Vector<>(const TooN::Vector<>&, const TooN::Vector<>&)> SS_FCN;
 typedef boost::function<TooN::Matrix<>(const TooN::Vector<>&, const TooN::Vector<>&)> SS_JACOB_FCN;
+typedef boost::function<void(const TooN::Vector<>&, const TooN::Vector<>&, TooN::Vector<>&)> SS_FCN_INTO;
 }  // namespace sun
 #endif
 
@@ -72,6 +73,8 @@ protected:
   SS_FCN state_fcn_, output_fcn_;
   //! Jacobians fcns
   SS_JACOB_FCN jacob_state_fcn_, jacob_output_fcn_;
+  //! Optional allocation free system fcns (NULL = use the system fcns)
+  SS_FCN_INTO state_fcn_into_, output_fcn_into_;
 
   //! Dimensions
   unsigned int dim_output_, dim_input_;
@@ -114,31 +117,65 @@ public:
 
   inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
     return state_fcn_(x_k_1, u_k);
   }
 
   inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
     return output_fcn_(x_k, u_k);
   }
 
   inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_k_1,
                                                       const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
     return jacob_state_fcn_(x_k_1, u_k);
   }
 
   inline virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k,
                                                        const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
     return jacob_output_fcn_(x_k, u_k);
   }
 
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                     TooN::Vector<>& x_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    if (state_fcn_into_)
+      state_fcn_into_(x_k_1, u_k, x_k);
+    else
+      x_k = state_fcn_(x_k_1, u_k);
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                      TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    if (output_fcn_into_)
+      output_fcn_into_(x_k, u_k, y_k);
+    else
+      y_k = output_fcn_(x_k, u_k);
+  }
+
+  //! Set the allocation free versions of the system functions
+  /*!
+    They are used by apply() instead of the functions given in the constructor, they must compute the same values.
+    \param state_fcn_into state transition function f(x(k-1),u(k),x(k)), x(k) is the output (NULL = not used)
+    \param output_fcn_into output function h(x(k),u(k),y(k)), y(k) is the output (NULL = not used)
+  */
+  void setFcnsInto(const SS_FCN_INTO& state_fcn_into, const SS_FCN_INTO& output_fcn_into)
+  {
+    state_fcn_into_ = state_fcn_into;
+    output_fcn_into_ = output_fcn_into;
+  }
+
   inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
   {
-    state_ = state_fcn_(state_, input);
-    output_ = output_fcn_(state_, input);
-    return output_;
+    return SS_Interface::apply(input);
   }
 
   virtual const unsigned int getSizeInput() const override
@@ -155,8 +192,9 @@ public:
   {
     std::cout << "SS:" << std::endl
               << "Functions are defined run-time" << std::endl
-              << "state: " << state_ << std::endl
-              << "SS [END]" << std::endl;
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "SS [END]" << std::endl;
   }
 };
 
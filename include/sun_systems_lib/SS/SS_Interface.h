@@ -62,13 +62,17 @@ protected:
   //! Output (for internal reference)
   TooN::Vector<> output_;
 
+  //! Workspace, next state computed by apply()
+  TooN::Vector<> state_next_;
+
   //!  Full Constructor
   /*!
       Costructor that inizialize the state
       \param state initial state
       \param dim_output output dimention
   */
-  SS_Interface(const TooN::Vector<>& state, unsigned int dim_output) : state_(state), output_(TooN::Zeros(dim_output))
+  SS_Interface(const TooN::Vector<>& state, unsigned int dim_output)
+    : state_(state), output_(TooN::Zeros(dim_output)), state_next_(state)
   {
   }
 
@@ -150,6 +154,47 @@ public:
   */
   virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const = 0;
 
+  //!  State transition function, the result is written in caller provided storage
+  /*!
+      Same of state_fcn(), x_k must have the size of the state and must not be x_k_1.
+      The default implementation calls state_fcn(), the derived classes override it to avoid the heap allocations.
+      The implementations can use internal workspaces: the calls on the same object are not reentrant.
+  */
+  virtual void state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k, TooN::Vector<>& x_k) const
+  {
+    x_k = state_fcn(x_k_1, u_k);
+  }
+
+  //!  Output function, the result is written in caller provided storage
+  /*!
+      Same of output_fcn(), y_k must have the size of the output.
+      \sa state_fcn_into()
+  */
+  virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k, TooN::Vector<>& y_k) const
+  {
+    y_k = output_fcn(x_k, u_k);
+  }
+
+  //!  State function Jacobian, the result is written in caller provided storage
+  /*!
+      Same of jacob_state_fcn(), F must be a square matrix of the size of the state.
+      \sa state_fcn_into()
+  */
+  virtual void jacob_state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k, TooN::Matrix<>& F) const
+  {
+    F = jacob_state_fcn(x_k_1, u_k);
+  }
+
+  //!  Output function Jacobian, the result is written in caller provided storage
+  /*!
+      Same of jacob_output_fcn(), H must have size output x state.
+      \sa state_fcn_into()
+  */
+  virtual void jacob_output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k, TooN::Matrix<>& H) const
+  {
+    H = jacob_output_fcn(x_k, u_k);
+  }
+
   //! Apply the system, compute the output and update the internal state
   /*!
     Go one discrete step ahead, apply the input u(k), update the internal state for the next step,
@@ -160,13 +205,17 @@ public:
       y(k) = h(x(k),u(k))
     \endverbatim
 
+    The step runs on state_fcn_into() and output_fcn_into(), it does not allocate if they do not.
+
     \param u_k Input at the current step u(k)
     \return system output y(k)
   */
   virtual const TooN::Vector<>& apply(const TooN::Vector<>& u_k) override
   {
-    state_ = state_fcn(state_, u_k);
-    output_ = output_fcn(state_, u_k);
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    state_fcn_into(state_, u_k, state_next_);
+    state_ = state_next_;
+    output_fcn_into(state_, u_k, output_);
     return output_;
   }
 
@@ -187,7 +236,10 @@ public:
 
   virtual void display() const override
   {
-    std::cout << BOLDYELLOW "WARNING! display() not implemented for SS_Interface" CRESET << std::endl;
+    std::cout << "SS_Interface: " << getSizeInput() << " inputs, " << getSizeOutput() << " outputs, "
+              << getSizeState() << " states" << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
   }
 };
 
@@ -27,6 +27,9 @@
 */
 
 #include <sun_systems_lib/SS/SS_Interface.h>
+#include <sun_systems_lib/Utils/Dense_Kernels.h>
+#include <map>
+#include <vector>
 
 namespace sun
 {
@@ -50,6 +53,22 @@ namespace sun
 
     It stores the internal system state
 
+    The matrices are also stored stacked in a single row-major block [A B; C D], the step runs on the workspace
+    z = [x; u] with the fused kernel Dense_Kernels::multiplyBlocked():
+
+    \verbatim
+    z = [x(k-1); u(k)]   x(k) = [A B]*z
+    z = [x(k); u(k)]     y(k) = [C D]*z
+    \endverbatim
+
+    there are no temporaries and no heap allocations. The const *_fcn_into() functions do not use the workspace, they
+    run Dense_Kernels::multiplyBlockedSplit() on x and u directly.
+    simulate_block() runs the state recursion on chunks of SIMULATION_CHUNK samples, then a single product
+    Y = [X U]*[C D]^T for each chunk. The *_fcn_into() functions, apply() and simulate() use the same kernel with the
+    same accumulation order, so all the paths give the same values.
+
+    advance() jumps k steps under a constant input with the k-step matrices [A^k G_k] (see advance()).
+
     \sa Discretizator_Interface, RK4, Discrete_System_Interface
 */
 class SS_LINEAR : public SS_Interface
@@ -61,6 +80,24 @@ protected:
   //! System Matrix
   TooN::Matrix<> A_, B_, C_, D_;
 
+  //! Stacked system matrix [A B; C D], (n+p)x(n+m)
+  TooN::Matrix<> ABCD_;
+
+  //! Number of samples of a chunk in simulate_block()
+  static const std::size_t SIMULATION_CHUNK = 256;
+
+  //! INTERNAL Workspace z = [x; u] of the non-const functions (step(), simulate_block(), advance())
+  TooN::Vector<> z_;
+
+  //! INTERNAL Workspace of simulate_block(), the states of a chunk (SIMULATION_CHUNK x n, row-major)
+  std::vector<double> x_block_;
+
+  //! INTERNAL k-step matrices [A^k G_k] of advance(), memoized per k
+  std::map<unsigned long, TooN::Matrix<>> advance_cache_;
+
+  //! INTERNAL k-step matrices of advance() for k = 2^i
+  std::vector<TooN::Matrix<>> advance_pow2_;
+
 public:
   //! Constructor
   /*!
@@ -71,12 +108,35 @@ public:
     \endverbatim
   */
   SS_LINEAR(const TooN::Matrix<>& A, const TooN::Matrix<>& B, const TooN::Matrix<>& C, const TooN::Matrix<>& D)
-    : A_(A), B_(B), C_(C), D_(D), SS_Interface(TooN::Zeros(A.num_rows()), C.num_rows())
+    : SS_Interface(TooN::Zeros(A.num_rows()), C.num_rows())
+    , A_(A)
+    , B_(B)
+    , C_(C)
+    , D_(D)
+    , ABCD_(A.num_rows() + C.num_rows(), A.num_cols() + B.num_cols())
+    , z_(A.num_cols() + B.num_cols())
+    , x_block_(SIMULATION_CHUNK * A.num_rows())
   {
     if (!chek_dimensions())
     {
       throw std::invalid_argument("[SS_LINEAR] Invalid matrix dimensions");
     }
+    const int n = A_.num_rows();
+    const int m = B_.num_cols();
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < n; j++)
+        ABCD_(i, j) = A_(i, j);
+      for (int j = 0; j < m; j++)
+        ABCD_(i, n + j) = B_(i, j);
+    }
+    for (int i = 0; i < C_.num_rows(); i++)
+    {
+      for (int j = 0; j < n; j++)
+        ABCD_(n + i, j) = C_(i, j);
+      for (int j = 0; j < m; j++)
+        ABCD_(n + i, n + j) = D_(i, j);
+    }
   }
 
   //! Copy Constructor
@@ -102,33 +162,275 @@ public:
     return C_.num_rows();
   }
 
+  inline const TooN::Matrix<>& getA() const
+  {
+    return A_;
+  }
+
+  inline const TooN::Matrix<>& getB() const
+  {
+    return B_;
+  }
+
+  inline const TooN::Matrix<>& getC() const
+  {
+    return C_;
+  }
+
+  inline const TooN::Matrix<>& getD() const
+  {
+    return D_;
+  }
+
   ////////////////////////////////////////
 
   inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k) const override
   {
-    return A_ * x_k_1 + B_ * u_k;
+    TooN::Vector<> x_k(A_.num_rows());
+    state_fcn_into(x_k_1, u_k, x_k);
+    return x_k;
   }
 
   inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
   {
-    return C_ * x_k + D_ * u_k;
+    TooN::Vector<> y_k(C_.num_rows());
+    output_fcn_into(x_k, u_k, y_k);
+    return y_k;
   }
 
   inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_k_1,
                                                       const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
     return A_;
   }
 
   inline virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k,
                                                        const TooN::Vector<>& u_k) const override
   {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
     return C_;
   }
 
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                     TooN::Vector<>& x_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    const int n = A_.num_rows();
+    const int m = B_.num_cols();
+    Dense_Kernels::multiplyBlockedSplit(ABCD_.get_data_ptr(), n + m, n, x_k_1.get_data_ptr(), n, 0,
+                                        u_k.get_data_ptr(), m, 0, x_k.get_data_ptr(), 0, 1);
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                      TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    const int n = A_.num_rows();
+    const int m = B_.num_cols();
+    const int ld = n + m;
+    Dense_Kernels::multiplyBlockedSplit(ABCD_.get_data_ptr() + n * ld, ld, C_.num_rows(), x_k.get_data_ptr(), n, 0,
+                                        u_k.get_data_ptr(), m, 0, y_k.get_data_ptr(), 0, 1);
+  }
+
+  inline virtual void jacob_state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                           TooN::Matrix<>& F) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    F = A_;
+  }
+
+  inline virtual void jacob_output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                            TooN::Matrix<>& H) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    H = C_;
+  }
+
+  //! Apply the system with the fused kernel, see the class description
   inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
   {
-    return SS_Interface::apply(input);
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    if (input.size() != B_.num_cols())
+    {
+      throw std::invalid_argument("[SS_LINEAR::apply] Invalid input size");
+    }
+    step(input.get_data_ptr(), output_.get_data_ptr());
+    return output_;
+  }
+
+  //! Simulate the system on a whole input trajectory
+  /*!
+    The samples are processed in chunks of SIMULATION_CHUNK: the state recursion x(k) = [A B]*[x(k-1); u(k)] fills
+    the states X of the chunk, then the outputs of the chunk are a single product Y = [X U]*[C D]^T, so [C D] is
+    streamed once per chunk instead of once per sample. The results are the same of the sample by sample execution.
+    \sa Discrete_System_Interface::simulate_block()
+  */
+  virtual void simulate_block(const double* U, double* Y, std::size_t num_samples) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    const int n = A_.num_rows();
+    const int m = B_.num_cols();
+    const int p = C_.num_rows();
+    const int ld = n + m;
+    if (num_samples == 0)
+    {
+      return;
+    }
+    const double* ABCD = ABCD_.get_data_ptr();
+    double* z = z_.get_data_ptr();
+    double* X = x_block_.data();
+
+    const std::size_t max_chunk = SIMULATION_CHUNK;
+    for (std::size_t k0 = 0; k0 < num_samples; k0 += max_chunk)
+    {
+      const std::size_t len = std::min(num_samples - k0, max_chunk);
+      const double* U_c = U + k0 * m;
+
+      // State recursion x(k) = [A B]*[x(k-1); u(k)] in the rows of X
+      const double* x_prev = state_.get_data_ptr();
+      for (std::size_t k = 0; k < len; k++)
+      {
+        const double* u = U_c + k * m;
+        for (int i = 0; i < n; i++)
+          z[i] = x_prev[i];
+        for (int i = 0; i < m; i++)
+          z[n + i] = u[i];
+        Dense_Kernels::multiplyBlocked(ABCD, ld, n, ld, z, X + k * n);
+        x_prev = X + k * n;
+      }
+      for (int i = 0; i < n; i++)
+      {
+        state_[i] = x_prev[i];
+      }
+
+      // Outputs of the chunk Y = [X U]*[C D]^T
+      Dense_Kernels::multiplyBlockedSplit(ABCD + n * ld, ld, p, X, n, n, U_c, m, m, Y + k0 * p, p, len);
+    }
+
+    for (int i = 0; i < p; i++)
+    {
+      output_[i] = Y[(num_samples - 1) * p + i];
+    }
+  }
+
+  //! Jump k steps ahead under a constant input
+  /*!
+    Same result of k calls of apply(u_k), up to the rounding:
+
+    \verbatim
+    x(k) = A^k*x(0) + G_k*u,   G_k = (A^(k-1) + ... + A + I)*B
+    y(k) = C*x(k) + D*u
+    \endverbatim
+
+    The matrices [A^k G_k] are computed by repeated squaring, O(log(k) n^3), at the first call with a given k, then
+    they are memoized: the next calls with the same k cost a single fused product, O(n^2), without allocations.
+    The memoized matrices use (n*(n+m)) doubles each, clearAdvanceCache() releases them.
+    advance(1, u_k) is the same of apply(u_k), advance(0, u_k) does nothing and returns the last output.
+
+    \param k number of steps
+    \param u_k input, constant on the k steps
+    \return system output y(k)
+  */
+  const TooN::Vector<>& advance(unsigned long k, const TooN::Vector<>& u_k)
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    if (u_k.size() != B_.num_cols())
+    {
+      throw std::invalid_argument("[SS_LINEAR::advance] Invalid input size");
+    }
+    if (k == 0)
+    {
+      return output_;
+    }
+    const TooN::Matrix<>& PG = getAdvanceMatrix(k);
+    const int n = A_.num_rows();
+    const int m = B_.num_cols();
+    const int ld = n + m;
+    double* z = z_.get_data_ptr();
+    double* x = state_.get_data_ptr();
+
+    for (int i = 0; i < n; i++)
+      z[i] = x[i];
+    for (int i = 0; i < m; i++)
+      z[n + i] = u_k[i];
+    Dense_Kernels::multiplyBlocked(PG.get_data_ptr(), ld, n, ld, z, x);
+    for (int i = 0; i < n; i++)
+      z[i] = x[i];
+    Dense_Kernels::multiplyBlocked(ABCD_.get_data_ptr() + n * ld, ld, C_.num_rows(), ld, z, output_.get_data_ptr());
+    return output_;
+  }
+
+  //! Get the k-step matrix [A^k G_k] of advance(), n x (n+m), computed and memoized if needed
+  const TooN::Matrix<>& getAdvanceMatrix(unsigned long k)
+  {
+    if (k == 0)
+    {
+      throw std::invalid_argument("[SS_LINEAR::getAdvanceMatrix] k has to be positive");
+    }
+    std::map<unsigned long, TooN::Matrix<>>::const_iterator it = advance_cache_.find(k);
+    if (it != advance_cache_.end())
+    {
+      return it->second;
+    }
+
+    const int n = A_.num_rows();
+    const int ld = z_.size();
+    if (advance_pow2_.empty())
+    {
+      TooN::Matrix<> AB(n, ld);
+      for (int i = 0; i < n; i++)
+        for (int j = 0; j < ld; j++)
+          AB(i, j) = ABCD_(i, j);
+      advance_pow2_.push_back(AB);
+    }
+
+    TooN::Matrix<> PG(n, ld);
+    bool first = true;
+    for (unsigned int i = 0; (k >> i) != 0; i++)
+    {
+      if (i == advance_pow2_.size())
+      {
+        advance_pow2_.push_back(composeSteps(advance_pow2_[i - 1], advance_pow2_[i - 1]));
+      }
+      if ((k >> i) & 1ul)
+      {
+        if (first)
+          PG = advance_pow2_[i];
+        else
+          PG = composeSteps(advance_pow2_[i], PG);
+        first = false;
+      }
+    }
+    return advance_cache_.insert(std::make_pair(k, PG)).first->second;
+  }
+
+  //! Release the matrices memoized by advance()
+  void clearAdvanceCache()
+  {
+    advance_cache_.clear();
+    advance_pow2_.clear();
+  }
+
+  //! INTERNAL compose the step matrices: [P1 G1] (first) followed by [P2 G2] gives [P2*P1, P2*G1 + G2]
+  static TooN::Matrix<> composeSteps(const TooN::Matrix<>& PG2, const TooN::Matrix<>& PG1)
+  {
+    const int n = PG1.num_rows();
+    const int ld = PG1.num_cols();
+    TooN::Matrix<> PG(n, ld);
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = 0; j < ld; j++)
+      {
+        double acc = (j < n) ? 0.0 : PG2(i, j);
+        for (int l = 0; l < n; l++)
+        {
+          acc += PG2(i, l) * PG1(l, j);
+        }
+        PG(i, j) = acc;
+      }
+    }
+    return PG;
   }
 
   virtual void reset() override
@@ -147,8 +449,29 @@ public:
               << C_ << std::endl
               << "D:" << std::endl
               << D_ << std::endl
-              << "state: " << state_ << std::endl
-              << "SS_LINEAR [END]" << std::endl;
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "SS_LINEAR [END]" << std::endl;
+  }
+
+  //! INTERNAL fused step: x(k) = [A B]*[x(k-1); u(k)] in state_, y(k) = [C D]*[x(k); u(k)] in y
+  inline void step(const double* u, double* y)
+  {
+    const int n = A_.num_rows();
+    const int m = B_.num_cols();
+    const int ld = n + m;
+    const double* ABCD = ABCD_.get_data_ptr();
+    double* z = z_.get_data_ptr();
+    double* x = state_.get_data_ptr();
+
+    for (int i = 0; i < n; i++)
+      z[i] = x[i];
+    for (int i = 0; i < m; i++)
+      z[n + i] = u[i];
+    Dense_Kernels::multiplyBlocked(ABCD, ld, n, ld, z, x);
+    for (int i = 0; i < n; i++)
+      z[i] = x[i];
+    Dense_Kernels::multiplyBlocked(ABCD + n * ld, ld, C_.num_rows(), ld, z, y);
   }
 
   //! INTERNAL - check matrix dimensions
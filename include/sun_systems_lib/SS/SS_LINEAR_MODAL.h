@@ -0,0 +1,576 @@
+/*
+    SS_LINEAR_MODAL Class, Linear State Space System in real modal form
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SS_LINEAR_MODAL_H
+#define SS_LINEAR_MODAL_H
+
+/*! \file SS_LINEAR_MODAL.h
+    \brief This class represents a Linear State Space System stepped in real modal form.
+*/
+
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <sun_systems_lib/Utils/Eigenvalues.h>
+#include <TooN/LU.h>
+
+namespace sun
+{
+//!  SS_LINEAR_MODAL class: represents a Linear State Space System stepped in real modal form.
+/*!
+    Same system of SS_LINEAR
+
+    \verbatim
+    x(k) = A*x(k-1) + B*u(k)
+    y(k) = C*x(k) + D*u(k)
+    \endverbatim
+
+    with A diagonalizable. The constructor computes the real modal form A = T*L*T^-1, L is block diagonal with a
+    1x1 block l for each real eigenvalue and a 2x2 block [a b; -b a] for each complex pair a +- ib.
+    The internal state is the modal state z = T^-1*x:
+
+    \verbatim
+    z(k) = L*z(k-1) + Bm*u(k),   Bm = T^-1*B
+    y(k) = Cm*z(k) + D*u(k),     Cm = C*T
+    \endverbatim
+
+    so the state update costs O(n) plus the input product, instead of the O(n^2) of A*x.
+
+    The SS_Interface functions (state_fcn(), output_fcn(), the Jacobians) are in the physical coordinates x, and
+    getState()/setState() convert from/to the modal state, so the observers (Luenberger_Observer, Kalman_Filter) work
+    as with SS_LINEAR.
+    The physical state x = T*z is computed lazily: apply() and simulate_block() only mark it as outdated, getState()
+    computes it (O(n^2)) on the first call after a step. So apply() costs O(n) plus the input/output products,
+    getModalState() has no cost.
+
+    The eigenvectors of a repeated eigenvalue are an orthonormal basis of its eigenspace (see
+    Eigenvalues::eigenvectors()), so the eigenvalues with multiplicity > 1 of a diagonalizable A are supported.
+    The constructor throws std::runtime_error if A is not diagonalizable (an eigenvector residual |A*v - l*v| larger
+    than 1e-8*max|A(i,j)|), or if the eigenvector matrix T is too badly conditioned (condition number > max_cond).
+
+    \warning getState() updates an internal cache, the const functions are not thread-safe on the same object.
+
+    \sa SS_LINEAR, Eigenvalues
+*/
+class SS_LINEAR_MODAL : public SS_Interface
+{
+private:
+  SS_LINEAR_MODAL();
+
+protected:
+  //! System Matrix (physical coordinates)
+  TooN::Matrix<> A_, B_, C_, D_;
+
+  //! Eigenvector matrix, x = T*z
+  TooN::Matrix<> T_;
+
+  //! Inverse of T, z = T^-1*x
+  TooN::Matrix<> T_inv_;
+
+  //! Modal input and output matrices, T^-1*B and C*T
+  TooN::Matrix<> Bm_, Cm_;
+
+  //! Diagonal of L (real parts of the eigenvalues)
+  TooN::Vector<> lambda_re_;
+
+  //! Imaginary parts of the eigenvalues, b for the first and -b for the second state of a 2x2 block, 0 for 1x1 blocks
+  TooN::Vector<> lambda_im_;
+
+  //! INTERNAL physical state x = T*z returned by getState(), computed lazily
+  mutable TooN::Vector<> x_;
+
+  //! INTERNAL true if the modal state changed after the last computation of x_
+  mutable bool x_outdated_ = false;
+
+  //! INTERNAL z = L*z + Bm*u in place (raw data)
+  inline void modalStateUpdate(double* z, const double* u) const
+  {
+    const int n = lambda_re_.size();
+    const int m = Bm_.num_cols();
+    const double* Bm = Bm_.get_data_ptr();
+    for (int i = 0; i < n;)
+    {
+      const double* bi = Bm + i * m;
+      double bu = 0.0;
+      for (int j = 0; j < m; j++)
+        bu += bi[j] * u[j];
+      if (lambda_im_[i] == 0.0)
+      {
+        z[i] = lambda_re_[i] * z[i] + bu;
+        i++;
+        continue;
+      }
+      const double* bi1 = bi + m;
+      double bu1 = 0.0;
+      for (int j = 0; j < m; j++)
+        bu1 += bi1[j] * u[j];
+      const double a = lambda_re_[i];
+      const double b = lambda_im_[i];
+      const double zi = z[i];
+      const double zi1 = z[i + 1];
+      z[i] = a * zi + b * zi1 + bu;
+      z[i + 1] = -b * zi + a * zi1 + bu1;
+      i += 2;
+    }
+  }
+
+  //! INTERNAL x_ = T*z, the physical state returned by getState()
+  inline void updatePhysicalState() const
+  {
+    const int n = T_.num_rows();
+    Dense_Kernels::multiplyBlocked(T_.get_data_ptr(), n, n, n, state_.get_data_ptr(), x_.get_data_ptr());
+    x_outdated_ = false;
+  }
+
+  //! INTERNAL y = Cm*z + D*u (raw data)
+  inline void modalOutput(const double* z, const double* u, double* y) const
+  {
+    const int n = Cm_.num_cols();
+    const int m = D_.num_cols();
+    const double* Cm = Cm_.get_data_ptr();
+    const double* D = D_.get_data_ptr();
+    for (int r = 0; r < Cm_.num_rows(); r++)
+    {
+      double acc = 0.0;
+      for (int j = 0; j < n; j++)
+        acc += Cm[r * n + j] * z[j];
+      for (int j = 0; j < m; j++)
+        acc += D[r * m + j] * u[j];
+      y[r] = acc;
+    }
+  }
+
+  //! INTERNAL compute the modal form of A_, see the class description
+  void computeModalForm(double max_cond)
+  {
+    typedef std::complex<double> Complex;
+    const int n = A_.num_rows();
+    const double tol = 1.0e-8;
+
+    double anorm = 0.0;
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+        anorm = std::max(anorm, std::fabs(A_(i, j)));
+    const double abs_tol = tol * std::max(anorm, 1.0);
+
+    // one eigenvalue for each real eigenvalue and each complex pair, a repeated real eigenvalue can be returned as a
+    // pair with a tiny imaginary part: it is real
+    const std::vector<Complex> all_lambda = Eigenvalues::eigenvalues(A_);
+    std::vector<Complex> lambda;
+    for (std::size_t e = 0; e < all_lambda.size(); e++)
+    {
+      if (std::fabs(all_lambda[e].imag()) <= abs_tol)
+        lambda.push_back(Complex(all_lambda[e].real(), 0.0));
+      else if (all_lambda[e].imag() > 0.0)
+        lambda.push_back(all_lambda[e]);
+    }
+    const std::vector<std::vector<Complex>> v = Eigenvalues::eigenvectors(A_, lambda, tol);
+
+    int col = 0;
+    for (std::size_t e = 0; e < lambda.size(); e++)
+    {
+      // residual |A*v - lambda*v|, large for the generalized eigenvectors of a defective eigenvalue
+      double residual = 0.0;
+      for (int i = 0; i < n; i++)
+      {
+        Complex r = -lambda[e] * v[e][i];
+        for (int j = 0; j < n; j++)
+          r += A_(i, j) * v[e][j];
+        residual += std::norm(r);
+      }
+      if (!(std::sqrt(residual) <= abs_tol))
+      {
+        throw std::runtime_error("[SS_LINEAR_MODAL] The matrix A is not diagonalizable");
+      }
+
+      if (lambda[e].imag() == 0.0)
+      {
+        if (col >= n)
+          break;
+        for (int i = 0; i < n; i++)
+          T_(i, col) = v[e][i].real();
+        lambda_re_[col] = lambda[e].real();
+        lambda_im_[col] = 0.0;
+        col++;
+        continue;
+      }
+      if (col + 1 >= n)
+        break;
+      // rotate the phase so that Re(v) and Im(v) are orthogonal (better conditioned T)
+      double rr = 0.0, ii = 0.0, ri = 0.0;
+      for (int i = 0; i < n; i++)
+      {
+        rr += v[e][i].real() * v[e][i].real();
+        ii += v[e][i].imag() * v[e][i].imag();
+        ri += v[e][i].real() * v[e][i].imag();
+      }
+      const Complex rot = std::polar(1.0, 0.5 * std::atan2(-2.0 * ri, rr - ii));
+      for (int i = 0; i < n; i++)
+      {
+        const Complex vi = rot * v[e][i];
+        T_(i, col) = vi.real();
+        T_(i, col + 1) = vi.imag();
+      }
+      lambda_re_[col] = lambda_re_[col + 1] = lambda[e].real();
+      lambda_im_[col] = lambda[e].imag();
+      lambda_im_[col + 1] = -lambda[e].imag();
+      col += 2;
+    }
+    if (col != n)
+    {
+      throw std::runtime_error("[SS_LINEAR_MODAL] Invalid eigenvalues of A");
+    }
+
+    TooN::LU<> lu(T_);
+    if (lu.get_info() != 0)
+    {
+      throw std::runtime_error("[SS_LINEAR_MODAL] The matrix A is not diagonalizable");
+    }
+    T_inv_ = lu.backsub(TooN::Matrix<>(TooN::Identity(n)));
+    const double cond = Dense_Kernels::norm1(T_) * Dense_Kernels::norm1(T_inv_);
+    if (!(cond <= max_cond))
+    {
+      throw std::runtime_error("[SS_LINEAR_MODAL] The matrix A is not diagonalizable (or is too close to a non "
+                               "diagonalizable one)");
+    }
+    Dense_Kernels::multiply(T_inv_, B_, Bm_);
+    Dense_Kernels::multiply(C_, T_, Cm_);
+  }
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    Constructor that takes the matrices of the system
+    \verbatim
+    x(k) = A*x(k-1) + B*u(k)
+    y(k) = C*x(k) + D*u(k)
+    \endverbatim
+    \param max_cond maximum condition number (1-norm) of the eigenvector matrix T (default 1e8)
+  */
+  SS_LINEAR_MODAL(const TooN::Matrix<>& A, const TooN::Matrix<>& B, const TooN::Matrix<>& C, const TooN::Matrix<>& D,
+                  double max_cond = 1e8)
+    : SS_Interface(TooN::Zeros(A.num_rows()), C.num_rows())
+    , A_(A)
+    , B_(B)
+    , C_(C)
+    , D_(D)
+    , T_(A.num_rows(), A.num_cols())
+    , T_inv_(A.num_rows(), A.num_cols())
+    , Bm_(B.num_rows(), B.num_cols())
+    , Cm_(C.num_rows(), C.num_cols())
+    , lambda_re_(A.num_rows())
+    , lambda_im_(A.num_rows())
+    , x_(TooN::Zeros(A.num_rows()))
+  {
+    if (!chek_dimensions())
+    {
+      throw std::invalid_argument("[SS_LINEAR_MODAL] Invalid matrix dimensions");
+    }
+    computeModalForm(max_cond);
+  }
+
+  //! Constructor from a SS_LINEAR, the state is converted in modal coordinates
+  SS_LINEAR_MODAL(const SS_LINEAR& ss, double max_cond = 1e8)
+    : SS_LINEAR_MODAL(ss.getA(), ss.getB(), ss.getC(), ss.getD(), max_cond)
+  {
+    setState(ss.getState());
+  }
+
+  //! Copy Constructor
+  SS_LINEAR_MODAL(const SS_LINEAR_MODAL& ss) = default;
+
+  virtual SS_LINEAR_MODAL* clone() const override
+  {
+    return new SS_LINEAR_MODAL(*this);
+  }
+
+  //! Destructor
+  virtual ~SS_LINEAR_MODAL() override = default;
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return B_.num_cols();
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return C_.num_rows();
+  }
+
+  //! Get the internal state in physical coordinates, x = T*z
+  /*!
+    x is computed only if the modal state changed after the last call, see the class description.
+  */
+  virtual const TooN::Vector<>& getState() const override
+  {
+    if (x_outdated_)
+    {
+      updatePhysicalState();
+    }
+    return x_;
+  }
+
+  //! Set the internal state in physical coordinates, z = T^-1*x
+  virtual void setState(const TooN::Vector<>& state) override
+  {
+    Dense_Kernels::multiply(T_inv_, state, state_);
+    x_ = state;
+    x_outdated_ = false;
+  }
+
+  //! Get the internal modal state z
+  inline const TooN::Vector<>& getModalState() const
+  {
+    return state_;
+  }
+
+  inline const TooN::Matrix<>& getA() const
+  {
+    return A_;
+  }
+
+  inline const TooN::Matrix<>& getB() const
+  {
+    return B_;
+  }
+
+  inline const TooN::Matrix<>& getC() const
+  {
+    return C_;
+  }
+
+  inline const TooN::Matrix<>& getD() const
+  {
+    return D_;
+  }
+
+  //! Get the eigenvector matrix T, x = T*z
+  inline const TooN::Matrix<>& getT() const
+  {
+    return T_;
+  }
+
+  //! Get the block diagonal modal matrix L = T^-1*A*T
+  TooN::Matrix<> getModalA() const
+  {
+    const int n = lambda_re_.size();
+    TooN::Matrix<> L = TooN::Zeros(n, n);
+    for (int i = 0; i < n; i++)
+    {
+      L(i, i) = lambda_re_[i];
+      if (lambda_im_[i] > 0.0)
+      {
+        L(i, i + 1) = lambda_im_[i];
+        L(i + 1, i) = -lambda_im_[i];
+      }
+    }
+    return L;
+  }
+
+  //! Get the modal input matrix T^-1*B
+  inline const TooN::Matrix<>& getModalB() const
+  {
+    return Bm_;
+  }
+
+  //! Get the modal output matrix C*T
+  inline const TooN::Matrix<>& getModalC() const
+  {
+    return Cm_;
+  }
+
+  /*==============================================*/
+
+  /*=============SS FUNCTIONS=====================*/
+
+  inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k) const override
+  {
+    TooN::Vector<> x_k(A_.num_rows());
+    state_fcn_into(x_k_1, u_k, x_k);
+    return x_k;
+  }
+
+  inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
+  {
+    TooN::Vector<> y_k(C_.num_rows());
+    output_fcn_into(x_k, u_k, y_k);
+    return y_k;
+  }
+
+  inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_k_1,
+                                                      const TooN::Vector<>& u_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    return A_;
+  }
+
+  inline virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k,
+                                                       const TooN::Vector<>& u_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    return C_;
+  }
+
+  //! State function in physical coordinates, x_k = A*x_k_1 + B*u_k
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                     TooN::Vector<>& x_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    Dense_Kernels::multiply(A_, x_k_1, x_k);
+    Dense_Kernels::multiplyAdd(B_, u_k, x_k);
+  }
+
+  //! Output function in physical coordinates, y_k = C*x_k + D*u_k
+  inline virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                      TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    Dense_Kernels::multiply(C_, x_k, y_k);
+    Dense_Kernels::multiplyAdd(D_, u_k, y_k);
+  }
+
+  inline virtual void jacob_state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                           TooN::Matrix<>& F) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    F = A_;
+  }
+
+  inline virtual void jacob_output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                            TooN::Matrix<>& H) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    H = C_;
+  }
+
+  //! Apply the system in modal coordinates, see the class description
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    if (input.size() != B_.num_cols())
+    {
+      throw std::invalid_argument("[SS_LINEAR_MODAL::apply] Invalid input size");
+    }
+    step(input.get_data_ptr(), output_.get_data_ptr());
+    return output_;
+  }
+
+  //! Simulate the system on a whole input trajectory
+  /*!
+    \sa Discrete_System_Interface::simulate_block()
+  */
+  virtual void simulate_block(const double* U, double* Y, std::size_t num_samples) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    const int m = B_.num_cols();
+    const int p = C_.num_rows();
+    if (num_samples == 0)
+    {
+      return;
+    }
+    for (std::size_t k = 0; k < num_samples; k++)
+    {
+      step(U + k * m, Y + k * p);
+    }
+    for (int i = 0; i < p; i++)
+    {
+      output_[i] = Y[(num_samples - 1) * p + i];
+    }
+  }
+
+  //! INTERNAL modal step: z(k) = L*z(k-1) + Bm*u(k) in state_, y(k) = Cm*z(k) + D*u(k) in y
+  /*!
+    The physical state returned by getState() is marked as outdated.
+  */
+  inline void step(const double* u, double* y)
+  {
+    double* z = state_.get_data_ptr();
+    modalStateUpdate(z, u);
+    modalOutput(z, u, y);
+    x_outdated_ = true;
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  virtual void reset() override
+  {
+    SS_Interface::reset();
+    x_ = TooN::Zeros;
+    x_outdated_ = false;
+  }
+
+  virtual void display() const override
+  {
+    std::cout << "SS_LINEAR_MODAL:" << std::endl
+              << "A:" << std::endl
+              << A_ << std::endl
+              << "B:" << std::endl
+              << B_ << std::endl
+              << "C:" << std::endl
+              << C_ << std::endl
+              << "D:" << std::endl
+              << D_ << std::endl
+              << "eigenvalues (re): " << lambda_re_ << std::endl
+              << "eigenvalues (im): " << lambda_im_ << std::endl
+              << "state: " << getState() << std::endl
+              << "modal state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "SS_LINEAR_MODAL [END]" << std::endl;
+  }
+
+  //! INTERNAL - check matrix dimensions
+  virtual bool chek_dimensions() const
+  {
+    if (A_.num_rows() != A_.num_cols())
+      return false;
+    if (A_.num_rows() != B_.num_rows())
+      return false;
+    if (A_.num_cols() != C_.num_cols())
+      return false;
+
+    if (B_.num_cols() != D_.num_cols())
+      return false;
+
+    if (C_.num_rows() != D_.num_rows())
+      return false;
+
+    if (state_.size() != A_.num_rows())
+      return false;
+    if (output_.size() != C_.num_rows())
+      return false;
+
+    return true;
+  }
+
+  /*==============================================*/
+};
+
+using SS_LINEAR_MODAL_Ptr = std::unique_ptr<SS_LINEAR_MODAL>;
+
+}  // namespace sun
+
+#endif
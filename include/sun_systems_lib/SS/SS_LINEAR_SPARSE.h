@@ -0,0 +1,258 @@
+/*
+    SS_LINEAR_SPARSE Class, Linear State Space System with sparse matrices
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SS_LINEAR_SPARSE_H
+#define SS_LINEAR_SPARSE_H
+
+/*! \file SS_LINEAR_SPARSE.h
+    \brief This class represents a Linear State Space System with sparse (CSR) matrices.
+*/
+
+#include <sun_systems_lib/SS/SS_Interface.h>
+#include <sun_systems_lib/Utils/CSR_Matrix.h>
+
+namespace sun
+{
+//!  SS_LINEAR_SPARSE class: represents a Linear State Space System with sparse matrices.
+/*!
+    Same system of SS_LINEAR
+
+    \verbatim
+    x(k) = A*x(k-1) + B*u(k)
+    y(k) = C*x(k) + D*u(k)
+    \endverbatim
+
+    with the matrices stored in CSR format (CSR_Matrix): a step costs O(nnz) instead of O(n^2) and does not allocate.
+    It is meant for large and sparse models (e.g. discretized finite element plants).
+
+    The Jacobians are returned as dense matrices to respect the SS_Interface contract, the sparse ones are available
+    with getA(), getB(), getC(), getD().
+
+    \sa SS_LINEAR, CSR_Matrix
+*/
+class SS_LINEAR_SPARSE : public SS_Interface
+{
+private:
+  SS_LINEAR_SPARSE();
+
+protected:
+  //! System Matrix
+  CSR_Matrix A_, B_, C_, D_;
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor from sparse matrices
+  SS_LINEAR_SPARSE(const CSR_Matrix& A, const CSR_Matrix& B, const CSR_Matrix& C, const CSR_Matrix& D)
+    : SS_Interface(TooN::Zeros(A.num_rows()), C.num_rows()), A_(A), B_(B), C_(C), D_(D)
+  {
+    if (!chek_dimensions())
+    {
+      throw std::invalid_argument("[SS_LINEAR_SPARSE] Invalid matrix dimensions");
+    }
+  }
+
+  //! Constructor from dense matrices
+  /*!
+    \param drop_tol the elements with absolute value <= drop_tol are dropped (default 0.0 = only the exact zeros)
+  */
+  SS_LINEAR_SPARSE(const TooN::Matrix<>& A, const TooN::Matrix<>& B, const TooN::Matrix<>& C, const TooN::Matrix<>& D,
+                   double drop_tol = 0.0)
+    : SS_LINEAR_SPARSE(CSR_Matrix(A, drop_tol), CSR_Matrix(B, drop_tol), CSR_Matrix(C, drop_tol),
+                       CSR_Matrix(D, drop_tol))
+  {
+  }
+
+  //! Copy Constructor
+  SS_LINEAR_SPARSE(const SS_LINEAR_SPARSE& ss) = default;
+
+  virtual SS_LINEAR_SPARSE* clone() const override
+  {
+    return new SS_LINEAR_SPARSE(*this);
+  }
+
+  //! Destructor
+  virtual ~SS_LINEAR_SPARSE() override = default;
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return B_.num_cols();
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return C_.num_rows();
+  }
+
+  inline const CSR_Matrix& getA() const
+  {
+    return A_;
+  }
+
+  inline const CSR_Matrix& getB() const
+  {
+    return B_;
+  }
+
+  inline const CSR_Matrix& getC() const
+  {
+    return C_;
+  }
+
+  inline const CSR_Matrix& getD() const
+  {
+    return D_;
+  }
+
+  //! Total number of stored elements of A, B, C, D
+  inline int nnz() const
+  {
+    return A_.nnz() + B_.nnz() + C_.nnz() + D_.nnz();
+  }
+
+  /*==============================================*/
+
+  /*=============SS FUNCTIONS=====================*/
+
+  inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k) const override
+  {
+    TooN::Vector<> x_k(A_.num_rows());
+    state_fcn_into(x_k_1, u_k, x_k);
+    return x_k;
+  }
+
+  inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
+  {
+    TooN::Vector<> y_k(C_.num_rows());
+    output_fcn_into(x_k, u_k, y_k);
+    return y_k;
+  }
+
+  //! The state function Jacobian, dense copy of A (see getA())
+  inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_k_1,
+                                                      const TooN::Vector<>& u_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    return A_.toDense();
+  }
+
+  //! The output function Jacobian, dense copy of C (see getC())
+  inline virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k,
+                                                       const TooN::Vector<>& u_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    return C_.toDense();
+  }
+
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                     TooN::Vector<>& x_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    A_.multiply(x_k_1, x_k);
+    B_.multiplyAdd(u_k, x_k);
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                      TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    C_.multiply(x_k, y_k);
+    D_.multiplyAdd(u_k, y_k);
+  }
+
+  inline virtual void jacob_state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                           TooN::Matrix<>& F) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    A_.toDense_into(F);
+  }
+
+  inline virtual void jacob_output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                            TooN::Matrix<>& H) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    C_.toDense_into(H);
+  }
+
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  {
+    return SS_Interface::apply(input);
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  virtual void reset() override
+  {
+    return SS_Interface::reset();
+  }
+
+  virtual void display() const override
+  {
+    std::cout << "SS_LINEAR_SPARSE: " << getSizeInput() << " inputs, " << getSizeOutput() << " outputs, "
+              << getSizeState() << " states" << std::endl
+              << "nnz A: " << A_.nnz() << " (density " << A_.density() << ")" << std::endl
+              << "nnz B: " << B_.nnz() << std::endl
+              << "nnz C: " << C_.nnz() << std::endl
+              << "nnz D: " << D_.nnz() << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "SS_LINEAR_SPARSE [END]" << std::endl;
+  }
+
+  //! INTERNAL - check matrix dimensions
+  virtual bool chek_dimensions() const
+  {
+    if (A_.num_rows() != A_.num_cols())
+      return false;
+    if (A_.num_rows() != B_.num_rows())
+      return false;
+    if (A_.num_cols() != C_.num_cols())
+      return false;
+
+    if (B_.num_cols() != D_.num_cols())
+      return false;
+
+    if (C_.num_rows() != D_.num_rows())
+      return false;
+
+    if (state_.size() != A_.num_rows())
+      return false;
+
+    if (output_.size() != C_.num_rows())
+      return false;
+
+    return true;
+  }
+
+  /*==============================================*/
+};
+
+using SS_LINEAR_SPARSE_Ptr = std::unique_ptr<SS_LINEAR_SPARSE>;
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,332 @@
+/*
+    SS_LINEAR_Static Class, Linear State Space System with dimensions fixed at compile time
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SS_LINEAR_STATIC_H
+#define SS_LINEAR_STATIC_H
+
+/*! \file SS_LINEAR_Static.h
+    \brief This class represents a Linear State Space System with dimensions fixed at compile time.
+*/
+
+#include <sun_systems_lib/SS/SS_Interface.h>
+#include <sun_systems_lib/Utils/Unrolled_Kernels.h>
+
+namespace sun
+{
+//!  SS_LINEAR_Static class: represents a Linear State Space System with dimensions fixed at compile time.
+/*!
+    This class is the same system of SS_LINEAR, but the number of states NX, inputs NU and outputs NY are template
+    parameters:
+
+    \verbatim
+    x(k) = A*x(k-1) + B*u(k)
+    y(k) = C*x(k) + D*u(k)
+    \endverbatim
+
+    The matrices are fixed size TooN matrices, a matrix of the wrong size is a compile time error.
+    The matrices and the workspace are stored in the object (no heap), the products are unrolled at compile time
+    (Unrolled_Kernels) on the stacked matrix [A B; C D] as in SS_LINEAR, so the output is bit-identical to the one of
+    a SS_LINEAR with the same matrices.
+
+    The state and the output are the dynamic vectors of SS_Interface (allocated once by the constructor), so the
+    object can be used wherever a SS_Interface is expected (e.g. Luenberger_Observer, Kalman_Filter).
+    Use step() to run the system without virtual dispatch.
+
+    \sa SS_LINEAR, TF_SISO_Static
+*/
+template <int NX, int NU, int NY>
+class SS_LINEAR_Static : public SS_Interface
+{
+  static_assert(NX > 0 && NU > 0 && NY > 0, "[SS_LINEAR_Static] Dimensions must be positive");
+
+public:
+  //! Number of columns of the stacked matrix [A B; C D]
+  enum
+  {
+    NZ = NX + NU
+  };
+
+private:
+  SS_LINEAR_Static();
+
+protected:
+  //! System Matrix
+  TooN::Matrix<NX, NX> A_;
+  TooN::Matrix<NX, NU> B_;
+  TooN::Matrix<NY, NX> C_;
+  TooN::Matrix<NY, NU> D_;
+
+  //! Stacked system matrix [A B; C D]
+  TooN::Matrix<NX + NY, NZ> ABCD_;
+
+  //! INTERNAL Workspace z = [x; u] of step(), the const functions use a local one
+  TooN::Vector<NZ> z_;
+
+  //! INTERNAL Pack x and u in z
+  static inline void packInput(const double* x, const double* u, double* z)
+  {
+    Unrolled_Kernels<NX>::copy(x, z);
+    Unrolled_Kernels<NU>::copy(u, z + NX);
+  }
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    Constructor that takes the matrices of the system
+    \verbatim
+    x(k) = A*x(k-1) + B*u(k)
+    y(k) = C*x(k) + D*u(k)
+    \endverbatim
+  */
+  SS_LINEAR_Static(const TooN::Matrix<NX, NX>& A, const TooN::Matrix<NX, NU>& B, const TooN::Matrix<NY, NX>& C,
+                   const TooN::Matrix<NY, NU>& D)
+    : SS_Interface(TooN::Zeros(NX), NY), A_(A), B_(B), C_(C), D_(D), z_(TooN::Zeros)
+  {
+    for (int i = 0; i < NX; i++)
+    {
+      for (int j = 0; j < NX; j++)
+        ABCD_(i, j) = A_(i, j);
+      for (int j = 0; j < NU; j++)
+        ABCD_(i, NX + j) = B_(i, j);
+    }
+    for (int i = 0; i < NY; i++)
+    {
+      for (int j = 0; j < NX; j++)
+        ABCD_(NX + i, j) = C_(i, j);
+      for (int j = 0; j < NU; j++)
+        ABCD_(NX + i, NX + j) = D_(i, j);
+    }
+  }
+
+  //! Copy Constructor
+  SS_LINEAR_Static(const SS_LINEAR_Static& ss) = default;
+
+  virtual SS_LINEAR_Static* clone() const override
+  {
+    return new SS_LINEAR_Static(*this);
+  }
+
+  //! Destructor
+  virtual ~SS_LINEAR_Static() override = default;
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return NU;
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return NY;
+  }
+
+  virtual const unsigned int getSizeState() const override
+  {
+    return NX;
+  }
+
+  inline const TooN::Matrix<NX, NX>& getA() const
+  {
+    return A_;
+  }
+
+  inline const TooN::Matrix<NX, NU>& getB() const
+  {
+    return B_;
+  }
+
+  inline const TooN::Matrix<NY, NX>& getC() const
+  {
+    return C_;
+  }
+
+  inline const TooN::Matrix<NY, NU>& getD() const
+  {
+    return D_;
+  }
+
+  /*==============================================*/
+
+  /*=============SS FUNCTIONS=====================*/
+
+  inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k) const override
+  {
+    TooN::Vector<> x_k(NX);
+    state_fcn_into(x_k_1, u_k, x_k);
+    return x_k;
+  }
+
+  inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
+  {
+    TooN::Vector<> y_k(NY);
+    output_fcn_into(x_k, u_k, y_k);
+    return y_k;
+  }
+
+  inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_k_1,
+                                                      const TooN::Vector<>& u_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    return A_;
+  }
+
+  inline virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k,
+                                                       const TooN::Vector<>& u_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    return C_;
+  }
+
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                     TooN::Vector<>& x_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    TooN::Vector<NZ> z;
+    packInput(x_k_1.get_data_ptr(), u_k.get_data_ptr(), z.get_data_ptr());
+    Unrolled_Kernels<NX>::template multiply<NZ>(ABCD_.get_data_ptr(), z.get_data_ptr(), x_k.get_data_ptr());
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                      TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    TooN::Vector<NZ> z;
+    packInput(x_k.get_data_ptr(), u_k.get_data_ptr(), z.get_data_ptr());
+    Unrolled_Kernels<NY>::template multiply<NZ>(ABCD_.get_data_ptr() + NX * NZ, z.get_data_ptr(), y_k.get_data_ptr());
+  }
+
+  inline virtual void jacob_state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                           TooN::Matrix<>& F) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    F = A_;
+  }
+
+  inline virtual void jacob_output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                            TooN::Matrix<>& H) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    H = C_;
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Apply the system without virtual dispatch
+  /*!
+    x(k) = [A B]*[x(k-1); u(k)] in the internal state, y(k) = [C D]*[x(k); u(k)] in y.
+    \param u input u(k), NU elements
+    \param y output y(k), NY elements
+  */
+  inline void step(const double* u, double* y)
+  {
+    double* x = state_.get_data_ptr();
+    double* z = z_.get_data_ptr();
+    const double* ABCD = ABCD_.get_data_ptr();
+
+    packInput(x, u, z);
+    Unrolled_Kernels<NX>::template multiply<NZ>(ABCD, z, x);
+    Unrolled_Kernels<NX>::copy(x, z);
+    Unrolled_Kernels<NY>::template multiply<NZ>(ABCD + NX * NZ, z, y);
+  }
+
+  //! Apply the system without virtual dispatch on fixed size vectors
+  /*!
+    \param u_k Input at the current step u(k)
+    \return system output y(k)
+  */
+  inline TooN::Vector<NY> step(const TooN::Vector<NU>& u_k)
+  {
+    step(u_k.get_data_ptr(), output_.get_data_ptr());
+    TooN::Vector<NY> y_k;
+    Unrolled_Kernels<NY>::copy(output_.get_data_ptr(), y_k.get_data_ptr());
+    return y_k;
+  }
+
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    if (input.size() != NU)
+    {
+      throw std::invalid_argument("[SS_LINEAR_Static::apply] Invalid input size");
+    }
+    step(input.get_data_ptr(), output_.get_data_ptr());
+    return output_;
+  }
+
+  //! Simulate the system on a whole input trajectory
+  /*!
+    \sa Discrete_System_Interface::simulate_block()
+  */
+  virtual void simulate_block(const double* U, double* Y, std::size_t num_samples) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    if (num_samples == 0)
+    {
+      return;
+    }
+    for (std::size_t k = 0; k < num_samples; k++)
+    {
+      step(U + k * NU, Y + k * NY);
+    }
+    Unrolled_Kernels<NY>::copy(Y + (num_samples - 1) * NY, output_.get_data_ptr());
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  virtual void reset() override
+  {
+    return SS_Interface::reset();
+  }
+
+  virtual void display() const override
+  {
+    std::cout << "SS_LINEAR_Static<" << NX << "," << NU << "," << NY << ">:" << std::endl
+              << "A:" << std::endl
+              << A_ << std::endl
+              << "B:" << std::endl
+              << B_ << std::endl
+              << "C:" << std::endl
+              << C_ << std::endl
+              << "D:" << std::endl
+              << D_ << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "SS_LINEAR_Static [END]" << std::endl;
+  }
+
+  /*==============================================*/
+};
+
+template <int NX, int NU, int NY>
+using SS_LINEAR_Static_Ptr = std::unique_ptr<SS_LINEAR_Static<NX, NU, NY>>;
+
+}  // namespace sun
+
+#endif
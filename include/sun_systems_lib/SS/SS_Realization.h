@@ -0,0 +1,359 @@
+/*
+    SS_Realization, state space realizations of transfer functions
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SS_REALIZATION_H
+#define SS_REALIZATION_H
+
+/*! \file SS_Realization.h
+    \brief Minimal state space realizations of TF_SISO and TF_MIMO.
+*/
+
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <sun_systems_lib/TF/TF_MIMO.h>
+#include <sun_systems_lib/TF/TF_SOS.h>
+#include <vector>
+#include <cmath>
+
+namespace sun
+{
+//!  SS_Realization class: static functions for the minimal SS_LINEAR realization of transfer functions.
+/*!
+    The realization is built in two steps:
+    - All the elements of the same column (same input) with the same denominator share the states:
+      for each group the states are the filtered input w(k) = u(k)/a(q) and its past values
+      \verbatim
+      x(k) = [w(k), w(k-1), ..., w(k-L+1)]
+      \endverbatim
+      and each element adds b(q)*w(k) to its output row. The static gains are put in the D matrix.
+    - The uncontrollable and the unobservable modes are removed by orthogonal projections on the reachable
+      and on the observable subspaces (orthonormal Krylov bases).
+
+    The result follows the SS_LINEAR convention (y(k) depends on x(k)), it starts from the rest state.
+    The state of the transfer functions is not converted.
+
+    The elements must be TF_SISO (the input gain is included) or TF_SOS.
+
+    \sa SS_LINEAR, TF_MIMO, TF_SISO
+*/
+class SS_Realization
+{
+private:
+  SS_Realization();
+
+public:
+  //! Number of states of the realization steps
+  struct Report
+  {
+    //! Sum of the states of the elements realized one by one
+    unsigned int num_states_elements = 0;
+    //! States after the sharing of the common denominators
+    unsigned int num_states_shared = 0;
+    //! States of the minimal realization
+    unsigned int num_states_minimal = 0;
+  };
+
+  //! Minimal realization of a SISO transfer function
+  /*!
+    \param siso the system, TF_SISO or TF_SOS
+    \param tol relative tolerance for the rank decisions
+    \param report if not null, it is filled with the number of states
+    \return the 1x1 SS_LINEAR system
+  */
+  static SS_LINEAR minimalRealization(const SISO_System_Interface& siso, double tol = 1.0e-10,
+                                      Report* report = nullptr)
+  {
+    std::vector<Element> elements(1, makeElement(siso, 0, 0));
+    return realize(elements, 1, 1, tol, report);
+  }
+
+  //! Minimal realization of a MIMO transfer function
+  /*!
+    The ZERO elements are skipped.
+    \param mimo the system, the elements must be TF_SISO or TF_SOS
+    \param tol relative tolerance for the rank decisions
+    \param report if not null, it is filled with the number of states
+    \return the SS_LINEAR system
+  */
+  static SS_LINEAR minimalRealization(const TF_MIMO& mimo, double tol = 1.0e-10, Report* report = nullptr)
+  {
+    std::vector<Element> elements;
+    for (unsigned int i = 0; i < mimo.getSizeOutput(); i++)
+    {
+      for (unsigned int j = 0; j < mimo.getSizeInput(); j++)
+      {
+        Element el = makeElement(mimo.getSISO(i, j), i, j);
+        if (!isZero(el.num))
+        {
+          elements.push_back(el);
+        }
+      }
+    }
+    return realize(elements, mimo.getSizeInput(), mimo.getSizeOutput(), tol, report);
+  }
+
+  //! Remove the uncontrollable and the unobservable modes
+  /*!
+    \verbatim
+    x(k) = A*x(k-1) + B*u(k)
+    y(k) = C*x(k) + D*u(k)
+    \endverbatim
+    The system is projected on the reachable subspace and then on the orthogonal complement of the unobservable
+    subspace (the projections are exact for invariant subspaces).
+    \param tol relative tolerance for the rank decisions
+    \return the minimal SS_LINEAR system
+  */
+  static SS_LINEAR minimalRealization(const TooN::Matrix<>& A, const TooN::Matrix<>& B, const TooN::Matrix<>& C,
+                                      const TooN::Matrix<>& D, double tol = 1.0e-10)
+  {
+    // Reachable subspace
+    const TooN::Matrix<> V = krylovBasis(A, B, tol);
+    const TooN::Matrix<> A_r = V.T() * A * V;
+    const TooN::Matrix<> B_r = V.T() * B;
+    const TooN::Matrix<> C_r = C * V;
+
+    // Observable subspace of the reachable part
+    const TooN::Matrix<> W = krylovBasis(A_r.T(), C_r.T(), tol);
+    return SS_LINEAR(W.T() * A_r * W, W.T() * B_r, C_r * W, D);
+  }
+
+  //! Orthonormal basis of the smallest A-invariant subspace that contains the columns of B
+  /*!
+    Block Krylov iteration with twice repeated modified Gram-Schmidt.
+    A vector is added to the basis if the norm of its orthogonal component is greater than tol times its
+    reference scale (norm of B for the columns of B, norm of A for the others).
+    \return the n x r matrix of the basis
+  */
+  static TooN::Matrix<> krylovBasis(const TooN::Matrix<>& A, const TooN::Matrix<>& B, double tol = 1.0e-10)
+  {
+    const int n = A.num_rows();
+    const std::size_t max_rank = n;
+    const double scale_A = frobeniusNorm(A);
+    const double scale_B = frobeniusNorm(B);
+
+    std::vector<TooN::Vector<>> basis;
+    for (int j = 0; j < B.num_cols() && basis.size() < max_rank; j++)
+    {
+      addToBasis(basis, B.T()[j], tol * scale_B);
+    }
+    for (unsigned int k = 0; k < basis.size() && basis.size() < max_rank; k++)
+    {
+      addToBasis(basis, A * basis[k], tol * scale_A);
+    }
+
+    TooN::Matrix<> V = TooN::Zeros(n, basis.size());
+    for (unsigned int k = 0; k < basis.size(); k++)
+      for (int i = 0; i < n; i++)
+        V(i, k) = basis[k][i];
+    return V;
+  }
+
+private:
+  //! INTERNAL Element of the transfer function matrix
+  struct Element
+  {
+    unsigned int row;
+    unsigned int col;
+    //! Numerator in ascending powers of z^-1, input gain included
+    TooN::Vector<> num;
+    //! Denominator in ascending powers of z^-1, den[0] = 1
+    TooN::Vector<> den;
+
+    Element(unsigned int row, unsigned int col, const TooN::Vector<>& num, const TooN::Vector<>& den)
+      : row(row), col(col), num(num / den[0]), den(den / den[0])
+    {
+    }
+  };
+
+  //! INTERNAL Elements in the same column with the same denominator
+  struct Group
+  {
+    unsigned int col;
+    TooN::Vector<> den;
+    std::vector<const Element*> elements;
+
+    Group(unsigned int col, const TooN::Vector<>& den) : col(col), den(den)
+    {
+    }
+  };
+
+  //! INTERNAL Element with the normalized coefficients of a SISO transfer function
+  static Element makeElement(const SISO_System_Interface& siso, unsigned int row, unsigned int col)
+  {
+    if (const TF_SISO* tf = dynamic_cast<const TF_SISO*>(&siso))
+    {
+      return Element(row, col, tf->getInputGain() * tf->getNumeratorCoeff(), tf->getDenominatorCoeff());
+    }
+    if (const TF_SOS* sos = dynamic_cast<const TF_SOS*>(&siso))
+    {
+      return Element(row, col, sos->getNumeratorCoeff(), sos->getDenominatorCoeff());
+    }
+    throw std::invalid_argument("[SS_Realization] The elements have to be TF_SISO or TF_SOS");
+  }
+
+  //! INTERNAL True if all the coefficients are zero
+  static bool isZero(const TooN::Vector<>& v)
+  {
+    for (int i = 0; i < v.size(); i++)
+    {
+      if (v[i] != 0.0)
+        return false;
+    }
+    return true;
+  }
+
+  //! INTERNAL True if the two vectors are equal
+  static bool isEqual(const TooN::Vector<>& v1, const TooN::Vector<>& v2)
+  {
+    if (v1.size() != v2.size())
+      return false;
+    for (int i = 0; i < v1.size(); i++)
+    {
+      if (v1[i] != v2[i])
+        return false;
+    }
+    return true;
+  }
+
+  //! INTERNAL Frobenius norm
+  static double frobeniusNorm(const TooN::Matrix<>& M)
+  {
+    double norm_sq = 0.0;
+    for (int i = 0; i < M.num_rows(); i++)
+      for (int j = 0; j < M.num_cols(); j++)
+        norm_sq += M(i, j) * M(i, j);
+    return std::sqrt(norm_sq);
+  }
+
+  //! INTERNAL Orthogonalize v against the basis and add it if its residual norm is greater than threshold
+  static void addToBasis(std::vector<TooN::Vector<>>& basis, TooN::Vector<> v, double threshold)
+  {
+    if (threshold <= 0.0)
+    {
+      return;
+    }
+    for (int pass = 0; pass < 2; pass++)
+    {
+      for (const auto& q : basis)
+      {
+        v -= (q * v) * q;
+      }
+    }
+    const double norm_v = std::sqrt(v * v);
+    if (norm_v > threshold)
+    {
+      basis.push_back(TooN::Vector<>(v / norm_v));
+    }
+  }
+
+  //! INTERNAL Build the shared realization and reduce it
+  static SS_LINEAR realize(const std::vector<Element>& elements, unsigned int dim_input, unsigned int dim_output,
+                           double tol, Report* report)
+  {
+    TooN::Matrix<> D = TooN::Zeros(dim_output, dim_input);
+
+    // Group the elements by column and denominator, the static gains go in D
+    std::vector<Group> groups;
+    unsigned int num_states_elements = 0;
+    for (const auto& el : elements)
+    {
+      if (el.num.size() == 1 && el.den.size() == 1)
+      {
+        D(el.row, el.col) += el.num[0];
+        continue;
+      }
+      num_states_elements += groupOrder(el.num.size() - 1, el.den.size() - 1);
+      unsigned int g = 0;
+      while (g < groups.size() && !(groups[g].col == el.col && isEqual(groups[g].den, el.den)))
+      {
+        g++;
+      }
+      if (g == groups.size())
+      {
+        groups.push_back(Group(el.col, el.den));
+      }
+      groups[g].elements.push_back(&el);
+    }
+
+    // Number of states of each group
+    std::vector<unsigned int> group_order(groups.size());
+    unsigned int num_states = 0;
+    for (unsigned int g = 0; g < groups.size(); g++)
+    {
+      unsigned int num_order = 0;
+      for (const Element* el : groups[g].elements)
+      {
+        num_order = std::max(num_order, (unsigned int)el->num.size() - 1);
+      }
+      group_order[g] = groupOrder(num_order, groups[g].den.size() - 1);
+      num_states += group_order[g];
+    }
+
+    // Shared realization
+    TooN::Matrix<> A = TooN::Zeros(num_states, num_states);
+    TooN::Matrix<> B = TooN::Zeros(num_states, dim_input);
+    TooN::Matrix<> C = TooN::Zeros(dim_output, num_states);
+    unsigned int s = 0;
+    for (unsigned int g = 0; g < groups.size(); g++)
+    {
+      const TooN::Vector<>& a = groups[g].den;
+      // w(k) = u(k) - a1*w(k-1) - ... - am*w(k-m)
+      for (int i = 1; i < a.size(); i++)
+      {
+        A(s, s + i - 1) = -a[i];
+      }
+      // shift of the past values
+      for (unsigned int r = 1; r < group_order[g]; r++)
+      {
+        A(s + r, s + r - 1) = 1.0;
+      }
+      B(s, groups[g].col) = 1.0;
+      // y(k) += b0*w(k) + ... + bn*w(k-n)
+      for (const Element* el : groups[g].elements)
+      {
+        for (int t = 0; t < el->num.size(); t++)
+        {
+          C(el->row, s + t) += el->num[t];
+        }
+      }
+      s += group_order[g];
+    }
+
+    SS_LINEAR ss = minimalRealization(A, B, C, D, tol);
+
+    if (report != nullptr)
+    {
+      report->num_states_elements = num_states_elements;
+      report->num_states_shared = num_states;
+      report->num_states_minimal = ss.getSizeState();
+    }
+    return ss;
+  }
+
+  //! INTERNAL Number of states of a group with numerator order n and denominator order m
+  static unsigned int groupOrder(unsigned int n, unsigned int m)
+  {
+    return std::max(m, n + 1);
+  }
+};
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,232 @@
+/*
+    SS_Template Class, generic SS with the functions as template parameters
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SS_TEMPLATE_H
+#define SS_TEMPLATE_H
+
+/*! \file SS_Template.h
+    \brief This class implements a generic Discrete Time State Space System with inlined functions
+*/
+
+#include <sun_systems_lib/SS/SS_Interface.h>
+#include <sun_systems_lib/Utils/Fcn_Invoker.h>
+
+namespace sun
+{
+//!  SS_Template class: generic Discrete Time State Space System with the functions as template parameters.
+/*!
+    Same of SS, but the functions are stored by value with their own type (lambdas, functors) instead of
+    boost::function, so the calls are direct and the compiler can inline the user dynamics in apply().
+
+    \verbatim
+    x(k) = f(x(k-1),u(k))
+    y(k) = h(x(k),u(k))
+    \endverbatim
+
+    Each function can be given in the allocation free form f(x,u,out) or in the form out = f(x,u)
+    (see Fcn_Invoker). The Jacobians are optional (No_Jacobian throws).
+    The class is final, so the calls through an SS_Template are not virtual.
+    Use makeSS() to deduce the template parameters.
+
+    \sa SS, SS_Interface, Fcn_Invoker
+*/
+template <class State_Fcn, class Output_Fcn, class Jacob_State_Fcn = No_Jacobian,
+          class Jacob_Output_Fcn = No_Jacobian>
+class SS_Template final : public SS_Interface
+{
+private:
+  SS_Template();
+
+protected:
+  //! System fcns
+  State_Fcn state_fcn_;
+  Output_Fcn output_fcn_;
+  //! Jacobians fcns
+  Jacob_State_Fcn jacob_state_fcn_;
+  Jacob_Output_Fcn jacob_output_fcn_;
+
+  //! Dimensions
+  unsigned int dim_output_, dim_input_;
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    \param dim_state state dimension
+    \param dim_output output dimension
+    \param dim_input input dimension
+    \param state_fcn state transition function x(k) = f(x(k-1),u(k))
+    \param output_fcn output function y(k) = h(x(k),u(k))
+    \param jacob_state_fcn state function jacobian F = jac_state(x(k-1),u(k)) (default No_Jacobian)
+    \param jacob_output_fcn output function jacobian H = jac_output(x(k),u(k)) (default No_Jacobian)
+  */
+  SS_Template(unsigned int dim_state, unsigned int dim_output, unsigned int dim_input, const State_Fcn& state_fcn,
+              const Output_Fcn& output_fcn, const Jacob_State_Fcn& jacob_state_fcn = Jacob_State_Fcn(),
+              const Jacob_Output_Fcn& jacob_output_fcn = Jacob_Output_Fcn())
+    : SS_Interface(TooN::Zeros(dim_state), dim_output)
+    , state_fcn_(state_fcn)
+    , output_fcn_(output_fcn)
+    , jacob_state_fcn_(jacob_state_fcn)
+    , jacob_output_fcn_(jacob_output_fcn)
+    , dim_output_(dim_output)
+    , dim_input_(dim_input)
+  {
+  }
+
+  //! Copy Constructor
+  SS_Template(const SS_Template& ss) = default;
+
+  virtual SS_Template* clone() const override
+  {
+    return new SS_Template(*this);
+  }
+
+  //! Destructor
+  virtual ~SS_Template() override = default;
+
+  /*==============================================*/
+
+  /*=============SS FUNCTIONS=====================*/
+
+  inline virtual const TooN::Vector<> state_fcn(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k) const override
+  {
+    TooN::Vector<> x_k(getSizeState());
+    state_fcn_into(x_k_1, u_k, x_k);
+    return x_k;
+  }
+
+  inline virtual const TooN::Vector<> output_fcn(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k) const override
+  {
+    TooN::Vector<> y_k(dim_output_);
+    output_fcn_into(x_k, u_k, y_k);
+    return y_k;
+  }
+
+  inline virtual const TooN::Matrix<> jacob_state_fcn(const TooN::Vector<>& x_k_1,
+                                                      const TooN::Vector<>& u_k) const override
+  {
+    TooN::Matrix<> F(getSizeState(), getSizeState());
+    jacob_state_fcn_into(x_k_1, u_k, F);
+    return F;
+  }
+
+  inline virtual const TooN::Matrix<> jacob_output_fcn(const TooN::Vector<>& x_k,
+                                                       const TooN::Vector<>& u_k) const override
+  {
+    TooN::Matrix<> H(dim_output_, getSizeState());
+    jacob_output_fcn_into(x_k, u_k, H);
+    return H;
+  }
+
+  inline virtual void state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                     TooN::Vector<>& x_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(STATE_FCN);
+    Fcn_Invoker::into(state_fcn_, x_k_1, u_k, x_k);
+  }
+
+  inline virtual void output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                      TooN::Vector<>& y_k) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(OUTPUT_FCN);
+    Fcn_Invoker::into(output_fcn_, x_k, u_k, y_k);
+  }
+
+  inline virtual void jacob_state_fcn_into(const TooN::Vector<>& x_k_1, const TooN::Vector<>& u_k,
+                                           TooN::Matrix<>& F) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_STATE_FCN);
+    Fcn_Invoker::into(jacob_state_fcn_, x_k_1, u_k, F);
+  }
+
+  inline virtual void jacob_output_fcn_into(const TooN::Vector<>& x_k, const TooN::Vector<>& u_k,
+                                            TooN::Matrix<>& H) const override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(JACOB_OUTPUT_FCN);
+    Fcn_Invoker::into(jacob_output_fcn_, x_k, u_k, H);
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Apply the system, same of SS_Interface::apply() with direct calls of the functions
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& u_k) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    state_fcn_into(state_, u_k, state_next_);
+    state_ = state_next_;
+    output_fcn_into(state_, u_k, output_);
+    return output_;
+  }
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return dim_input_;
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return dim_output_;
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  virtual void display() const override
+  {
+    std::cout << "SS_Template:" << std::endl
+              << "Functions are defined at compile time" << std::endl
+              << "state: " << state_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "SS_Template [END]" << std::endl;
+  }
+
+  /*==============================================*/
+};
+
+//! Build a SS_Template deducing the types of the functions, the Jacobians are not defined
+template <class State_Fcn, class Output_Fcn>
+SS_Template<State_Fcn, Output_Fcn> makeSS(unsigned int dim_state, unsigned int dim_output, unsigned int dim_input,
+                                          const State_Fcn& state_fcn, const Output_Fcn& output_fcn)
+{
+  return SS_Template<State_Fcn, Output_Fcn>(dim_state, dim_output, dim_input, state_fcn, output_fcn);
+}
+
+//! Build a SS_Template deducing the types of the functions and of the Jacobians
+template <class State_Fcn, class Output_Fcn, class Jacob_State_Fcn, class Jacob_Output_Fcn>
+SS_Template<State_Fcn, Output_Fcn, Jacob_State_Fcn, Jacob_Output_Fcn>
+makeSS(unsigned int dim_state, unsigned int dim_output, unsigned int dim_input, const State_Fcn& state_fcn,
+       const Output_Fcn& output_fcn, const Jacob_State_Fcn& jacob_state_fcn, const Jacob_Output_Fcn& jacob_output_fcn)
+{
+  return SS_Template<State_Fcn, Output_Fcn, Jacob_State_Fcn, Jacob_Output_Fcn>(
+      dim_state, dim_output, dim_input, state_fcn, output_fcn, jacob_state_fcn, jacob_output_fcn);
+}
+
+}  // namespace sun
+
+#endif
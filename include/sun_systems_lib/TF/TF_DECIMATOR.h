@@ -0,0 +1,347 @@
+/*
+    TF_DECIMATOR Class, filter and downsample with a TF_SISO prototype
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TF_DECIMATOR_H
+#define TF_DECIMATOR_H
+
+/*! \file TF_DECIMATOR.h
+    \brief This class represents a decimator (filter + downsample) as Discrete Time System.
+*/
+
+#include "sun_systems_lib/TF/TF_SISO.h"
+#include "sun_systems_lib/Utils/Polynomial.h"
+#include <complex>
+#include <vector>
+
+namespace sun
+{
+//!  TF_DECIMATOR class: a TF_SISO prototype followed by the downsample of a factor R.
+/*!
+    The output is the prototype output at the input samples 0, R, 2R, ... (counted from the construction/reset):
+
+    \verbatim
+    y_d(k) = y(k*R),   Y(z) = H(z) U(z),   H(z) = B(z)/A(z) prototype (at the input rate)
+    \endverbatim
+
+    Only the kept samples are computed. The IIR prototypes are rewritten with the pole raising technique:
+
+    \verbatim
+                B(z) P(z)                   R-1
+    H(z) = ----------------,   P(z) = prod  A(exp(2*pi*i*j/R) z),   A'(z^R) = A(z) P(z)
+                A'(z^R)                    j=1
+    \endverbatim
+
+    so the recursion on the outputs uses only the kept outputs (the poles p become p^R). The cost per output is
+    about n + m*R + m operations instead of R*(n+m+1), the cost per input is a single store.
+    The outputs are the same of the prototype up to the rounding errors.
+
+    The system takes R inputs and returns 1 output (apply()), apply_block_resample() is the streaming interface for
+    any number of inputs. getTs() is the sampling time of the output.
+
+    \sa TF_SISO, TF_INTERPOLATOR
+*/
+class TF_DECIMATOR : public Discrete_System_Interface
+{
+private:
+  TF_DECIMATOR();
+
+protected:
+  //! Decimation factor R
+  unsigned int factor_;
+
+  //! Sampling time of the output
+  double ts_;
+
+  //! Numerator B(z)P(z), input gain included, size n' + 1
+  TooN::Vector<> b_vec_;
+  //! Reduced raised denominator [a'1 ... a'm], coefficients of z^-R ... z^-mR
+  TooN::Vector<> a_vec_;
+
+  //! Last inputs, circular buffer, size n' + 1
+  TooN::Vector<> u_vec_;
+  //! Last outputs at the output rate, circular buffer, size m
+  TooN::Vector<> y_vec_;
+  //! Last output, size 1
+  TooN::Vector<> y_k_ = TooN::Zeros(1);
+
+  //! Position of the last input in u_vec_
+  unsigned int u_head_ = 0;
+  //! Position of the last output in y_vec_
+  unsigned int y_head_ = 0;
+  //! Number of inputs before the next kept sample
+  unsigned int phase_ = 0;
+
+  //! INTERNAL Push an input, return true if an output is computed (in y_k_)
+  inline bool push(double u)
+  {
+    const unsigned int nu = u_vec_.size();
+    u_head_ = (u_head_ == 0) ? nu - 1 : u_head_ - 1;
+    u_vec_[u_head_] = u;
+
+    if (phase_ != 0)
+    {
+      phase_--;
+      return false;
+    }
+    phase_ = factor_ - 1;
+
+    double y = TF_SISO::circularDot(b_vec_.get_data_ptr(), u_vec_.get_data_ptr(), nu, u_head_);
+    const unsigned int deno = y_vec_.size();
+    if (deno != 0)
+    {
+      y_head_ = (y_head_ == 0) ? deno - 1 : y_head_ - 1;
+      y_vec_[y_head_] = y_k_[0];
+      y -= TF_SISO::circularDot(a_vec_.get_data_ptr(), y_vec_.get_data_ptr(), deno, y_head_);
+    }
+    y_k_[0] = y;
+    return true;
+  }
+
+public:
+  // STATIC
+
+  //! Pole raising compensator P(z)
+  /*!
+    \verbatim
+           R-1
+    P(z) = prod  A(exp(2*pi*i*j/R) z)
+           j=1
+    \endverbatim
+    A(z)P(z) has only the powers of z^-R. The complex factors are in conjugate pairs, P(z) is real.
+    \param den denominator coefficients [1 a1 ... am]
+    \param factor R
+    \return coefficients of P(z), size m*(R-1)+1
+  */
+  static TooN::Vector<> poleRaisingCompensator(const TooN::Vector<>& den, unsigned int factor)
+  {
+    const int m = den.size() - 1;
+    const double pi = std::acos(-1.0);
+    std::vector<std::complex<double>> p(1, 1.0);
+    for (unsigned int j = 1; j < factor; j++)
+    {
+      std::vector<std::complex<double>> res(p.size() + m, 0.0);
+      for (int i = 0; i <= m; i++)
+      {
+        const std::complex<double> c = den[i] * std::polar(1.0, 2.0 * pi * j * i / factor);
+        for (unsigned int l = 0; l < p.size(); l++)
+        {
+          res[i + l] += c * p[l];
+        }
+      }
+      p.swap(res);
+    }
+    TooN::Vector<> res(p.size());
+    for (unsigned int i = 0; i < p.size(); i++)
+    {
+      res[i] = p[i].real();
+    }
+    return res;
+  }
+
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    \param prototype the filter at the input rate (the input gain is included), only the coefficients are used
+    \param factor decimation factor R >= 1
+  */
+  TF_DECIMATOR(const TF_SISO& prototype, unsigned int factor)
+    : factor_(factor)
+    , ts_(prototype.getTs() * factor)
+    , b_vec_(Polynomial::multiply(prototype.getInputGain() * prototype.getNumeratorCoeff(),
+                                  poleRaisingCompensator(prototype.getDenominatorCoeff(), checkFactor(factor))))
+    , a_vec_(raisedDenominator(prototype.getDenominatorCoeff(), factor))
+    , u_vec_(TooN::Zeros(b_vec_.size()))
+    , y_vec_(TooN::Zeros(a_vec_.size()))
+  {
+  }
+
+  //! Copy Constructor
+  TF_DECIMATOR(const TF_DECIMATOR& dec) = default;
+
+  virtual ~TF_DECIMATOR() override = default;
+
+  //! Clone the object
+  virtual TF_DECIMATOR* clone() const override
+  {
+    return new TF_DECIMATOR(*this);
+  }
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  //! Get the decimation factor R
+  inline unsigned int getFactor() const
+  {
+    return factor_;
+  }
+
+  //! Get the sampling time of the output
+  inline virtual double getTs() const
+  {
+    return ts_;
+  }
+
+  //! Get the numerator B(z)P(z) (coefficients of z^-i at the input rate)
+  inline const TooN::Vector<>& getNumeratorCoeff() const
+  {
+    return b_vec_;
+  }
+
+  //! Get the raised denominator [1 a'1 ... a'm] (coefficients of z^-iR at the input rate)
+  inline TooN::Vector<> getDenominatorCoeff() const
+  {
+    TooN::Vector<> den(a_vec_.size() + 1);
+    den[0] = 1.0;
+    for (int i = 0; i < a_vec_.size(); i++)
+    {
+      den[i + 1] = a_vec_[i];
+    }
+    return den;
+  }
+
+  //! Get the last output
+  virtual double getLastOutput() const
+  {
+    return y_k_[0];
+  }
+
+  /*==============================================*/
+
+  /*=============SETTER===========================*/
+
+  //! Set the sampling time of the output (the one of the input is Ts/R)
+  inline virtual void setTs(double Ts)
+  {
+    ts_ = Ts;
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Apply R inputs, return 1 output
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  {
+    if (static_cast<unsigned int>(input.size()) != factor_)
+    {
+      throw std::domain_error("[TF_DECIMATOR::apply(Vector)] The input size has to be the decimation factor");
+    }
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    for (unsigned int i = 0; i < factor_; i++)
+    {
+      push(input[i]);
+    }
+    return y_k_;
+  }
+
+  //! Apply a block of inputs, return the outputs
+  /*!
+    The phase is kept between the calls, the block can have any size.
+    \param in input samples, size n
+    \param n number of inputs
+    \param out output samples, size at least (n + R - 1)/R, it can be the same array of in
+    \return number of outputs
+  */
+  inline std::size_t apply_block_resample(const double* in, std::size_t n, double* out)
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    std::size_t num_out = 0;
+    for (std::size_t i = 0; i < n; i++)
+    {
+      if (push(in[i]))
+      {
+        out[num_out++] = y_k_[0];
+      }
+    }
+    return num_out;
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  inline virtual void reset() override
+  {
+    u_vec_ = TooN::Zeros;
+    if (y_vec_.size() != 0)
+      y_vec_ = TooN::Zeros;
+    y_k_ = TooN::Zeros;
+    u_head_ = 0;
+    y_head_ = 0;
+    phase_ = 0;
+  }
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return factor_;
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return 1;
+  }
+
+  virtual void display() const override
+  {
+    std::cout << "TF_DECIMATOR:" << std::endl
+              << "   factor: " << factor_ << std::endl
+              << "   Ts: " << ts_ << std::endl
+              << "   b_vec: " << b_vec_ << std::endl
+              << "   a_vec: " << a_vec_ << std::endl
+              << "   y_k: " << y_k_[0] << std::endl;
+    getInstrumentation().display();
+    std::cout << "TF_DECIMATOR [END]" << std::endl;
+  }
+
+  /*==============================================*/
+
+private:
+  //! INTERNAL check the decimation factor
+  static unsigned int checkFactor(unsigned int factor)
+  {
+    if (factor == 0)
+    {
+      throw std::invalid_argument("[TF_DECIMATOR] The decimation factor has to be >= 1");
+    }
+    return factor;
+  }
+
+  //! INTERNAL reduced raised denominator, the coefficients of z^-R ... z^-mR of A(z)P(z)
+  static TooN::Vector<> raisedDenominator(const TooN::Vector<>& den, unsigned int factor)
+  {
+    const TooN::Vector<> raised = Polynomial::multiply(den, poleRaisingCompensator(den, factor));
+    const int m = den.size() - 1;
+    TooN::Vector<> res(m);
+    for (int i = 0; i < m; i++)
+    {
+      res[i] = raised[(i + 1) * factor];
+    }
+    return res;
+  }
+};
+
+using TF_DECIMATOR_Ptr = std::unique_ptr<TF_DECIMATOR>;
+
+}  // namespace sun
+
+#endif
@@ -54,8 +54,9 @@ protected:
   /*!
       Internal usage in implementation.
   */
-  TF_DIFFERENTIATOR(double Ts, const TooN::Vector<>& num_coeff, const TooN::Vector<>& den_coeff, double gain = 1.0)
-    : TF_SISO(num_coeff, den_coeff, Ts), gain_(gain)
+  TF_DIFFERENTIATOR(double Ts, const TooN::Vector<>& num_coeff, const TooN::Vector<>& den_coeff, double gain = 1.0,
+                    TF_Realization realization = TF_Realization::DIRECT_FORM_I)
+    : TF_SISO(num_coeff, den_coeff, Ts, realization), gain_(gain)
   {
   }
 
@@ -75,6 +76,15 @@ public:
   /*==============================================*/
 
   /*=============GETTER===========================*/
+  inline virtual double getInputGain() const override
+  {
+    return gain_;
+  }
+
+  inline virtual bool isBankable() const override
+  {
+    return typeid(*this) == typeid(TF_DIFFERENTIATOR);
+  }
   /*==============================================*/
 
   /*=============SETTER===========================*/
@@ -90,6 +100,11 @@ public:
   {
     return TF_SISO::apply(gain_ * uk);
   }
+
+  virtual void apply_block(const double* in, double* out, std::size_t n) override
+  {
+    apply_block_impl(in, out, n, gain_);
+  }
   /*==============================================*/
 
   /*=============VARIE===========================*/
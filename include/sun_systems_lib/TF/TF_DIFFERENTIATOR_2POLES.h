@@ -58,8 +58,9 @@ namespace sun
       \param Ts sampling time
       \param tau poles time constant
       \param gain gain of the integrator, default = 1
+      \param realization state layout, default = TF_Realization::DIRECT_FORM_I
   */
-    TF_DIFFERENTIATOR_2POLES(double Ts, double tau, double gain = 1.0)
+    TF_DIFFERENTIATOR_2POLES(double Ts, double tau, double gain = 1.0, TF_Realization realization = TF_Realization::DIRECT_FORM_I)
         : 
         TF_DIFFERENTIATOR(Ts, 
           TooN::makeVector(
@@ -71,7 +72,8 @@ namespace sun
             pow(Ts + 2.0 * tau, 2),
             2.0 * (pow(Ts, 2) - 4.0 * pow(tau, 2)), 
             pow(Ts - 2.0 * tau, 2)), 
-        gain)
+        gain,
+        realization)
         , tau_(tau)
     {
     }
@@ -89,6 +91,10 @@ namespace sun
     /*==============================================*/
 
     /*=============GETTER===========================*/
+    inline virtual bool isBankable() const override
+    {
+      return typeid(*this) == typeid(TF_DIFFERENTIATOR_2POLES);
+    }
     /*==============================================*/
 
     /*=============SETTER===========================*/
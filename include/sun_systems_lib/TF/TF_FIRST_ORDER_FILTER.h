@@ -60,11 +60,13 @@ public:
     \param cut_freq cut frequency
     \param Ts sampling time
     \param gain gain of the filter, default = 1
+    \param realization state layout, default = TF_Realization::DIRECT_FORM_I
 */
-TF_FIRST_ORDER_FILTER(double cut_freq, double Ts, double gain = 1.0)
+TF_FIRST_ORDER_FILTER(double cut_freq, double Ts, double gain = 1.0, TF_Realization realization = TF_Realization::DIRECT_FORM_I)
 :TF_SISO(   tf_first_order_get_num_coeff(cut_freq, Ts), 
             tf_first_order_get_den_coeff(cut_freq, Ts),
-            Ts ),
+            Ts,
+            realization ),
 gain_(gain)
 {}
 
@@ -102,6 +104,15 @@ static TooN::Vector<2> tf_first_order_get_den_coeff(double cut_freq, double Ts)
 /*==============================================*/
 
 /*=============GETTER===========================*/
+inline virtual double getInputGain() const override
+{
+    return gain_;
+}
+
+inline virtual bool isBankable() const override
+{
+    return typeid(*this) == typeid(TF_FIRST_ORDER_FILTER);
+}
 /*==============================================*/
 
 /*=============SETTER===========================*/
@@ -116,10 +127,8 @@ inline virtual void setTs(double Ts) override
 */
 inline virtual void setOutput(double output)
 {
-    u_vec_[0] = output;
-    u_vec_[1] = output;
-    y_vec_[0] = output;
-    y_k_[0] = output;
+    // unit DC gain, the steady state has input = output
+    setSteadyState(output, output);
 }
 /*==============================================*/
 
@@ -128,6 +137,11 @@ inline virtual double apply( double uk) override
 {
     return TF_SISO::apply( gain_*uk );
 }
+
+virtual void apply_block(const double* in, double* out, std::size_t n) override
+{
+    apply_block_impl(in, out, n, gain_);
+}
 /*==============================================*/
 
 /*=============VARIE===========================*/
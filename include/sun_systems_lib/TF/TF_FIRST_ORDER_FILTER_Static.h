@@ -0,0 +1,142 @@
+/*
+    TF_FIRST_ORDER_FILTER_Static Class
+
+    First order Low_Pass_Filter with fixed size storage
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TF_FIRST_ORDER_FILTER_STATIC_H
+#define TF_FIRST_ORDER_FILTER_STATIC_H
+
+/*! \file TF_FIRST_ORDER_FILTER_Static.h
+    \brief This class represents a first order filter as Discrete Time Transfer Function System with fixed size storage.
+*/
+
+#include "sun_systems_lib/TF/TF_SISO_Static.h"
+#include "sun_systems_lib/TF/TF_FIRST_ORDER_FILTER.h"
+
+namespace sun
+{
+//!  TF_FIRST_ORDER_FILTER_Static class: first order filter as TF_SISO_Static<1,1>.
+/*!
+    Same filter of TF_FIRST_ORDER_FILTER (tustin discretization), but the coefficients and the state are stored
+    in fixed size vectors and step() is not virtual.
+
+    The output is bit-identical to the one of TF_FIRST_ORDER_FILTER.
+
+    \sa TF_FIRST_ORDER_FILTER, TF_SISO_Static, TF_INTEGRATOR_Static
+*/
+class TF_FIRST_ORDER_FILTER_Static : public TF_SISO_Static<1, 1>
+{
+private:
+  TF_FIRST_ORDER_FILTER_Static();  // NO DEFAULT CONSTRUCTOR
+
+protected:
+  //! Additional filter gain
+  double gain_;
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+      \param cut_freq cut frequency
+      \param Ts sampling time
+      \param gain gain of the filter, default = 1
+  */
+  TF_FIRST_ORDER_FILTER_Static(double cut_freq, double Ts, double gain = 1.0)
+    : TF_SISO_Static<1, 1>(TF_FIRST_ORDER_FILTER::tf_first_order_get_num_coeff(cut_freq, Ts),
+                           TF_FIRST_ORDER_FILTER::tf_first_order_get_den_coeff(cut_freq, Ts), Ts)
+    , gain_(gain)
+  {
+  }
+
+  //! Copy constructor
+  TF_FIRST_ORDER_FILTER_Static(const TF_FIRST_ORDER_FILTER_Static& tf) = default;
+
+  //! Desctructor
+  virtual ~TF_FIRST_ORDER_FILTER_Static() override = default;
+
+  virtual TF_FIRST_ORDER_FILTER_Static* clone() const override
+  {
+    return new TF_FIRST_ORDER_FILTER_Static(*this);
+  }
+
+  /*==============================================*/
+
+  /*=============SETTER===========================*/
+  inline virtual void setTs(double Ts) override
+  {
+    throw "[TF_FIRST_ORDER_FILTER_Static::setTs] Cannot set Ts on TF_FIRST_ORDER_FILTER_Static";
+  }
+
+  //! Change the state so that the output is "output"
+  /*!
+      \param output output after the state change
+  */
+  inline void setOutput(double output)
+  {
+    u_vec_[0] = output;
+    u_vec_[1] = output;
+    y_vec_[0] = output;
+    y_k_ = output;
+  }
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Apply the filter without virtual dispatch
+  inline double step(double uk)
+  {
+    return TF_SISO_Static<1, 1>::step(gain_ * uk);
+  }
+
+  inline virtual double apply(double uk) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    return step(uk);
+  }
+
+  virtual void apply_block(const double* in, double* out, std::size_t n) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    for (std::size_t i = 0; i < n; i++)
+    {
+      out[i] = step(in[i]);
+    }
+  }
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+  virtual void display_tf() const override
+  {
+    std::cout << "TF_FIRST_ORDER_FILTER_Static:" << std::endl
+              << "   Ts: " << ts_ << std::endl
+              << "   cut_freq: " << (1.0 / (((1.0 / b_vec_[0]) - 1.0) * ts_ / 2.0)) / (2.0 * M_PI) << std::endl
+              << "   gain: " << gain_ << std::endl;
+  }
+
+  /*==============================================*/
+};
+
+using TF_FIRST_ORDER_FILTER_Static_Ptr = std::unique_ptr<TF_FIRST_ORDER_FILTER_Static>;
+
+}  // namespace sun
+
+#endif
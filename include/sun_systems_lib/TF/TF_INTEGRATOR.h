@@ -57,9 +57,10 @@ public:
   /*!
       \param Ts sampling time
       \param gain gain of the integrator, default = 1
+      \param realization state layout, default = TF_Realization::DIRECT_FORM_I
   */
-  TF_INTEGRATOR(double Ts, double gain = 1.0)
-    : TF_SISO((Ts / 2.0) * TooN::makeVector(1.0, 1.0), TooN::makeVector(1.0, -1.0), Ts), gain_(gain)
+  TF_INTEGRATOR(double Ts, double gain = 1.0, TF_Realization realization = TF_Realization::DIRECT_FORM_I)
+    : TF_SISO((Ts / 2.0) * TooN::makeVector(1.0, 1.0), TooN::makeVector(1.0, -1.0), Ts, realization), gain_(gain)
   {
   }
 
@@ -76,6 +77,15 @@ public:
   /*==============================================*/
 
   /*=============GETTER===========================*/
+  inline virtual double getInputGain() const override
+  {
+    return gain_;
+  }
+
+  inline virtual bool isBankable() const override
+  {
+    return typeid(*this) == typeid(TF_INTEGRATOR);
+  }
   /*==============================================*/
 
   /*=============SETTER===========================*/
@@ -90,10 +100,8 @@ public:
   */
   inline virtual void setOutput(double output)
   {
-    u_vec_[0] = 0.0;
-    u_vec_[1] = 0.0;
-    y_vec_[0] = output;
-    y_k_[0] = output;
+    // the steady state of an integrator has zero input
+    setSteadyState(0.0, output);
   }
   /*==============================================*/
 
@@ -102,6 +110,11 @@ public:
   {
     return TF_SISO::apply(gain_ * uk);
   }
+
+  virtual void apply_block(const double* in, double* out, std::size_t n) override
+  {
+    apply_block_impl(in, out, n, gain_);
+  }
   /*==============================================*/
 
   /*=============VARIE===========================*/
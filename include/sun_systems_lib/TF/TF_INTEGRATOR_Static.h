@@ -0,0 +1,137 @@
+/*
+    TF_INTEGRATOR_Static Class
+
+    Integrator transfer function using the trapez method with fixed size storage
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TF_INTEGRATOR_STATIC_H
+#define TF_INTEGRATOR_STATIC_H
+
+/*! \file TF_INTEGRATOR_Static.h
+    \brief This class represents an integrator as Discrete Time Transfer Function System with fixed size storage.
+*/
+
+#include "sun_systems_lib/TF/TF_SISO_Static.h"
+
+namespace sun
+{
+//!  TF_INTEGRATOR_Static class: integrator as TF_SISO_Static<1,1>.
+/*!
+    Same integrator of TF_INTEGRATOR (tustin discretization), but the coefficients and the state are stored
+    in fixed size vectors and step() is not virtual.
+
+    The output is bit-identical to the one of TF_INTEGRATOR.
+
+    \sa TF_INTEGRATOR, TF_SISO_Static, TF_FIRST_ORDER_FILTER_Static
+*/
+class TF_INTEGRATOR_Static : public TF_SISO_Static<1, 1>
+{
+private:
+  TF_INTEGRATOR_Static();  // NO DEFAULT CONSTRUCTOR
+
+protected:
+  //! Integrator gain
+  double gain_;
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+      \param Ts sampling time
+      \param gain gain of the integrator, default = 1
+  */
+  TF_INTEGRATOR_Static(double Ts, double gain = 1.0)
+    : TF_SISO_Static<1, 1>((Ts / 2.0) * TooN::makeVector(1.0, 1.0), TooN::makeVector(1.0, -1.0), Ts), gain_(gain)
+  {
+  }
+
+  //! Destructor
+  virtual ~TF_INTEGRATOR_Static() override = default;
+
+  virtual TF_INTEGRATOR_Static* clone() const override
+  {
+    return new TF_INTEGRATOR_Static(*this);
+  }
+
+  //! Copy Constructor
+  TF_INTEGRATOR_Static(const TF_INTEGRATOR_Static& tf) = default;
+  /*==============================================*/
+
+  /*=============SETTER===========================*/
+  inline virtual void setTs(double Ts) override
+  {
+    throw "[TF_INTEGRATOR_Static::setTs] Cannot set Ts on TF_INTEGRATOR_Static";
+  }
+
+  //! Change the state so that the output is "output"
+  /*!
+      \param output output after the state change
+  */
+  inline void setOutput(double output)
+  {
+    u_vec_[0] = 0.0;
+    u_vec_[1] = 0.0;
+    y_vec_[0] = output;
+    y_k_ = output;
+  }
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Apply the integrator without virtual dispatch
+  inline double step(double uk)
+  {
+    return TF_SISO_Static<1, 1>::step(gain_ * uk);
+  }
+
+  inline virtual double apply(double uk) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    return step(uk);
+  }
+
+  virtual void apply_block(const double* in, double* out, std::size_t n) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    for (std::size_t i = 0; i < n; i++)
+    {
+      out[i] = step(in[i]);
+    }
+  }
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  virtual void display_tf() const override
+  {
+    std::cout << "TF_INTEGRATOR_Static:" << std::endl
+              << "   Ts: " << ts_ << std::endl
+              << "   gain: " << gain_ << std::endl;
+  }
+
+  /*==============================================*/
+};
+
+using TF_INTEGRATOR_Static_Ptr = std::unique_ptr<TF_INTEGRATOR_Static>;
+
+}  // namespace sun
+
+#endif
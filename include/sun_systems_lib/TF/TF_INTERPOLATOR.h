@@ -0,0 +1,271 @@
+/*
+    TF_INTERPOLATOR Class, upsample and filter with a TF_SISO prototype
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TF_INTERPOLATOR_H
+#define TF_INTERPOLATOR_H
+
+/*! \file TF_INTERPOLATOR.h
+    \brief This class represents an interpolator (upsample + filter) as Discrete Time System.
+*/
+
+#include "sun_systems_lib/TF/TF_SISO.h"
+
+namespace sun
+{
+//!  TF_INTERPOLATOR class: upsample of a factor L (zero insertion) followed by a TF_SISO prototype.
+/*!
+    \verbatim
+    x(k*L) = u(k),  x(k*L + r) = 0  (r = 1 ... L-1),   Y(z) = H(z) X(z),   H(z) = B(z)/A(z) prototype (at the output rate)
+    \endverbatim
+
+    The inserted zeros are not multiplied: the numerator is split in L polyphase components
+
+    \verbatim
+    y(k*L + r) = sum_t b(r + t*L) u(k - t) - sum_i a(i) y(k*L + r - i)
+    \endverbatim
+
+    so the numerator costs (n+1)/L operations per output instead of n+1. The recursion on the outputs (IIR
+    prototypes) runs at the output rate. The outputs are the same of the prototype applied to the upsampled signal
+    up to the rounding errors. The prototype should have a DC gain L to keep the amplitude of the signal.
+
+    The system takes 1 input and returns L outputs (apply()), apply_block_resample() is the streaming interface.
+    getTs() is the sampling time of the output.
+
+    \sa TF_SISO, TF_DECIMATOR
+*/
+class TF_INTERPOLATOR : public Discrete_System_Interface
+{
+private:
+  TF_INTERPOLATOR();
+
+protected:
+  //! Interpolation factor L
+  unsigned int factor_;
+
+  //! Sampling time of the output
+  double ts_;
+
+  //! Number of taps of each polyphase component T = n/L + 1
+  unsigned int num_phase_taps_;
+
+  //! Polyphase components, the component r is [b(r) b(r+L) ... b(r+(T-1)L)] at r*T, size L*T
+  TooN::Vector<> b_phases_;
+  //! Reduced denominator [a1 ... am]
+  TooN::Vector<> a_vec_;
+
+  //! Last inputs, circular buffer, size T
+  TooN::Vector<> u_vec_;
+  //! Last outputs at the output rate (including the last one), circular buffer, size m
+  TooN::Vector<> y_vec_;
+  //! Last L outputs
+  TooN::Vector<> y_k_;
+
+  //! Position of the last input in u_vec_
+  unsigned int u_head_ = 0;
+  //! Position of the last output in y_vec_
+  unsigned int y_head_ = 0;
+
+  //! INTERNAL Push an input and compute L outputs
+  inline void push(double u, double* out)
+  {
+    const unsigned int nu = u_vec_.size();
+    u_head_ = (u_head_ == 0) ? nu - 1 : u_head_ - 1;
+    u_vec_[u_head_] = u;
+
+    const unsigned int deno = y_vec_.size();
+    for (unsigned int r = 0; r < factor_; r++)
+    {
+      const double* b = b_phases_.get_data_ptr() + r * num_phase_taps_;
+      double y = TF_SISO::circularDot(b, u_vec_.get_data_ptr(), nu, u_head_);
+      if (deno != 0)
+      {
+        // y_vec_ holds the previous outputs, the new output is pushed after the computation
+        y -= TF_SISO::circularDot(a_vec_.get_data_ptr(), y_vec_.get_data_ptr(), deno, y_head_);
+        y_head_ = (y_head_ == 0) ? deno - 1 : y_head_ - 1;
+        y_vec_[y_head_] = y;
+      }
+      out[r] = y;
+    }
+  }
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    \param prototype the filter at the output rate (the input gain is included), only the coefficients are used
+    \param factor interpolation factor L >= 1
+  */
+  TF_INTERPOLATOR(const TF_SISO& prototype, unsigned int factor)
+    : factor_(checkFactor(factor))
+    , ts_(prototype.getTs())
+    , num_phase_taps_(prototype.getNumeratorOrder() / factor + 1)
+    , b_phases_(TooN::Zeros(factor * num_phase_taps_))
+    , a_vec_(prototype.getDenominatorCoeff().slice(1, prototype.getDenominatorOrder()))
+    , u_vec_(TooN::Zeros(num_phase_taps_))
+    , y_vec_(TooN::Zeros(prototype.getDenominatorOrder()))
+    , y_k_(TooN::Zeros(factor))
+  {
+    const TooN::Vector<>& b = prototype.getNumeratorCoeff();
+    for (int i = 0; i < b.size(); i++)
+    {
+      b_phases_[(i % factor_) * num_phase_taps_ + i / factor_] = prototype.getInputGain() * b[i];
+    }
+  }
+
+  //! Copy Constructor
+  TF_INTERPOLATOR(const TF_INTERPOLATOR& interp) = default;
+
+  virtual ~TF_INTERPOLATOR() override = default;
+
+  //! Clone the object
+  virtual TF_INTERPOLATOR* clone() const override
+  {
+    return new TF_INTERPOLATOR(*this);
+  }
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  //! Get the interpolation factor L
+  inline unsigned int getFactor() const
+  {
+    return factor_;
+  }
+
+  //! Get the sampling time of the output
+  inline virtual double getTs() const
+  {
+    return ts_;
+  }
+
+  //! Get the last L outputs
+  virtual const TooN::Vector<>& getLastOutput() const
+  {
+    return y_k_;
+  }
+
+  /*==============================================*/
+
+  /*=============SETTER===========================*/
+
+  //! Set the sampling time of the output (the one of the input is Ts*L)
+  inline virtual void setTs(double Ts)
+  {
+    ts_ = Ts;
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Apply 1 input, return L outputs
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  {
+    if (input.size() != 1)
+    {
+      throw std::domain_error("[TF_INTERPOLATOR::apply(Vector)] The input has to be scalar");
+    }
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    push(input[0], y_k_.get_data_ptr());
+    return y_k_;
+  }
+
+  //! Apply a block of inputs, return the outputs
+  /*!
+    \param in input samples, size n
+    \param n number of inputs
+    \param out output samples, size n*L, it must not overlap in
+    \return number of outputs n*L
+  */
+  inline std::size_t apply_block_resample(const double* in, std::size_t n, double* out)
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    for (std::size_t i = 0; i < n; i++)
+    {
+      push(in[i], out + i * factor_);
+    }
+    if (n > 0)
+    {
+      for (unsigned int r = 0; r < factor_; r++)
+      {
+        y_k_[r] = out[(n - 1) * factor_ + r];
+      }
+    }
+    return n * factor_;
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  inline virtual void reset() override
+  {
+    u_vec_ = TooN::Zeros;
+    if (y_vec_.size() != 0)
+      y_vec_ = TooN::Zeros;
+    y_k_ = TooN::Zeros;
+    u_head_ = 0;
+    y_head_ = 0;
+  }
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return 1;
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return factor_;
+  }
+
+  virtual void display() const override
+  {
+    std::cout << "TF_INTERPOLATOR:" << std::endl
+              << "   factor: " << factor_ << std::endl
+              << "   Ts: " << ts_ << std::endl
+              << "   b_phases: " << b_phases_ << std::endl
+              << "   a_vec: " << a_vec_ << std::endl
+              << "   y_k: " << y_k_ << std::endl;
+    getInstrumentation().display();
+    std::cout << "TF_INTERPOLATOR [END]" << std::endl;
+  }
+
+  /*==============================================*/
+
+private:
+  //! INTERNAL check the interpolation factor
+  static unsigned int checkFactor(unsigned int factor)
+  {
+    if (factor == 0)
+    {
+      throw std::invalid_argument("[TF_INTERPOLATOR] The interpolation factor has to be >= 1");
+    }
+    return factor;
+  }
+};
+
+using TF_INTERPOLATOR_Ptr = std::unique_ptr<TF_INTERPOLATOR>;
+
+}  // namespace sun
+
+#endif
@@ -28,6 +28,8 @@
 
 #include <sun_systems_lib/Discrete_System_Interface.h>
 #include <sun_systems_lib/TF/TF_SISO.h>
+#include <sun_systems_lib/TF/TF_SISO_Bank.h>
+#include <vector>
 
 namespace sun
 {
@@ -35,6 +37,8 @@ namespace sun
 /*!
     This class is basically a matrix of SISO Systems.
 
+    The elements can be any SISO_System_Interface (e.g. TF_SISO, TF_SOS), the default element is a ZERO TF_SISO.
+
     \verbatim
     --                         --
     | TF_11   TF_12  ...  TF_1N |
@@ -44,7 +48,17 @@ namespace sun
     --                         --
     \endverbatim
 
-    \sa Linear_System_Interface, TF_FIRST_ORDER_FILTER, TF_SISO, TF_MIMO_DIAGONAL
+    The elements are not run one by one. The TF_SISO elements (see TF_SISO::isBankable()) are grouped by
+    realization and orders, each group is packed in a TF_SISO_Bank (coefficients and states in contiguous memory)
+    and it is evaluated in a single non-virtual pass. The ZERO elements are skipped, the other elements (e.g. TF_SOS)
+    are run with a virtual call. The outputs of the elements are summed in the original order, so the output is
+    the same of the element by element evaluation.
+    Only the last inputs are stored for the ZERO elements, their input history is rebuilt when needed.
+
+    While the system is running the state lives in the banks, it is copied back in the elements when needed
+    (setSISO(), display(), copy).
+
+    \sa Linear_System_Interface, TF_FIRST_ORDER_FILTER, TF_SISO, TF_MIMO_DIAGONAL, TF_SISO_Bank
 */
 class TF_MIMO : public Discrete_System_Interface
 {
@@ -53,7 +67,7 @@ private:
 
 protected:
   //! Storage fro the SISO TF systems
-  std::vector<TF_SISO_Ptr> siso_vect_;
+  std::vector<SISO_System_Interface_Ptr> siso_vect_;
 
   //! Input dimension
   unsigned int dim_input_;
@@ -61,6 +75,163 @@ protected:
   //! Last output
   TooN::Vector<> y_k_;
 
+  //! Group of elements with the same realization and orders, run by a TF_SISO_Bank
+  struct Element_Group
+  {
+    //! Bank that runs the elements
+    TF_SISO_Bank_Ptr bank;
+    //! Index of the elements in siso_vect_
+    std::vector<unsigned int> elements;
+    //! Input index of the elements
+    std::vector<unsigned int> columns;
+    //! Workspace: gathered inputs
+    std::vector<double> input;
+    //! Workspace: outputs of the bank
+    std::vector<double> output;
+  };
+
+  //! Groups of bankable elements
+  std::vector<Element_Group> groups_;
+
+  //! Index of the elements that are not bankable (run with a virtual call)
+  std::vector<unsigned int> virtual_elements_;
+
+  //! Nonzero elements of the rows, the row i is [row_ptr_[i], row_ptr_[i+1]) (CSR like)
+  std::vector<unsigned int> row_ptr_;
+  //! Index of the nonzero elements in siso_vect_, row by row in column order
+  std::vector<unsigned int> row_elements_;
+
+  //! Workspace: output of each element, size dim_output*dim_input
+  std::vector<double> elements_output_;
+
+  //! Index of the ZERO elements with an input history (DF-I), they are not run
+  std::vector<unsigned int> zero_elements_;
+  //! Last inputs, circular buffer of zero_history_size_ input vectors, used to rebuild the ZERO elements history
+  std::vector<double> zero_inputs_;
+  //! Longest input history of the ZERO elements
+  unsigned int zero_history_size_ = 0;
+  //! Position of the last input in zero_inputs_
+  unsigned int zero_head_ = 0;
+  //! Number of inputs not yet shifted in the ZERO elements history (at most zero_history_size_)
+  mutable int zero_pending_ = 0;
+
+  //! INTERNAL True if the output of the element is zero regardless of the input
+  static bool isZeroElement(const SISO_System_Interface& siso)
+  {
+    const TF_SISO* tf = dynamic_cast<const TF_SISO*>(&siso);
+    if (tf == nullptr || !tf->isBankable() || tf->getLastOutput() != 0.0)
+    {
+      return false;
+    }
+    const TooN::Vector<>& b = tf->getNumeratorCoeff();
+    for (int i = 0; i < b.size(); i++)
+    {
+      if (b[i] != 0.0)
+        return false;
+    }
+    const TooN::Vector<> state = tf->isTDF2() ? tf->getTDF2State() : tf->getOutputHistory();
+    for (int i = 0; i < state.size(); i++)
+    {
+      if (state[i] != 0.0)
+        return false;
+    }
+    return true;
+  }
+
+  //! INTERNAL Build the groups and the banks from the elements, the state is taken from the elements
+  void updateEngine()
+  {
+    groups_.clear();
+    virtual_elements_.clear();
+    zero_elements_.clear();
+    zero_history_size_ = 0;
+    row_elements_.clear();
+    row_ptr_.assign(1, 0);
+    elements_output_.assign(siso_vect_.size(), 0.0);
+
+    std::vector<std::vector<const TF_SISO*>> group_tf;
+    const unsigned int dim_output = getSizeOutput();
+    for (unsigned int i = 0; i < dim_output; i++)
+    {
+      for (unsigned int j = 0; j < dim_input_; j++)
+      {
+        const unsigned int index = i * dim_input_ + j;
+        if (isZeroElement(*siso_vect_[index]))
+        {
+          // not run, the input history (DF-I) is rebuilt by syncElements()
+          const unsigned int history_size = static_cast<const TF_SISO&>(*siso_vect_[index]).getInputHistory().size();
+          if (history_size != 0)
+          {
+            zero_elements_.push_back(index);
+            zero_history_size_ = std::max(zero_history_size_, history_size);
+          }
+          continue;
+        }
+        row_elements_.push_back(index);
+
+        const TF_SISO* tf = dynamic_cast<const TF_SISO*>(siso_vect_[index].get());
+        if (tf == nullptr || !tf->isBankable())
+        {
+          virtual_elements_.push_back(index);
+          continue;
+        }
+        unsigned int g = 0;
+        while (g < group_tf.size() && !TF_SISO_Bank::canBank({ group_tf[g][0], tf }))
+        {
+          g++;
+        }
+        if (g == group_tf.size())
+        {
+          group_tf.push_back(std::vector<const TF_SISO*>());
+          groups_.push_back(Element_Group());
+        }
+        group_tf[g].push_back(tf);
+        groups_[g].elements.push_back(index);
+        groups_[g].columns.push_back(j);
+      }
+      row_ptr_.push_back(row_elements_.size());
+    }
+
+    for (unsigned int g = 0; g < groups_.size(); g++)
+    {
+      groups_[g].bank = TF_SISO_Bank_Ptr(new TF_SISO_Bank(group_tf[g]));
+      groups_[g].input.assign(groups_[g].elements.size(), 0.0);
+      groups_[g].output.assign(groups_[g].elements.size(), 0.0);
+    }
+
+    zero_inputs_.assign(zero_history_size_ * dim_input_, 0.0);
+    zero_head_ = 0;
+    zero_pending_ = 0;
+  }
+
+  //! INTERNAL Copy the state of the banks in the elements
+  void syncElements() const
+  {
+    for (const auto& group : groups_)
+    {
+      for (unsigned int c = 0; c < group.elements.size(); c++)
+      {
+        group.bank->exportState(c, static_cast<TF_SISO&>(*siso_vect_[group.elements[c]]));
+      }
+    }
+
+    // ZERO elements: the last zero_pending_ inputs are shifted in the input history
+    for (unsigned int index : zero_elements_)
+    {
+      TF_SISO& tf = static_cast<TF_SISO&>(*siso_vect_[index]);
+      const unsigned int col = index % dim_input_;
+      const TooN::Vector<> old_hist = tf.getInputHistory();
+      TooN::Vector<> u_hist(old_hist.size());
+      for (int i = 0; i < u_hist.size(); i++)
+      {
+        u_hist[i] = (i < zero_pending_) ? zero_inputs_[((zero_head_ + i) % zero_history_size_) * dim_input_ + col] :
+                                          old_hist[i - zero_pending_];
+      }
+      tf.setHistory(u_hist, tf.getOutputHistory(), 0.0);
+    }
+    zero_pending_ = 0;
+  }
+
 public:
   //! Zero Constructor
   /*
@@ -74,18 +245,21 @@ public:
     int num_siso = dim_input_ * dim_output;
     for (int i = 0; i < num_siso; i++)
     {
-      siso_vect_.push_back(TF_SISO_Ptr(new TF_SISO()));
+      siso_vect_.push_back(SISO_System_Interface_Ptr(new TF_SISO()));
     }
+    updateEngine();
   }
 
   //! Copy constructor
   TF_MIMO(const TF_MIMO& mimo) : y_k_(mimo.y_k_)
   {
     dim_input_ = mimo.dim_input_;
+    mimo.syncElements();
     for (const auto& siso : mimo.siso_vect_)
     {
-      siso_vect_.push_back(TF_SISO_Ptr(siso->clone()));
+      siso_vect_.push_back(SISO_System_Interface_Ptr(siso->clone()));
     }
+    updateEngine();
   }
 
   virtual TF_MIMO* clone() const override
@@ -105,29 +279,95 @@ public:
     \param index_col
     \param siso the new siso element
   */
-  virtual void setSISO(unsigned int index_row, unsigned int index_col, const TF_SISO& siso)
+  virtual void setSISO(unsigned int index_row, unsigned int index_col, const SISO_System_Interface& siso)
   {
     if (index_row > getSizeOutput() || index_col > dim_input_)
     {
       throw std::out_of_range("[TF_MIMO::setSISO] Index out of range");
     }
 
-    siso_vect_[index_row * dim_input_ + index_col] = TF_SISO_Ptr(siso.clone());
+    syncElements();
+    siso_vect_[index_row * dim_input_ + index_col] = SISO_System_Interface_Ptr(siso.clone());
+    updateEngine();
+  }
+
+  //! Get a SISO element
+  /*!
+    \param index_row
+    \param index_col
+    \return the element (index_row,index_col), with the current state
+  */
+  virtual const SISO_System_Interface& getSISO(unsigned int index_row, unsigned int index_col) const
+  {
+    if (index_row >= getSizeOutput() || index_col >= dim_input_)
+    {
+      throw std::out_of_range("[TF_MIMO::getSISO] Index out of range");
+    }
+    syncElements();
+    return *siso_vect_[index_row * dim_input_ + index_col];
+  }
+
+  //! Number of TF_SISO_Bank used to run the elements
+  unsigned int getNumBanks() const
+  {
+    return groups_.size();
+  }
+
+  //! Number of elements run with a virtual call (not bankable)
+  unsigned int getNumVirtualElements() const
+  {
+    return virtual_elements_.size();
   }
 
   //////////////////////////////////
 
   inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
   {
-    y_k_ = TooN::Zeros;
-    int dim_output = getSizeOutput();
-    for (int i = 0; i < dim_output; i++)
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    const double* u = input.get_data_ptr();
+    double* y_elem = elements_output_.data();
+
+    for (auto& group : groups_)
     {
-      for (int j = 0; j < dim_input_; j++)
+      const unsigned int num = group.elements.size();
+      for (unsigned int c = 0; c < num; c++)
       {
-        y_k_[i] += siso_vect_[i * dim_input_ + j]->apply(input[j]);
+        group.input[c] = u[group.columns[c]];
+      }
+      group.bank->apply(group.input.data(), group.output.data());
+      for (unsigned int c = 0; c < num; c++)
+      {
+        y_elem[group.elements[c]] = group.output[c];
+      }
+    }
+    for (unsigned int index : virtual_elements_)
+    {
+      y_elem[index] = siso_vect_[index]->apply(u[index % dim_input_]);
+    }
+    if (zero_history_size_ != 0)
+    {
+      zero_head_ = (zero_head_ == 0) ? zero_history_size_ - 1 : zero_head_ - 1;
+      double* zero_input = zero_inputs_.data() + zero_head_ * dim_input_;
+      for (unsigned int j = 0; j < dim_input_; j++)
+      {
+        zero_input[j] = u[j];
+      }
+      if (zero_pending_ < static_cast<int>(zero_history_size_))
+      {
+        zero_pending_++;
       }
     }
+
+    const unsigned int dim_output = getSizeOutput();
+    for (unsigned int i = 0; i < dim_output; i++)
+    {
+      double y = 0.0;
+      for (unsigned int k = row_ptr_[i]; k < row_ptr_[i + 1]; k++)
+      {
+        y += y_elem[row_elements_[k]];
+      }
+      y_k_[i] = y;
+    }
     return y_k_;
   }
 
@@ -138,6 +378,11 @@ public:
     {
       siso->reset();
     }
+    for (auto& group : groups_)
+    {
+      group.bank->reset();
+    }
+    zero_pending_ = 0;
   }
 
   virtual const unsigned int getSizeInput() const override
@@ -152,23 +397,25 @@ public:
 
   virtual void display() const override
   {
+    syncElements();
     int dim_output = getSizeOutput();
     std::stringstream str;
-    str << "TF_MIMO " << dim_output << "x" << dim_input_ << ":" << std::endl;
+    str << "TF_MIMO " << dim_output << "x" << dim_input_ << " (" << groups_.size() << " TF_SISO_Bank, "
+        << virtual_elements_.size() << " virtual elements):" << std::endl;
 
     for (int i = 0; i < dim_output; i++)
     {
       for (int j = 0; j < dim_input_; j++)
       {
         str << "Position [" << i << "][" << j << "]" << std::endl;
-        siso_vect_[i * dim_input_ + j]->display_tf();
+        siso_vect_[i * dim_input_ + j]->display();
         str << "-----------------------------------" << std::endl;
       }
     }
 
-    str << "TF_MIMO [END]" << std::endl;
-
     std::cout << str.str();
+    getInstrumentation().display();
+    std::cout << "TF_MIMO [END]" << std::endl;
   }
 };
 
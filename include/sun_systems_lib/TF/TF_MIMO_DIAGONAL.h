@@ -46,7 +46,11 @@ namespace sun
     --                       --
     \endverbatim
 
-    \sa Linear_System_Interface, TF_FIRST_ORDER_FILTER, TF_SISO, TF_MIMO
+    If all the diagonal elements are TF_SISO with the same realization and orders (see TF_SISO_Bank::canBank()),
+    they are run by a single TF_SISO_Bank (structure of arrays, vectorizable loops on the channels), see TF_MIMO.
+    The bank is selected automatically, the outputs are the same of the element by element evaluation.
+
+    \sa Linear_System_Interface, TF_FIRST_ORDER_FILTER, TF_SISO, TF_MIMO, TF_SISO_Bank
 */
 
 class TF_MIMO_DIAGONAL : public TF_MIMO
@@ -72,10 +76,11 @@ public:
     Construct a TF_MIMO_DIAGONAL system with all identical SISO system on the diagolan.
     This is usefull (for example) to construct identical independent filters on a multy dimentional input.
   */
-  TF_MIMO_DIAGONAL(unsigned int dim, const TF_SISO& siso_on_diagonal) : TF_MIMO_DIAGONAL(dim)
+  TF_MIMO_DIAGONAL(unsigned int dim, const SISO_System_Interface& siso_on_diagonal) : TF_MIMO(dim, dim)
   {
     for (int i = 0; i < dim; i++)
-      setSISO(i, siso_on_diagonal);
+      siso_vect_[i * dim + i] = SISO_System_Interface_Ptr(siso_on_diagonal.clone());
+    updateEngine();
   }
 
   //! Copy Constructor
@@ -93,7 +98,7 @@ public:
 
   ///////////////////////////////////
 
-  virtual void setSISO(unsigned int index_row, unsigned int index_col, const TF_SISO& siso) override
+  virtual void setSISO(unsigned int index_row, unsigned int index_col, const SISO_System_Interface& siso) override
   {
     if (index_row != index_col)
     {
@@ -107,39 +112,37 @@ public:
   /*!
     Set the i-th diagonal index to siso
     \param index_diag digaonal index
-    \param siso TF_SISO system to set
+    \param siso SISO system to set
   */
-  virtual void setSISO(unsigned int index_diag, const TF_SISO& siso)
+  virtual void setSISO(unsigned int index_diag, const SISO_System_Interface& siso)
   {
-    TF_MIMO::setSISO(index_diag, index_diag, siso);
+    setSISO(index_diag, index_diag, siso);
   }
 
-  //////////////////////////////////
-
-  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  //! True if all the diagonal elements are run by a single TF_SISO_Bank
+  bool isBanked() const
   {
-    for (int i = 0; i < dim_input_; i++)
-    {
-      y_k_[i] = siso_vect_[i * dim_input_ + i]->apply(input[i]);
-    }
-    return y_k_;
+    return groups_.size() == 1 && groups_[0].elements.size() == dim_input_;
   }
 
+  //////////////////////////////////
+
   virtual void display() const
   {
+    syncElements();
     std::stringstream str;
-    str << "TF_MIMO_DIAGONAL " << dim_input_ << "x" << dim_input_ << ":" << std::endl;
+    str << "TF_MIMO_DIAGONAL " << dim_input_ << "x" << dim_input_ << (isBanked() ? " (TF_SISO_Bank)" : "") << ":" << std::endl;
 
     for (int i = 0; i < dim_input_; i++)
     {
       str << "Position [" << i << "][" << i << "]" << std::endl;
-      siso_vect_[i * dim_input_ + i]->display_tf();
+      siso_vect_[i * dim_input_ + i]->display();
       str << "-----------------------------------" << std::endl;
     }
 
-    str << "TF_MIMO_DIAGONAL [END]" << std::endl;
-
     std::cout << str.str();
+    getInstrumentation().display();
+    std::cout << "TF_MIMO_DIAGONAL [END]" << std::endl;
   }
 };
 
@@ -28,6 +28,9 @@
 */
 
 #include "sun_systems_lib/SISO_System_Interface.h"
+#include "sun_systems_lib/Utils/FFT.h"
+#include <algorithm>
+#include <typeinfo>
 
 /*
          b0 + b1*z-1 + b2*z-2 + ... + bn*z-n
@@ -46,10 +49,29 @@
 
     yk = b_vecT * u_vec - a_vecT * y_vec
 
+    u_vec and y_vec are stored as circular buffers, the shift of the state is O(1)
+
+    Transposed Direct Form II (N = max(n,m), b_i = 0 for i>n, a_i = 0 for i>m):
+
+    yk = b0*uk + z0
+    zi = b(i+1)*uk - a(i+1)*yk + z(i+1)     i = 0 ... N-2
+    z(N-1) = bN*uk - aN*yk
+
+    z_vec = [z0 ... z(N-1)]T -> size N
+
 */
 
 namespace sun
 {
+//! State layout of a TF_SISO
+enum class TF_Realization
+{
+  //! Direct Form I, the state is the last n+1 inputs and the last m outputs
+  DIRECT_FORM_I,
+  //! Transposed Direct Form II, the state is a vector of max(n,m) elements
+  TRANSPOSED_DIRECT_FORM_II
+};
+
 //!  TF_SISO class: represents a generic Discrete Time Transfer Function System.
 /*!
     This class is a generic Discrete Time Transfer Function System in the form:
@@ -80,9 +102,26 @@ namespace sun
 
     \endverbatim
 
-    It stores the internal system state
+    It stores the internal system state.
+
+    The state layout is chosen at construction (see TF_Realization):
+    - TF_Realization::DIRECT_FORM_I (default): u_vec and y_vec as above, n+1+m state values.
+    - TF_Realization::TRANSPOSED_DIRECT_FORM_II: max(n,m) state values z_vec, updated in a single sweep:
+
+    \verbatim
+
+    y(k)   = b0*u(k) + z0
+    zi     = b(i+1)*u(k) - a(i+1)*y(k) + z(i+1)     i = 0 ... N-2
+    z(N-1) = bN*u(k) - aN*y(k)
 
-    \sa Linear_System_Interface, TF_INTEGRATOR, TF_FIRST_ORDER_FILTER, TF_MIMO
+    \endverbatim
+
+    The two realizations have the same transfer function, the outputs may differ for the rounding errors.
+
+    FIR filters (m = 0) in DIRECT_FORM_I can run apply_block() with FFT convolution (overlap-save), see
+    setFFTBlockMode(). It is convenient for long filters (hundreds of taps) and long blocks.
+
+    \sa Linear_System_Interface, TF_INTEGRATOR, TF_FIRST_ORDER_FILTER, TF_MIMO, TF_SOS
 */
 class TF_SISO : public SISO_System_Interface
 {
@@ -151,23 +190,245 @@ public:
     return den_coeff.slice(1, effective_size - 1) / den_coeff[0];
   }
 
+  //! INTERNAL dot product with a circular buffer
+  /*!
+    Computes coeff[0]*buffer[head] + coeff[1]*buffer[head+1] + ... (indexes of buffer are modulo size).
+    The summation order is the same of a plain dot product.
+    \param coeff coefficients, size "size"
+    \param buffer circular buffer, size "size"
+    \param size size of coeff and buffer
+    \param head position of the first (most recent) element of the circular buffer
+    \return the dot product
+  */
+  inline static double circularDot(const double* coeff, const double* buffer, unsigned int size, unsigned int head)
+  {
+    double res = 0.0;
+    const unsigned int first_chunk = size - head;
+    for (unsigned int i = 0; i < first_chunk; i++)
+    {
+      res += coeff[i] * buffer[head + i];
+    }
+    for (unsigned int i = first_chunk; i < size; i++)
+    {
+      res += coeff[i] * buffer[i - first_chunk];
+    }
+    return res;
+  }
+
+  //! INTERNAL zero padded copy of v
+  inline static TooN::Vector<> zeroPadded(const TooN::Vector<>& v, unsigned int size)
+  {
+    TooN::Vector<> res = TooN::Zeros(size);
+    for (int i = 0; i < v.size(); i++)
+    {
+      res[i] = v[i];
+    }
+    return res;
+  }
+
+  //! INTERNAL one step of the Transposed Direct Form II
+  /*!
+    \param b numerator coefficients, size order+1
+    \param a reduced denominator coefficients, size order
+    \param z state, size order
+    \param order filter order N = max(n,m)
+    \param u_k input at the current step u(k)
+    \return output y(k)
+  */
+  inline static double tdf2Step(const double* b, const double* a, double* z, unsigned int order, double u_k)
+  {
+    if (order == 0)
+    {
+      return b[0] * u_k;
+    }
+    const double y_k = b[0] * u_k + z[0];
+    for (unsigned int i = 0; i < order - 1; i++)
+    {
+      z[i] = b[i + 1] * u_k - a[i] * y_k + z[i + 1];
+    }
+    z[order - 1] = b[order] * u_k - a[order - 1] * y_k;
+    return y_k;
+  }
+
 private:
 protected:
   //! sampling time, this is just a here to be stored, not used
   double ts_;
 
+  //! State layout
+  TF_Realization realization_;
+
   //! Numerator coefficients, size n+1
   TooN::Vector<> b_vec_;  // n+1
   //! Reduced Denominator coefficients, without a0, size m
   TooN::Vector<> a_vec_;  // m
 
-  //! State vector, last inputs, size n+1
+  //! State vector, last inputs, size n+1 (circular buffer, see u_head_), void in TDF-II
   TooN::Vector<> u_vec_;  // n+1
-  //! State vector, last outputs, size m
+  //! State vector, last outputs, size m (circular buffer, see y_head_), void in TDF-II
   TooN::Vector<> y_vec_;  // m
   //! 1D vector, very last output, size 1
   TooN::Vector<> y_k_ = TooN::Zeros(1);  // last output
 
+  //! Position of u(k) in the circular buffer u_vec_
+  unsigned int u_head_ = 0;
+  //! Position of y(k-1) in the circular buffer y_vec_
+  unsigned int y_head_ = 0;
+
+  //! TDF-II numerator coefficients zero padded, size N+1, void in DF-I
+  TooN::Vector<> tdf2_b_;
+  //! TDF-II reduced denominator coefficients zero padded, size N, void in DF-I
+  TooN::Vector<> tdf2_a_;
+  //! TDF-II state vector, size N, void in DF-I
+  TooN::Vector<> z_vec_;
+
+  //! FFT block mode: FFT plan, size 0 if the mode is disabled
+  FFT fft_;
+  //! FFT block mode: transform of the zero padded numerator
+  std::vector<std::complex<double>> fft_b_;
+  //! FFT block mode: workspace, transformed segment
+  std::vector<std::complex<double>> fft_segment_;
+
+  //! Access the input history, returns u(k-i)
+  inline double& u_vec_at(unsigned int i)
+  {
+    return u_vec_[(u_head_ + i) % u_vec_.size()];
+  }
+
+  //! Access the output history, returns y(k-1-i)
+  inline double& y_vec_at(unsigned int i)
+  {
+    return y_vec_[(y_head_ + i) % y_vec_.size()];
+  }
+
+  //! INTERNAL block runner
+  /*!
+    Runs n steps of the filter with input input_gain*in[i].
+    The state is kept in local variables during the loop, the arithmetic is the same of apply(double), so the
+    result is bit-identical to n calls of apply(input_gain*in[i]) (except in FFT block mode, see setFFTBlockMode()).
+  */
+  inline void apply_block_impl(const double* in, double* out, std::size_t n, double input_gain)
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    if (realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II)
+    {
+      const double* b = tdf2_b_.get_data_ptr();
+      const double* a = tdf2_a_.get_data_ptr();
+      double* z = z_vec_.get_data_ptr();
+      const unsigned int order = z_vec_.size();
+      for (std::size_t i = 0; i < n; i++)
+      {
+        out[i] = tdf2Step(b, a, z, order, input_gain * in[i]);
+      }
+      if (n > 0)
+      {
+        y_k_[0] = out[n - 1];
+      }
+      return;
+    }
+
+    const double* b_vec = b_vec_.get_data_ptr();
+    double* u_vec = u_vec_.get_data_ptr();
+    const unsigned int nu = u_vec_.size();
+    unsigned int u_head = u_head_;
+    double y_k = y_k_[0];
+
+    const unsigned int deno = y_vec_.size();
+    if (deno == 0 && fft_.getSize() != 0)
+    {
+      apply_block_fft(in, out, n, input_gain);
+      return;
+    }
+    if (deno == 0)
+    {
+      for (std::size_t i = 0; i < n; i++)
+      {
+        u_head = (u_head == 0) ? nu - 1 : u_head - 1;
+        u_vec[u_head] = input_gain * in[i];
+        y_k = circularDot(b_vec, u_vec, nu, u_head);
+        out[i] = y_k;
+      }
+    }
+    else
+    {
+      const double* a_vec = a_vec_.get_data_ptr();
+      double* y_vec = y_vec_.get_data_ptr();
+      unsigned int y_head = y_head_;
+      for (std::size_t i = 0; i < n; i++)
+      {
+        u_head = (u_head == 0) ? nu - 1 : u_head - 1;
+        u_vec[u_head] = input_gain * in[i];
+        y_head = (y_head == 0) ? deno - 1 : y_head - 1;
+        y_vec[y_head] = y_k;
+        y_k = circularDot(b_vec, u_vec, nu, u_head) - circularDot(a_vec, y_vec, deno, y_head);
+        out[i] = y_k;
+      }
+      y_head_ = y_head;
+    }
+
+    u_head_ = u_head;
+    y_k_[0] = y_k;
+  }
+
+  //! INTERNAL block runner of the FFT block mode (overlap-save)
+  /*!
+    The signal [u(k-n) ... u(k-1), in[0] ... in[n-1]] is filtered in segments of P-n outputs, P = FFT size.
+    The overlap of each segment (the past n inputs) is read from the circular buffer. The inputs of a segment are
+    pushed in the circular buffer before its outputs are written, so out can be the same array of in. The only
+    workspace is the FFT buffer of size P.
+  */
+  inline void apply_block_fft(const double* in, double* out, std::size_t n, double input_gain)
+  {
+    if (n == 0)
+    {
+      return;
+    }
+    const unsigned int num_taps = u_vec_.size();
+    const unsigned int fft_size = fft_.getSize();
+    const unsigned int history_size = num_taps - 1;
+    const unsigned int segment_size = fft_size - history_size;
+    double* u_vec = u_vec_.get_data_ptr();
+
+    for (std::size_t start = 0; start < n; start += segment_size)
+    {
+      const std::size_t count = std::min<std::size_t>(segment_size, n - start);
+      for (unsigned int p = 0; p < history_size; p++)
+      {
+        fft_segment_[p] = u_vec_at(history_size - 1 - p);
+      }
+      for (std::size_t i = 0; i < count; i++)
+      {
+        fft_segment_[history_size + i] = input_gain * in[start + i];
+      }
+      for (unsigned int p = history_size + count; p < fft_size; p++)
+      {
+        fft_segment_[p] = 0.0;
+      }
+
+      // push the inputs of the segment in the circular buffer, as in the sample by sample mode
+      unsigned int u_head = u_head_;
+      for (std::size_t i = (count > num_taps) ? count - num_taps : 0; i < count; i++)
+      {
+        u_head = (u_head == 0) ? num_taps - 1 : u_head - 1;
+        u_vec[u_head] = input_gain * in[start + i];
+      }
+      u_head_ = u_head;
+
+      fft_.forward(fft_segment_.data());
+      for (unsigned int p = 0; p < fft_size; p++)
+      {
+        fft_segment_[p] *= fft_b_[p];
+      }
+      fft_.inverse(fft_segment_.data());
+      for (std::size_t i = 0; i < count; i++)
+      {
+        out[start + i] = fft_segment_[history_size + i].real();
+      }
+    }
+
+    y_k_[0] = out[n - 1];
+  }
+
 public:
   /*===============CONSTRUCTORS===================*/
 
@@ -178,13 +439,19 @@ public:
     \param num_coeff numerator coefficients [b0, ...., bn]
     \param den_coeff denominator coefficients [a0, ...., an]
     \param Ts Sampling time, it is just internally stored, default = NaN
+    \param realization state layout, default = TF_Realization::DIRECT_FORM_I
   */
-  TF_SISO(const TooN::Vector<>& num_coeff, const TooN::Vector<>& den_coeff, double Ts = NAN)
+  TF_SISO(const TooN::Vector<>& num_coeff, const TooN::Vector<>& den_coeff, double Ts = NAN,
+          TF_Realization realization = TF_Realization::DIRECT_FORM_I)
     : ts_(Ts)
+    , realization_(realization)
     , b_vec_(simplifyNumerator(num_coeff, den_coeff))
     , a_vec_(simplifyAndReduceDenominator(den_coeff))
-    , u_vec_(TooN::Zeros(b_vec_.size()))
-    , y_vec_(TooN::Zeros(a_vec_.size()))
+    , u_vec_(TooN::Zeros(isTDF2() ? 0 : b_vec_.size()))
+    , y_vec_(TooN::Zeros(isTDF2() ? 0 : a_vec_.size()))
+    , tdf2_b_(isTDF2() ? zeroPadded(b_vec_, getTDF2Order() + 1) : TooN::Vector<>(0))
+    , tdf2_a_(isTDF2() ? zeroPadded(a_vec_, getTDF2Order()) : TooN::Vector<>(0))
+    , z_vec_(TooN::Zeros(isTDF2() ? getTDF2Order() : 0))
   {
     // if(getNumeratorOrder() > getDenominatorOrder())
     // {
@@ -229,6 +496,62 @@ public:
     return (a_vec_.size());
   }
 
+  //! Get the state layout
+  inline virtual TF_Realization getRealization() const
+  {
+    return realization_;
+  }
+
+  //! True if the state layout is TF_Realization::TRANSPOSED_DIRECT_FORM_II
+  inline bool isTDF2() const
+  {
+    return realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II;
+  }
+
+  //! Get the order N = max(n,m) of the TDF-II realization
+  inline unsigned int getTDF2Order() const
+  {
+    return std::max<unsigned int>(b_vec_.size() - 1, a_vec_.size());
+  }
+
+  //! True if the system can be run in a TF_SISO_Bank
+  /*!
+    i.e. apply(u) is exactly TF_SISO::apply(getInputGain()*u).
+    The derived classes return true only for their exact type, so a class that derives them and changes apply()
+    is not bankable unless it overrides this function.
+  */
+  inline virtual bool isBankable() const
+  {
+    return typeid(*this) == typeid(TF_SISO);
+  }
+
+  //! Get the simplified numerator coefficients [b0, ...., bn]/a0
+  inline virtual const TooN::Vector<>& getNumeratorCoeff() const
+  {
+    return b_vec_;
+  }
+
+  //! Get the simplified denominator coefficients [1.0, a1/a0, ...., am/a0]
+  inline virtual TooN::Vector<> getDenominatorCoeff() const
+  {
+    TooN::Vector<> den(a_vec_.size() + 1);
+    den[0] = 1.0;
+    for (int i = 0; i < a_vec_.size(); i++)
+    {
+      den[i + 1] = a_vec_[i];
+    }
+    return den;
+  }
+
+  //! Get the gain applied to the input before the filter (1.0 for a plain TF_SISO)
+  /*!
+    The whole transfer function is getInputGain()*getNumeratorCoeff()/getDenominatorCoeff()
+  */
+  inline virtual double getInputGain() const
+  {
+    return 1.0;
+  }
+
   //! Get the sampling time
   inline virtual double getTs() const
   {
@@ -237,6 +560,14 @@ public:
 
   /*==============================================*/
 
+  //! True if apply_block() uses the FFT convolution, see setFFTBlockMode()
+  inline bool isFFTBlockMode() const
+  {
+    return fft_.getSize() != 0;
+  }
+
+  /*==============================================*/
+
   /*=============SETTER===========================*/
 
   //! Set the sampling time
@@ -245,6 +576,84 @@ public:
     ts_ = Ts;
   }
 
+  //! Enable/disable the FFT block mode of apply_block()
+  /*!
+    Only for FIR filters (m = 0) in TF_Realization::DIRECT_FORM_I, throws std::domain_error otherwise.
+
+    In FFT block mode apply_block() computes the convolution with the overlap-save method, the cost per sample is
+    O(log(n)) instead of O(n). The output matches the one of apply(double) up to the rounding errors (it is not
+    bit-identical). The state is the same of the sample by sample mode, the two can be mixed.
+    apply(double) is not affected.
+
+    \param enable true to enable the FFT block mode
+    \param fft_size size of the FFT, a power of 2 greater than n+1, default (0) = smallest power of 2 >= 4*(n+1)
+  */
+  inline void setFFTBlockMode(bool enable = true, unsigned int fft_size = 0)
+  {
+    if (!enable)
+    {
+      fft_ = FFT();
+      fft_b_.clear();
+      fft_segment_.clear();
+      return;
+    }
+    if (realization_ != TF_Realization::DIRECT_FORM_I || a_vec_.size() != 0)
+    {
+      throw std::domain_error("[TF_SISO::setFFTBlockMode] Only FIR filters in DIRECT_FORM_I");
+    }
+    const unsigned int num_taps = b_vec_.size();
+    if (fft_size == 0)
+    {
+      fft_size = FFT::nextPowerOfTwo(4 * num_taps);
+    }
+    if (fft_size <= num_taps)
+    {
+      throw std::invalid_argument("[TF_SISO::setFFTBlockMode] The FFT size has to be greater than n+1");
+    }
+    fft_ = FFT(fft_size);
+    fft_b_.assign(fft_size, 0.0);
+    for (unsigned int i = 0; i < num_taps; i++)
+    {
+      fft_b_[i] = b_vec_[i];
+    }
+    fft_.forward(fft_b_.data());
+    fft_segment_.assign(fft_size, 0.0);
+  }
+
+  //! Set the state as if input and output were constant
+  /*!
+    After the call the state is the one reached with u(k-i) = u and y(k-i) = y for all i, the last output is y.
+    The state is consistent (steady state) if y = H(1)*u.
+    It works with both the realizations.
+    \param u input of the coefficients (i.e. the input already multiplied by getInputGain())
+    \param y output
+  */
+  inline virtual void setSteadyState(double u, double y)
+  {
+    if (realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II)
+    {
+      // zi = sum_{j>i} (bj*u - aj*y)
+      double acc = 0.0;
+      for (int i = z_vec_.size() - 1; i >= 0; i--)
+      {
+        acc += tdf2_b_[i + 1] * u - tdf2_a_[i] * y;
+        z_vec_[i] = acc;
+      }
+    }
+    else
+    {
+      for (int i = 0; i < u_vec_.size(); i++)
+      {
+        u_vec_[i] = u;
+      }
+      for (int i = 0; i < y_vec_.size(); i++)
+      {
+        y_vec_[i] = y;
+      }
+    }
+    y_k_[0] = y;
+  }
+
   /*==============================================*/
 
   /*=============RUNNER===========================*/
@@ -261,43 +670,54 @@ public:
 
   inline virtual double apply(double u_k) override
   {
-    // Shift u_vec
-    const unsigned int no = u_vec_.size() - 1;
-    if (no != 0)
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    if (realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II)
     {
-      TooN::Vector<> tmp_u_vec = u_vec_;
-      u_vec_.slice(1, no) = tmp_u_vec.slice(0, no);
+      y_k_[0] = tdf2Step(tdf2_b_.get_data_ptr(), tdf2_a_.get_data_ptr(), z_vec_.get_data_ptr(), z_vec_.size(), u_k);
+      return y_k_[0];
     }
-    u_vec_[0] = u_k;
 
-    // Shift y_vec
+    // Push u(k) in the circular buffer, it overwrites the oldest input
+    const unsigned int nu = u_vec_.size();
+    u_head_ = (u_head_ == 0) ? nu - 1 : u_head_ - 1;
+    u_vec_[u_head_] = u_k;
+
     const unsigned int deno = y_vec_.size();
     if (deno == 0)
     {
-      y_k_[0] = b_vec_ * u_vec_;
+      y_k_[0] = circularDot(b_vec_.get_data_ptr(), u_vec_.get_data_ptr(), nu, u_head_);
       return y_k_[0];
     }
-    if (deno != 1)
-    {
-      TooN::Vector<> tmp_y_vec = y_vec_;
-      y_vec_.slice(1, deno - 1) = tmp_y_vec.slice(0, deno - 1);
-    }
-    y_vec_[0] = y_k_[0];
 
-    y_k_[0] = (b_vec_ * u_vec_) - (a_vec_ * y_vec_);
+    // Push y(k-1) in the circular buffer
+    y_head_ = (y_head_ == 0) ? deno - 1 : y_head_ - 1;
+    y_vec_[y_head_] = y_k_[0];
+
+    y_k_[0] = circularDot(b_vec_.get_data_ptr(), u_vec_.get_data_ptr(), nu, u_head_) -
+              circularDot(a_vec_.get_data_ptr(), y_vec_.get_data_ptr(), deno, y_head_);
 
     return y_k_[0];
   }
 
+  virtual void apply_block(const double* in, double* out, std::size_t n) override
+  {
+    apply_block_impl(in, out, n, 1.0);
+  }
+
   /*==============================================*/
 
   /*=============VARIE===========================*/
   inline virtual void reset() override
   {
-    u_vec_ = TooN::Zeros;
+    if (u_vec_.size() != 0)
+      u_vec_ = TooN::Zeros;
     if (y_vec_.size() != 0)
       y_vec_ = TooN::Zeros;
+    if (z_vec_.size() != 0)
+      z_vec_ = TooN::Zeros;
     y_k_ = TooN::Zeros;
+    u_head_ = 0;
+    y_head_ = 0;
   }
 
   virtual const unsigned int getSizeInput() const override
@@ -316,9 +736,91 @@ public:
     return y_k_[0];
   }
 
+  //! Get the input history [u(k) u(k-1) ... u(k-n)] (void vector in TDF-II)
+  virtual TooN::Vector<> getInputHistory() const
+  {
+    const unsigned int nu = u_vec_.size();
+    TooN::Vector<> u_hist(nu);
+    for (unsigned int i = 0; i < nu; i++)
+    {
+      u_hist[i] = u_vec_[(u_head_ + i) % nu];
+    }
+    return u_hist;
+  }
+
+  //! Get the output history [y(k-1) y(k-2) ... y(k-m)] (void vector in TDF-II)
+  virtual TooN::Vector<> getOutputHistory() const
+  {
+    const unsigned int deno = y_vec_.size();
+    TooN::Vector<> y_hist(deno);
+    for (unsigned int i = 0; i < deno; i++)
+    {
+      y_hist[i] = y_vec_[(y_head_ + i) % deno];
+    }
+    return y_hist;
+  }
+
+  //! Set the DF-I state
+  /*!
+    \param u_hist input history [u(k) u(k-1) ... u(k-n)]
+    \param y_hist output history [y(k-1) y(k-2) ... y(k-m)]
+    \param y_k last output y(k)
+  */
+  virtual void setHistory(const TooN::Vector<>& u_hist, const TooN::Vector<>& y_hist, double y_k)
+  {
+    if (realization_ != TF_Realization::DIRECT_FORM_I)
+    {
+      throw std::domain_error("[TF_SISO::setHistory] The realization is not DIRECT_FORM_I");
+    }
+    if (u_hist.size() != u_vec_.size() || y_hist.size() != y_vec_.size())
+    {
+      throw std::invalid_argument("[TF_SISO::setHistory] Invalid history size");
+    }
+    u_head_ = 0;
+    y_head_ = 0;
+    for (int i = 0; i < u_vec_.size(); i++)
+    {
+      u_vec_[i] = u_hist[i];
+    }
+    for (int i = 0; i < y_vec_.size(); i++)
+    {
+      y_vec_[i] = y_hist[i];
+    }
+    y_k_[0] = y_k;
+  }
+
+  //! Set the TDF-II state
+  /*!
+    \param z state [z0 ... z(N-1)]
+    \param y_k last output y(k)
+  */
+  virtual void setTDF2State(const TooN::Vector<>& z, double y_k)
+  {
+    if (realization_ != TF_Realization::TRANSPOSED_DIRECT_FORM_II)
+    {
+      throw std::domain_error("[TF_SISO::setTDF2State] The realization is not TRANSPOSED_DIRECT_FORM_II");
+    }
+    if (z.size() != z_vec_.size())
+    {
+      throw std::invalid_argument("[TF_SISO::setTDF2State] Invalid state size");
+    }
+    for (int i = 0; i < z_vec_.size(); i++)
+    {
+      z_vec_[i] = z[i];
+    }
+    y_k_[0] = y_k;
+  }
+
+  //! Get the TDF-II state [z0 ... z(N-1)] (void vector in DF-I)
+  virtual const TooN::Vector<>& getTDF2State() const
+  {
+    return z_vec_;
+  }
+
   virtual void display() const override
   {
     display_tf();
+    getInstrumentation().display();
   }
 
   //! Display the transfer function on the std out
@@ -326,11 +828,18 @@ public:
   {
     std::cout << "TF_SISO:" << std::endl
               << "   Num_Coeff= " << b_vec_ << std::endl
-              << "   Den_Coeff= 1.0 " << a_vec_ << std::endl
-              << "   State" << std::endl
-              << "   u_vec= " << u_vec_ << std::endl
-              << "   y_vec= " << y_vec_ << std::endl
-              << "   y_k= " << y_k_ << std::endl;
+              << "   Den_Coeff= 1.0 " << a_vec_ << std::endl;
+    if (realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II)
+    {
+      std::cout << "   State (TDF-II)" << std::endl << "   z_vec= " << z_vec_ << std::endl;
+    }
+    else
+    {
+      std::cout << "   State" << std::endl
+                << "   u_vec= " << getInputHistory() << std::endl
+                << "   y_vec= " << getOutputHistory() << std::endl;
+    }
+    std::cout << "   y_k= " << y_k_ << std::endl;
   }
 
   /*==============================================*/
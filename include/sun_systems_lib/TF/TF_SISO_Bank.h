@@ -0,0 +1,441 @@
+/*
+    TF_SISO_Bank Class, a bank of independent TF_SISO with the same orders (structure of arrays)
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TF_SISO_BANK_H
+#define TF_SISO_BANK_H
+
+/*! \file TF_SISO_Bank.h
+    \brief This class represents a bank of independent TF_SISO with the same orders.
+*/
+
+#include "sun_systems_lib/TF/TF_SISO.h"
+#include <vector>
+
+namespace sun
+{
+//!  TF_SISO_Bank class: a bank of C independent TF_SISO with the same orders.
+/*!
+    The i-th output is the i-th channel applied to the i-th input (it is a diagonal MIMO system).
+
+    Coefficients and states of all the channels are stored in structure of arrays layout:
+    the element j of channel c is at [j*C + c]. A step of the bank is a sequence of loops on the channels, on
+    contiguous memory and without dependencies between iterations, so the compiler can vectorize them
+    (AVX2, NEON...).
+
+    All the channels share the realization (see TF_Realization) and the orders:
+    - DIRECT_FORM_I: same n and m, the circular buffers of all the channels share the heads.
+    - TRANSPOSED_DIRECT_FORM_II: same N = max(n,m).
+
+    The arithmetic of each channel is the same of TF_SISO::apply(getInputGain()*u), so the outputs are
+    bit-identical to the ones of the single TF_SISO.
+
+    The channels are built from TF_SISO with TF_SISO::isBankable() true, the state can be moved from/to the
+    TF_SISO with importState() and exportState().
+
+    \sa TF_SISO, TF_MIMO_DIAGONAL
+*/
+class TF_SISO_Bank : public Discrete_System_Interface
+{
+public:
+  // STATIC
+
+  //! Check if the systems can be run in the same bank
+  /*!
+    \param channels the systems
+    \return true if all the systems are bankable, with the same realization and the same orders
+  */
+  static bool canBank(const std::vector<const TF_SISO*>& channels)
+  {
+    if (channels.empty())
+    {
+      return false;
+    }
+    const TF_SISO* first = channels[0];
+    for (const TF_SISO* ch : channels)
+    {
+      if (ch == nullptr || !ch->isBankable() || ch->getRealization() != first->getRealization())
+      {
+        return false;
+      }
+      if (first->getRealization() == TF_Realization::TRANSPOSED_DIRECT_FORM_II)
+      {
+        if (ch->getTDF2Order() != first->getTDF2Order())
+          return false;
+      }
+      else if (ch->getNumeratorOrder() != first->getNumeratorOrder() ||
+               ch->getDenominatorOrder() != first->getDenominatorOrder())
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  TF_SISO_Bank();
+
+protected:
+  //! Number of channels C
+  unsigned int num_channels_;
+
+  //! Realization of all the channels
+  TF_Realization realization_;
+
+  //! Size of the numerator coefficients (DF-I: n+1, TDF-II: N+1)
+  unsigned int num_size_;
+  //! Size of the reduced denominator coefficients (DF-I: m, TDF-II: N)
+  unsigned int den_size_;
+
+  //! Input gains, size C
+  TooN::Vector<> gain_;
+  //! Numerator coefficients, size num_size*C
+  TooN::Vector<> b_;
+  //! Reduced denominator coefficients, size den_size*C
+  TooN::Vector<> a_;
+
+  //! DF-I input circular buffers, size (n+1)*C (row j is u(k-j) for j = (u_head_ + i) % (n+1))
+  TooN::Vector<> u_;
+  //! DF-I output circular buffers, size m*C
+  TooN::Vector<> y_;
+  //! Position of u(k) in the circular buffers, shared by all the channels
+  unsigned int u_head_ = 0;
+  //! Position of y(k-1) in the circular buffers, shared by all the channels
+  unsigned int y_head_ = 0;
+
+  //! TDF-II state, size N*C
+  TooN::Vector<> z_;
+
+  //! Last output, size C
+  TooN::Vector<> y_k_;
+
+  //! Workspace: gained input, size C
+  TooN::Vector<> x_;
+  //! Workspace: denominator dot product, size C
+  TooN::Vector<> acc_;
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    Construct the bank with the coefficients and the state of the channels.
+    Throws std::invalid_argument if canBank(channels) is false.
+    \param channels the systems, one per channel
+  */
+  TF_SISO_Bank(const std::vector<const TF_SISO*>& channels)
+    : num_channels_(channels.size())
+    , realization_(isTDF2(channels) ? TF_Realization::TRANSPOSED_DIRECT_FORM_II : TF_Realization::DIRECT_FORM_I)
+    , num_size_(isTDF2(channels) ? channels[0]->getTDF2Order() + 1 : channels[0]->getNumeratorOrder() + 1)
+    , den_size_(isTDF2(channels) ? channels[0]->getTDF2Order() : channels[0]->getDenominatorOrder())
+    , gain_(channels.size())
+    , b_(TooN::Zeros(num_size_ * num_channels_))
+    , a_(TooN::Zeros(den_size_ * num_channels_))
+    , u_(TooN::Zeros(isTDF2(channels) ? 0 : num_size_ * num_channels_))
+    , y_(TooN::Zeros(isTDF2(channels) ? 0 : den_size_ * num_channels_))
+    , z_(TooN::Zeros(isTDF2(channels) ? den_size_ * num_channels_ : 0))
+    , y_k_(TooN::Zeros(num_channels_))
+    , x_(TooN::Zeros(num_channels_))
+    , acc_(TooN::Zeros(num_channels_))
+  {
+    for (unsigned int c = 0; c < num_channels_; c++)
+    {
+      const TF_SISO& ch = *channels[c];
+      gain_[c] = ch.getInputGain();
+      const TooN::Vector<>& b = ch.getNumeratorCoeff();
+      const TooN::Vector<> a = ch.getDenominatorCoeff();
+      for (int j = 0; j < b.size(); j++)
+      {
+        b_[j * num_channels_ + c] = b[j];
+      }
+      for (int j = 1; j < a.size(); j++)
+      {
+        a_[(j - 1) * num_channels_ + c] = a[j];
+      }
+      importState(c, ch);
+    }
+  }
+
+  //! Copy Constructor
+  TF_SISO_Bank(const TF_SISO_Bank& bank) = default;
+
+  virtual ~TF_SISO_Bank() override = default;
+
+  //! Clone the object
+  virtual TF_SISO_Bank* clone() const override
+  {
+    return new TF_SISO_Bank(*this);
+  }
+
+  /*==============================================*/
+
+  /*=============STATE============================*/
+
+  //! Copy the state of tf in the channel c
+  /*!
+    tf must have the same realization and orders of the bank.
+    With DF-I the shared heads are kept, the history of tf is copied in order.
+  */
+  void importState(unsigned int c, const TF_SISO& tf)
+  {
+    const unsigned int C = num_channels_;
+    if (realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II)
+    {
+      const TooN::Vector<>& z = tf.getTDF2State();
+      for (int j = 0; j < z.size(); j++)
+      {
+        z_[j * C + c] = z[j];
+      }
+    }
+    else
+    {
+      const TooN::Vector<> u_hist = tf.getInputHistory();
+      const TooN::Vector<> y_hist = tf.getOutputHistory();
+      for (unsigned int j = 0; j < num_size_; j++)
+      {
+        u_[((u_head_ + j) % num_size_) * C + c] = u_hist[j];
+      }
+      for (unsigned int j = 0; j < den_size_; j++)
+      {
+        y_[((y_head_ + j) % den_size_) * C + c] = y_hist[j];
+      }
+    }
+    y_k_[c] = tf.getLastOutput();
+  }
+
+  //! Copy the state of the channel c in tf
+  /*!
+    tf must have the same realization and orders of the bank.
+  */
+  void exportState(unsigned int c, TF_SISO& tf) const
+  {
+    const unsigned int C = num_channels_;
+    if (realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II)
+    {
+      TooN::Vector<> z(den_size_);
+      for (unsigned int j = 0; j < den_size_; j++)
+      {
+        z[j] = z_[j * C + c];
+      }
+      tf.setTDF2State(z, y_k_[c]);
+    }
+    else
+    {
+      TooN::Vector<> u_hist(num_size_), y_hist(den_size_);
+      for (unsigned int j = 0; j < num_size_; j++)
+      {
+        u_hist[j] = u_[((u_head_ + j) % num_size_) * C + c];
+      }
+      for (unsigned int j = 0; j < den_size_; j++)
+      {
+        y_hist[j] = y_[((y_head_ + j) % den_size_) * C + c];
+      }
+      tf.setHistory(u_hist, y_hist, y_k_[c]);
+    }
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Apply all the channels
+  /*!
+    \param in inputs, size C
+    \param out outputs, size C (it can be the same memory of in)
+  */
+  inline void apply(const double* in, double* out)
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    const unsigned int C = num_channels_;
+    const double* gain = gain_.get_data_ptr();
+    const double* b = b_.get_data_ptr();
+    const double* a = a_.get_data_ptr();
+    double* y_k = y_k_.get_data_ptr();
+    double* x = x_.get_data_ptr();
+
+    for (unsigned int c = 0; c < C; c++)
+    {
+      x[c] = gain[c] * in[c];
+    }
+
+    if (realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II)
+    {
+      // same arithmetic of TF_SISO::tdf2Step
+      const unsigned int order = den_size_;
+      if (order == 0)
+      {
+        for (unsigned int c = 0; c < C; c++)
+          y_k[c] = b[c] * x[c];
+      }
+      else
+      {
+        double* z = z_.get_data_ptr();
+        for (unsigned int c = 0; c < C; c++)
+          y_k[c] = b[c] * x[c] + z[c];
+        for (unsigned int i = 0; i < order - 1; i++)
+        {
+          const double* b_i = b + (i + 1) * C;
+          const double* a_i = a + i * C;
+          double* z_i = z + i * C;
+          const double* z_next = z + (i + 1) * C;
+          for (unsigned int c = 0; c < C; c++)
+            z_i[c] = b_i[c] * x[c] - a_i[c] * y_k[c] + z_next[c];
+        }
+        const double* b_last = b + order * C;
+        const double* a_last = a + (order - 1) * C;
+        double* z_last = z + (order - 1) * C;
+        for (unsigned int c = 0; c < C; c++)
+          z_last[c] = b_last[c] * x[c] - a_last[c] * y_k[c];
+      }
+    }
+    else
+    {
+      // same arithmetic of TF_SISO::apply, the dot products are accumulated in the same order
+      const unsigned int nu = num_size_;
+      const unsigned int deno = den_size_;
+      double* u = u_.get_data_ptr();
+      double* y = y_.get_data_ptr();
+      double* acc = acc_.get_data_ptr();
+
+      u_head_ = (u_head_ == 0) ? nu - 1 : u_head_ - 1;
+      double* u_new = u + u_head_ * C;
+      for (unsigned int c = 0; c < C; c++)
+        u_new[c] = x[c];
+
+      if (deno != 0)
+      {
+        y_head_ = (y_head_ == 0) ? deno - 1 : y_head_ - 1;
+        double* y_new = y + y_head_ * C;
+        for (unsigned int c = 0; c < C; c++)
+          y_new[c] = y_k[c];
+      }
+
+      // numerator
+      for (unsigned int c = 0; c < C; c++)
+        y_k[c] = 0.0;
+      for (unsigned int i = 0; i < nu; i++)
+      {
+        const double* b_i = b + i * C;
+        const double* u_i = u + ((u_head_ + i) % nu) * C;
+        for (unsigned int c = 0; c < C; c++)
+          y_k[c] += b_i[c] * u_i[c];
+      }
+
+      // denominator
+      if (deno != 0)
+      {
+        for (unsigned int c = 0; c < C; c++)
+          acc[c] = 0.0;
+        for (unsigned int i = 0; i < deno; i++)
+        {
+          const double* a_i = a + i * C;
+          const double* y_i = y + ((y_head_ + i) % deno) * C;
+          for (unsigned int c = 0; c < C; c++)
+            acc[c] += a_i[c] * y_i[c];
+        }
+        for (unsigned int c = 0; c < C; c++)
+          y_k[c] -= acc[c];
+      }
+    }
+
+    if (out != y_k)
+    {
+      for (unsigned int c = 0; c < C; c++)
+        out[c] = y_k[c];
+    }
+  }
+
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  {
+    if (static_cast<unsigned int>(input.size()) != num_channels_)
+    {
+      throw std::invalid_argument("[TF_SISO_Bank::apply] Invalid input size");
+    }
+    apply(input.get_data_ptr(), y_k_.get_data_ptr());
+    return y_k_;
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  inline virtual void reset() override
+  {
+    if (u_.size() != 0)
+      u_ = TooN::Zeros;
+    if (y_.size() != 0)
+      y_ = TooN::Zeros;
+    if (z_.size() != 0)
+      z_ = TooN::Zeros;
+    y_k_ = TooN::Zeros;
+    u_head_ = 0;
+    y_head_ = 0;
+  }
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return num_channels_;
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return num_channels_;
+  }
+
+  //! Get the realization of the channels
+  virtual TF_Realization getRealization() const
+  {
+    return realization_;
+  }
+
+  //! Get the last output
+  virtual const TooN::Vector<>& getLastOutput() const
+  {
+    return y_k_;
+  }
+
+  virtual void display() const override
+  {
+    std::cout << "TF_SISO_Bank: " << num_channels_ << " channels, "
+              << ((realization_ == TF_Realization::TRANSPOSED_DIRECT_FORM_II) ? "TDF-II" : "DF-I")
+              << ", coefficients " << num_size_ << "+" << den_size_ << std::endl
+              << "   y_k= " << y_k_ << std::endl;
+    getInstrumentation().display();
+  }
+
+  /*==============================================*/
+
+private:
+  //! INTERNAL true if the channels are bankable in TDF-II
+  static bool isTDF2(const std::vector<const TF_SISO*>& channels)
+  {
+    if (!canBank(channels))
+    {
+      throw std::invalid_argument("[TF_SISO_Bank] The channels must be bankable with the same realization and orders");
+    }
+    return channels[0]->getRealization() == TF_Realization::TRANSPOSED_DIRECT_FORM_II;
+  }
+};
+
+using TF_SISO_Bank_Ptr = std::unique_ptr<TF_SISO_Bank>;
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,294 @@
+/*
+    TF_SISO_Static Class Discrete Time Transfer Function SISO with orders fixed at compile time
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TF_SISO_STATIC_H
+#define TF_SISO_STATIC_H
+
+/*! \file TF_SISO_Static.h
+    \brief This class represents a Discrete Time Transfer Function System with orders fixed at compile time.
+*/
+
+#include "sun_systems_lib/TF/TF_SISO.h"
+#include "sun_systems_lib/Utils/Unrolled_Kernels.h"
+
+namespace sun
+{
+//!  TF_SISO_Static class: represents a Discrete Time Transfer Function System with orders fixed at compile time.
+/*!
+    This class is the same system of TF_SISO, but the numerator order N and the denominator order M are
+    template parameters:
+
+    \verbatim
+
+            b0 + b1*z^-1 + b2*z^-2 + ... + bN*z^-N
+    Y(z) = ---------------------------------------- U(z)
+            a0 + a1*z^-1 + a2*z^-2 + ... + aM*z^-M
+
+    \endverbatim
+
+    Coefficients and state are stored in fixed size TooN vectors (no heap), the dot products and the
+    shift of the state are unrolled at compile time.
+
+    Use step() to run the filter without virtual dispatch, apply() is the SISO_System_Interface entry point.
+
+    The output is bit-identical to the one of a TF_SISO with the same coefficients.
+
+    For a FIR system (M = 0) a single zero denominator coefficient is stored to avoid zero-size vectors.
+
+    \sa TF_SISO, TF_FIRST_ORDER_FILTER_Static, TF_INTEGRATOR_Static
+*/
+template <int N, int M>
+class TF_SISO_Static : public SISO_System_Interface
+{
+  static_assert(N >= 0 && M >= 0, "[TF_SISO_Static] Orders must be non negative");
+
+public:
+  //! Size of the numerator coefficients vector
+  enum
+  {
+    NUM_SIZE = N + 1
+  };
+  //! Size of the denominator coefficients vector (1 also for M = 0)
+  enum
+  {
+    DEN_SIZE = (M > 0) ? M : 1
+  };
+
+private:
+protected:
+  //! sampling time, this is just a here to be stored, not used
+  double ts_;
+
+  //! Numerator coefficients, size N+1
+  TooN::Vector<NUM_SIZE> b_vec_;
+  //! Reduced Denominator coefficients, without a0, size M
+  TooN::Vector<DEN_SIZE> a_vec_;
+
+  //! State vector, last inputs [u(k) ... u(k-N)]
+  TooN::Vector<NUM_SIZE> u_vec_;
+  //! State vector, last outputs [y(k-1) ... y(k-M)]
+  TooN::Vector<DEN_SIZE> y_vec_;
+  //! Very last output
+  double y_k_;
+
+  //! 1D vector, very last output, used by the apply(Vector) overload
+  TooN::Vector<> y_k_vec_ = TooN::Zeros(1);
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Contructor
+  /*!
+    Construct the discrete time transfer function.
+
+    The coefficients are simplified as in TF_SISO, the simplified orders must not exceed N and M.
+
+    \param num_coeff numerator coefficients [b0, ...., bN]
+    \param den_coeff denominator coefficients [a0, ...., aM]
+    \param Ts Sampling time, it is just internally stored, default = NaN
+  */
+  TF_SISO_Static(const TooN::Vector<>& num_coeff, const TooN::Vector<>& den_coeff, double Ts = NAN)
+    : ts_(Ts), b_vec_(TooN::Zeros), a_vec_(TooN::Zeros), u_vec_(TooN::Zeros), y_vec_(TooN::Zeros), y_k_(0.0)
+  {
+    TooN::Vector<> b_vec = TF_SISO::simplifyNumerator(num_coeff, den_coeff);
+    TooN::Vector<> a_vec = TF_SISO::simplifyAndReduceDenominator(den_coeff);
+
+    if (b_vec.size() > NUM_SIZE)
+    {
+      throw std::invalid_argument("[TF_SISO_Static] The numerator order is greater than N");
+    }
+    if (a_vec.size() > M)
+    {
+      throw std::invalid_argument("[TF_SISO_Static] The denominator order is greater than M");
+    }
+
+    for (int i = 0; i < b_vec.size(); i++)
+    {
+      b_vec_[i] = b_vec[i];
+    }
+    for (int i = 0; i < a_vec.size(); i++)
+    {
+      a_vec_[i] = a_vec[i];
+    }
+  }
+
+  //! Zero Contructor
+  /*!
+    Construct a ZERO discrete time transfer function
+
+    \param Ts Sampling time, it is just internally stored, default = NaN
+  */
+  TF_SISO_Static(double Ts = NAN) : TF_SISO_Static(TooN::makeVector(0.0), TooN::makeVector(1.0), Ts)
+  {
+  }
+
+  //! Copy Constructor
+  TF_SISO_Static(const TF_SISO_Static& tf) = default;
+
+  virtual ~TF_SISO_Static() override = default;
+
+  //! Clone the object
+  virtual TF_SISO_Static* clone() const override
+  {
+    return new TF_SISO_Static(*this);
+  }
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  //! Get the numerator order N
+  inline virtual const unsigned int getNumeratorOrder() const
+  {
+    return N;
+  }
+
+  //! Get the denominator order M
+  inline virtual const unsigned int getDenominatorOrder() const
+  {
+    return M;
+  }
+
+  //! Get the sampling time
+  inline virtual double getTs() const
+  {
+    return ts_;
+  }
+
+  /*==============================================*/
+
+  /*=============SETTER===========================*/
+
+  //! Set the sampling time
+  inline virtual void setTs(double Ts)
+  {
+    ts_ = Ts;
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Apply the system without virtual dispatch
+  /*!
+    Same as apply(double), but not virtual, the whole step is inlined.
+    \param u_k Input at the current step u(k)
+    \return system output y(k)
+  */
+  inline double step(double u_k)
+  {
+    Unrolled_Kernels<NUM_SIZE>::shift(u_vec_.get_data_ptr());
+    u_vec_[0] = u_k;
+
+    if (M == 0)
+    {
+      y_k_ = Unrolled_Kernels<NUM_SIZE>::dot(b_vec_.get_data_ptr(), u_vec_.get_data_ptr());
+      return y_k_;
+    }
+
+    Unrolled_Kernels<DEN_SIZE>::shift(y_vec_.get_data_ptr());
+    y_vec_[0] = y_k_;
+
+    y_k_ = Unrolled_Kernels<NUM_SIZE>::dot(b_vec_.get_data_ptr(), u_vec_.get_data_ptr()) -
+           Unrolled_Kernels<M>::dot(a_vec_.get_data_ptr(), y_vec_.get_data_ptr());
+
+    return y_k_;
+  }
+
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  {
+    if (input.size() != 1)
+    {
+      throw std::domain_error("[TF_SISO_Static::apply(Vector)] The input has to be scalar");
+    }
+    y_k_vec_[0] = apply(input[0]);
+    return y_k_vec_;
+  }
+
+  inline virtual double apply(double u_k) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    return step(u_k);
+  }
+
+  virtual void apply_block(const double* in, double* out, std::size_t n) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    for (std::size_t i = 0; i < n; i++)
+    {
+      out[i] = step(in[i]);
+    }
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+  inline virtual void reset() override
+  {
+    u_vec_ = TooN::Zeros;
+    y_vec_ = TooN::Zeros;
+    y_k_ = 0.0;
+    y_k_vec_ = TooN::Zeros;
+  }
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return 1;
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return 1;
+  }
+
+  //! Get the last output
+  virtual double getLastOutput() const
+  {
+    return y_k_;
+  }
+
+  virtual void display() const override
+  {
+    display_tf();
+    getInstrumentation().display();
+  }
+
+  //! Display the transfer function on the std out
+  virtual void display_tf() const
+  {
+    std::cout << "TF_SISO_Static<" << N << "," << M << ">:" << std::endl
+              << "   Num_Coeff= " << b_vec_ << std::endl
+              << "   Den_Coeff= 1.0 " << a_vec_ << std::endl
+              << "   State" << std::endl
+              << "   u_vec= " << u_vec_ << std::endl
+              << "   y_vec= " << y_vec_ << std::endl
+              << "   y_k= " << y_k_ << std::endl;
+  }
+
+  /*==============================================*/
+};
+
+template <int N, int M>
+using TF_SISO_Static_Ptr = std::unique_ptr<TF_SISO_Static<N, M>>;
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,586 @@
+/*
+    TF_SOS Class Discrete Time Transfer Function SISO as a cascade of Second Order Sections
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TF_SOS_H
+#define TF_SOS_H
+
+/*! \file TF_SOS.h
+    \brief This class represents a Discrete Time Transfer Function System as a cascade of Second Order Sections.
+*/
+
+#include "sun_systems_lib/TF/TF_SISO.h"
+#include "sun_systems_lib/Utils/Polynomial.h"
+#include <algorithm>
+
+namespace sun
+{
+//!  TF_SOS class: represents a Discrete Time Transfer Function System as a cascade of Second Order Sections.
+/*!
+    The transfer function is the product of L biquads:
+
+    \verbatim
+
+            L-1   b0_i + b1_i*z^-1 + b2_i*z^-2
+    Y(z) =  PROD  --------------------------- U(z)
+            i=0    1  + a1_i*z^-1 + a2_i*z^-2
+
+    \endverbatim
+
+    Each section is a Transposed Direct Form II with two state variables:
+
+    \verbatim
+    y    = b0*x + s1
+    s1   = b1*x - a1*y + s2
+    s2   = b2*x - a2*y
+    \endverbatim
+
+    Coefficients [b0 b1 b2 a1 a2] and states [s1 s2] of all the sections are stored contiguously, so the cascade
+    is a short loop on a small array. For high order systems this is much more accurate than the direct form of
+    TF_SISO.
+
+    The SOS matrix has one row per section in the form [b0 b1 b2 a0 a1 a2] (each row is normalized by its a0).
+
+    A TF_SISO can be converted with the TF_SOS(const TF_SISO&) constructor: the roots of numerator and denominator
+    are paired in sections, each pair of poles with the closest zeros. The sections are ordered so that the poles
+    closest to the unit circle are in the last sections; the gain is in the first section.
+
+    The conversion from the polynomial coefficients cannot be more accurate than the coefficients themselves, for
+    high order filters with clustered poles build the sections from zeros and poles with zpk2sos().
+
+    TF_SOS is a SISO_System_Interface, so it can be used as element of TF_MIMO and TF_MIMO_DIAGONAL.
+
+    \sa TF_SISO, TF_MIMO, Polynomial
+*/
+class TF_SOS : public SISO_System_Interface
+{
+public:
+  // STATIC
+
+  //! INTERNAL normalize the SOS matrix
+  /*!
+    Transforms the matrix L x 6 [b0 b1 b2 a0 a1 a2] in the vector [b0 b1 b2 a1 a2]/a0 of size 5*L
+  */
+  inline static TooN::Vector<> normalizeSOS(const TooN::Matrix<>& sos)
+  {
+    if (sos.num_cols() != 6)
+    {
+      throw std::invalid_argument("[TF_SOS::normalizeSOS] The SOS matrix has to be L x 6");
+    }
+    if (sos.num_rows() == 0)
+    {
+      throw std::invalid_argument("[TF_SOS::normalizeSOS] The SOS matrix has no sections");
+    }
+
+    TooN::Vector<> coeff(5 * sos.num_rows());
+    for (int i = 0; i < sos.num_rows(); i++)
+    {
+      const double a0 = sos(i, 3);
+      if (a0 == 0.0)
+      {
+        throw std::domain_error("[TF_SOS::normalizeSOS] Division by 0");
+      }
+      coeff[5 * i + 0] = sos(i, 0) / a0;
+      coeff[5 * i + 1] = sos(i, 1) / a0;
+      coeff[5 * i + 2] = sos(i, 2) / a0;
+      coeff[5 * i + 3] = sos(i, 4) / a0;
+      coeff[5 * i + 4] = sos(i, 5) / a0;
+    }
+    return coeff;
+  }
+
+  //! Convert a transfer function in a SOS matrix
+  /*!
+    The roots of numerator and denominator are computed with Polynomial::roots() and the result is zpk2sos().
+    \param num_coeff numerator coefficients [b0, ...., bn]
+    \param den_coeff denominator coefficients [a0, ...., am]
+    \return the SOS matrix L x 6, one row [b0 b1 b2 a0 a1 a2] per section
+  */
+  inline static TooN::Matrix<> tf2sos(const TooN::Vector<>& num_coeff, const TooN::Vector<>& den_coeff)
+  {
+    const TooN::Vector<> b_vec = TF_SISO::simplifyNumerator(num_coeff, den_coeff);
+    const TooN::Vector<> a_vec_reduced = TF_SISO::simplifyAndReduceDenominator(den_coeff);
+    TooN::Vector<> a_vec(a_vec_reduced.size() + 1);
+    a_vec[0] = 1.0;
+    for (int i = 0; i < a_vec_reduced.size(); i++)
+    {
+      a_vec[i + 1] = a_vec_reduced[i];
+    }
+
+    if (Polynomial::degree(b_vec) < 0)
+    {
+      return zpk2sos(std::vector<std::complex<double>>(), std::vector<std::complex<double>>(), 0.0);
+    }
+
+    // b(z^-1) = b_d * z^-d * PROD(1 - z^-1/r_i), with r_i the nonzero roots in z^-1
+    // the zero in the z plane is 1/r_i, the roots in z^-1 = 0 are pure delays
+    unsigned int num_delays = 0;
+    while (b_vec[num_delays] == 0.0)
+    {
+      num_delays++;
+    }
+    std::vector<std::complex<double>> zeros, poles;
+    for (const auto& r : Polynomial::roots(b_vec.slice(num_delays, b_vec.size() - num_delays)))
+    {
+      zeros.push_back(1.0 / r);
+    }
+    for (const auto& r : Polynomial::roots(a_vec))
+    {
+      poles.push_back(1.0 / r);
+    }
+
+    return buildSOS(zeros, poles, num_delays, b_vec[num_delays]);
+  }
+
+  //! Convert zeros, poles and gain in a SOS matrix
+  /*!
+    The transfer function is
+
+    \verbatim
+                 (z - z_0)(z - z_1)...(z - z_nz-1)
+    H(z) = gain* ---------------------------------
+                 (z - p_0)(z - p_1)...(z - p_np-1)
+    \endverbatim
+
+    Each pair of poles is paired with the closest zeros, the sections are ordered so that the poles closest to the
+    unit circle are in the last sections. The gain is in the first section.
+
+    Building the sections from zeros and poles avoids the loss of accuracy of the expanded polynomials, this is the
+    preferred way for high order filters.
+
+    \param zeros zeros in the z plane, the complex zeros must be in conjugate pairs
+    \param poles poles in the z plane, the complex poles must be in conjugate pairs
+    \param gain the gain
+    \return the SOS matrix L x 6, one row [b0 b1 b2 a0 a1 a2] per section
+  */
+  inline static TooN::Matrix<> zpk2sos(const std::vector<std::complex<double>>& zeros,
+                                       const std::vector<std::complex<double>>& poles, double gain)
+  {
+    if (zeros.size() > poles.size())
+    {
+      throw std::invalid_argument("[TF_SOS::zpk2sos] More zeros than poles. Non Causal System");
+    }
+    // z^-np * PROD(z - z_i) / z^-np * PROD(z - p_i) = z^-(np-nz) * PROD(1 - z_i*z^-1) / PROD(1 - p_i*z^-1)
+    return buildSOS(zeros, poles, poles.size() - zeros.size(), gain);
+  }
+
+private:
+  //! INTERNAL a real factor of order <= 2 of a polynomial in z^-1
+  struct Section_Factor
+  {
+    //! coefficients [c0 c1 c2] in z^-1
+    double c[3] = { 1.0, 0.0, 0.0 };
+    //! a representative root in the z plane (used to pair the sections)
+    std::complex<double> z_root = 0.0;
+  };
+
+  //! INTERNAL build the SOS matrix of gain * z^-num_delays * PROD(1 - z_i*z^-1) / PROD(1 - p_i*z^-1)
+  inline static TooN::Matrix<> buildSOS(const std::vector<std::complex<double>>& zeros,
+                                        const std::vector<std::complex<double>>& poles, unsigned int num_delays,
+                                        double gain)
+  {
+    std::vector<Section_Factor> num_factors = groupFactors(zeros, num_delays);
+    std::vector<Section_Factor> den_factors = groupFactors(poles, 0);
+
+    // Pair each denominator with the closest numerator, starting from the poles closest to the unit circle
+    std::stable_sort(den_factors.begin(), den_factors.end(), [](const Section_Factor& a, const Section_Factor& b) {
+      return std::fabs(1.0 - std::abs(a.z_root)) < std::fabs(1.0 - std::abs(b.z_root));
+    });
+
+    std::vector<Section_Factor> num_sections, den_sections;
+    for (const auto& den : den_factors)
+    {
+      den_sections.push_back(den);
+      if (num_factors.empty())
+      {
+        num_sections.push_back(Section_Factor());
+        continue;
+      }
+      unsigned int best = 0;
+      for (unsigned int i = 1; i < num_factors.size(); i++)
+      {
+        if (std::abs(num_factors[i].z_root - den.z_root) < std::abs(num_factors[best].z_root - den.z_root))
+        {
+          best = i;
+        }
+      }
+      num_sections.push_back(num_factors[best]);
+      num_factors.erase(num_factors.begin() + best);
+    }
+    for (const auto& num : num_factors)
+    {
+      num_sections.push_back(num);
+      den_sections.push_back(Section_Factor());
+    }
+    if (num_sections.empty())
+    {
+      num_sections.push_back(Section_Factor());
+      den_sections.push_back(Section_Factor());
+    }
+
+    // The first section has the poles farthest from the unit circle
+    const unsigned int num_sections_size = num_sections.size();
+    TooN::Matrix<> sos(num_sections_size, 6);
+    for (unsigned int i = 0; i < num_sections_size; i++)
+    {
+      const Section_Factor& num = num_sections[num_sections_size - 1 - i];
+      const Section_Factor& den = den_sections[num_sections_size - 1 - i];
+      sos(i, 0) = num.c[0];
+      sos(i, 1) = num.c[1];
+      sos(i, 2) = num.c[2];
+      sos(i, 3) = den.c[0];
+      sos(i, 4) = den.c[1];
+      sos(i, 5) = den.c[2];
+    }
+    sos(0, 0) *= gain;
+    sos(0, 1) *= gain;
+    sos(0, 2) *= gain;
+
+    return sos;
+  }
+
+  //! INTERNAL group the factors (1 - z_i*z^-1) and z^-1 (delays) in real factors of order <= 2
+  /*!
+    The complex conjugate pairs give a second order factor. The delays are grouped together, then the real roots are
+    paired by magnitude.
+  */
+  inline static std::vector<Section_Factor> groupFactors(const std::vector<std::complex<double>>& z_roots,
+                                                         unsigned int num_delays)
+  {
+    std::vector<Section_Factor> factors;
+
+    // linear factors [c0 c1]: the delays first, then the real roots
+    std::vector<double> real_roots;
+    std::vector<std::complex<double>> complex_roots;
+    for (const auto& r : z_roots)
+    {
+      if (std::fabs(r.imag()) <= 1E-10 * std::abs(r))
+      {
+        real_roots.push_back(r.real());
+      }
+      else if (r.imag() > 0.0)
+      {
+        complex_roots.push_back(r);
+      }
+    }
+    if (2 * complex_roots.size() + real_roots.size() != z_roots.size())
+    {
+      throw std::invalid_argument("[TF_SOS::groupFactors] The complex roots must be in conjugate pairs");
+    }
+
+    for (const auto& r : complex_roots)
+    {
+      // (1 - r*z^-1)(1 - conj(r)*z^-1) = 1 - 2*Re(r) z^-1 + |r|^2 z^-2
+      Section_Factor f;
+      f.z_root = r;
+      f.c[1] = -2.0 * r.real();
+      f.c[2] = std::norm(r);
+      factors.push_back(f);
+    }
+
+    std::sort(real_roots.begin(), real_roots.end(),
+              [](double a, double b) { return std::fabs(a) < std::fabs(b); });
+    std::vector<TooN::Vector<2>> linear;
+    for (unsigned int i = 0; i < num_delays; i++)
+    {
+      linear.push_back(TooN::makeVector(0.0, 1.0));
+    }
+    for (const auto& r : real_roots)
+    {
+      linear.push_back(TooN::makeVector(1.0, -r));
+    }
+    for (unsigned int i = 0; i < linear.size(); i += 2)
+    {
+      Section_Factor f;
+      if (i + 1 < linear.size())
+      {
+        f.c[0] = linear[i][0] * linear[i + 1][0];
+        f.c[1] = linear[i][0] * linear[i + 1][1] + linear[i][1] * linear[i + 1][0];
+        f.c[2] = linear[i][1] * linear[i + 1][1];
+      }
+      else
+      {
+        f.c[0] = linear[i][0];
+        f.c[1] = linear[i][1];
+      }
+      // representative root: the last one (the farthest from the origin), 0 for the delays
+      const TooN::Vector<2>& last = linear[std::min<unsigned int>(i + 1, linear.size() - 1)];
+      f.z_root = (last[0] == 0.0) ? 0.0 : -last[1];
+      factors.push_back(f);
+    }
+
+    return factors;
+  }
+
+  //! INTERNAL in place product of the polynomial p (degree deg) with c0 + c1*z^-1 + c2*z^-2
+  inline static void multiplySection(TooN::Vector<>& p, unsigned int deg, double c0, double c1, double c2)
+  {
+    for (int j = deg + 2; j >= 0; j--)
+    {
+      double v = c0 * p[j];
+      if (j >= 1)
+        v += c1 * p[j - 1];
+      if (j >= 2)
+        v += c2 * p[j - 2];
+      p[j] = v;
+    }
+  }
+
+protected:
+  //! sampling time, this is just a here to be stored, not used
+  double ts_;
+
+  //! Number of sections L
+  unsigned int num_sections_;
+
+  //! Coefficients [b0 b1 b2 a1 a2] of each section, size 5*L
+  TooN::Vector<> coeff_;
+
+  //! States [s1 s2] of each section, size 2*L
+  TooN::Vector<> state_;
+
+  //! 1D vector, very last output, size 1
+  TooN::Vector<> y_k_ = TooN::Zeros(1);
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Contructor
+  /*!
+    Construct the system from the SOS matrix
+
+    \param sos L x 6 matrix, each row is a section [b0 b1 b2 a0 a1 a2]
+    \param Ts Sampling time, it is just internally stored, default = NaN
+  */
+  TF_SOS(const TooN::Matrix<>& sos, double Ts = NAN)
+    : ts_(Ts), num_sections_(sos.num_rows()), coeff_(normalizeSOS(sos)), state_(TooN::Zeros(2 * sos.num_rows()))
+  {
+  }
+
+  //! Contructor
+  /*!
+    Construct the system from the transfer function coefficients (see TF_SISO), the transfer function is factorized
+    in second order sections.
+
+    \param num_coeff numerator coefficients [b0, ...., bn]
+    \param den_coeff denominator coefficients [a0, ...., am]
+    \param Ts Sampling time, it is just internally stored, default = NaN
+  */
+  TF_SOS(const TooN::Vector<>& num_coeff, const TooN::Vector<>& den_coeff, double Ts = NAN)
+    : TF_SOS(tf2sos(num_coeff, den_coeff), Ts)
+  {
+  }
+
+  //! Conversion Contructor
+  /*!
+    Construct the system as the factorization in second order sections of tf (the state of tf is not copied).
+
+    \param tf the transfer function
+  */
+  explicit TF_SOS(const TF_SISO& tf)
+    : TF_SOS(tf.getInputGain() * tf.getNumeratorCoeff(), tf.getDenominatorCoeff(), tf.getTs())
+  {
+  }
+
+  //! Copy Constructor
+  TF_SOS(const TF_SOS& tf) = default;
+
+  virtual ~TF_SOS() override = default;
+
+  //! Clone the object
+  virtual TF_SOS* clone() const override
+  {
+    return new TF_SOS(*this);
+  }
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  //! Get the number of sections L
+  inline virtual const unsigned int getNumSections() const
+  {
+    return num_sections_;
+  }
+
+  //! Get the SOS matrix L x 6, each row is a section [b0 b1 b2 1.0 a1 a2]
+  virtual TooN::Matrix<> getSOS() const
+  {
+    TooN::Matrix<> sos(num_sections_, 6);
+    for (unsigned int i = 0; i < num_sections_; i++)
+    {
+      sos(i, 0) = coeff_[5 * i + 0];
+      sos(i, 1) = coeff_[5 * i + 1];
+      sos(i, 2) = coeff_[5 * i + 2];
+      sos(i, 3) = 1.0;
+      sos(i, 4) = coeff_[5 * i + 3];
+      sos(i, 5) = coeff_[5 * i + 4];
+    }
+    return sos;
+  }
+
+  //! Get the numerator coefficients of the whole transfer function [b0, ...., b2L]
+  virtual TooN::Vector<> getNumeratorCoeff() const
+  {
+    TooN::Vector<> num = TooN::Zeros(2 * num_sections_ + 1);
+    num[0] = 1.0;
+    for (unsigned int i = 0; i < num_sections_; i++)
+    {
+      multiplySection(num, 2 * i, coeff_[5 * i + 0], coeff_[5 * i + 1], coeff_[5 * i + 2]);
+    }
+    return num;
+  }
+
+  //! Get the denominator coefficients of the whole transfer function [1.0, a1, ...., a2L]
+  virtual TooN::Vector<> getDenominatorCoeff() const
+  {
+    TooN::Vector<> den = TooN::Zeros(2 * num_sections_ + 1);
+    den[0] = 1.0;
+    for (unsigned int i = 0; i < num_sections_; i++)
+    {
+      multiplySection(den, 2 * i, 1.0, coeff_[5 * i + 3], coeff_[5 * i + 4]);
+    }
+    return den;
+  }
+
+  //! Get the sampling time
+  inline virtual double getTs() const
+  {
+    return ts_;
+  }
+
+  /*==============================================*/
+
+  /*=============SETTER===========================*/
+
+  //! Set the sampling time
+  inline virtual void setTs(double Ts)
+  {
+    ts_ = Ts;
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  inline virtual const TooN::Vector<>& apply(const TooN::Vector<>& input) override
+  {
+    if (input.size() != 1)
+    {
+      throw std::domain_error("[TF_SOS::apply(Vector)] The input has to be scalar");
+    }
+    apply(input[0]);
+    return y_k_;
+  }
+
+  inline virtual double apply(double u_k) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(APPLY);
+    const double* c = coeff_.get_data_ptr();
+    double* s = state_.get_data_ptr();
+    double x = u_k;
+    for (unsigned int i = 0; i < num_sections_; i++, c += 5, s += 2)
+    {
+      const double y = c[0] * x + s[0];
+      s[0] = c[1] * x - c[3] * y + s[1];
+      s[1] = c[2] * x - c[4] * y;
+      x = y;
+    }
+    y_k_[0] = x;
+    return x;
+  }
+
+  virtual void apply_block(const double* in, double* out, std::size_t n) override
+  {
+    SUN_SYSTEMS_LIB_INSTRUMENT(SIMULATE);
+    const double* coeff = coeff_.get_data_ptr();
+    double* state = state_.get_data_ptr();
+    for (std::size_t k = 0; k < n; k++)
+    {
+      const double* c = coeff;
+      double* s = state;
+      double x = in[k];
+      for (unsigned int i = 0; i < num_sections_; i++, c += 5, s += 2)
+      {
+        const double y = c[0] * x + s[0];
+        s[0] = c[1] * x - c[3] * y + s[1];
+        s[1] = c[2] * x - c[4] * y;
+        x = y;
+      }
+      out[k] = x;
+    }
+    if (n > 0)
+    {
+      y_k_[0] = out[n - 1];
+    }
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+  inline virtual void reset() override
+  {
+    state_ = TooN::Zeros;
+    y_k_ = TooN::Zeros;
+  }
+
+  virtual const unsigned int getSizeInput() const override
+  {
+    return 1;
+  }
+
+  virtual const unsigned int getSizeOutput() const override
+  {
+    return 1;
+  }
+
+  //! Get the last output
+  virtual double getLastOutput() const
+  {
+    return y_k_[0];
+  }
+
+  virtual void display() const override
+  {
+    display_tf();
+    getInstrumentation().display();
+  }
+
+  //! Display the transfer function on the std out
+  virtual void display_tf() const
+  {
+    std::cout << "TF_SOS: " << num_sections_ << " sections" << std::endl
+              << "   SOS [b0 b1 b2 a0 a1 a2]=" << std::endl
+              << getSOS() << "   State [s1 s2]=" << std::endl;
+    for (unsigned int i = 0; i < num_sections_; i++)
+    {
+      std::cout << "   " << state_.slice(2 * i, 2) << std::endl;
+    }
+    std::cout << "   y_k= " << y_k_ << std::endl;
+  }
+
+  /*==============================================*/
+};
+
+using TF_SOS_Ptr = std::unique_ptr<TF_SOS>;
+
+}  // namespace sun
+
+#endif
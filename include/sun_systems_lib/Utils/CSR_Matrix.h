@@ -0,0 +1,270 @@
+/*
+    CSR_Matrix Class, compressed sparse row matrix and its matrix-vector kernels
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CSR_MATRIX_H
+#define CSR_MATRIX_H
+
+/*! \file CSR_Matrix.h
+    \brief Compressed sparse row matrix
+*/
+
+#include <TooN/TooN.h>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace sun
+{
+//!  CSR_Matrix class: a real matrix in compressed sparse row format.
+/*!
+    The non zero elements of the row i are values[row_ptr[i] ... row_ptr[i+1]-1], in the columns col_idx[...]
+    (increasing order).
+
+    The matrix-vector products cost O(nnz + rows) and do not allocate, the results are written in caller provided
+    storage. The matrix is immutable after the construction.
+
+    \sa SS_LINEAR_SPARSE
+*/
+class CSR_Matrix
+{
+private:
+  CSR_Matrix();
+
+protected:
+  //! Number of rows
+  int rows_;
+
+  //! Number of columns
+  int cols_;
+
+  //! Index of the first element of each row, size rows+1
+  std::vector<int> row_ptr_;
+
+  //! Column of each element, size nnz
+  std::vector<int> col_idx_;
+
+  //! Value of each element, size nnz
+  std::vector<double> values_;
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Zero matrix rows x cols
+  CSR_Matrix(int rows, int cols) : rows_(rows), cols_(cols), row_ptr_(rows + 1, 0)
+  {
+    if (rows < 0 || cols < 0)
+    {
+      throw std::invalid_argument("[CSR_Matrix] Invalid dimensions");
+    }
+  }
+
+  //! Build the sparse matrix from a dense one
+  /*!
+    \param M dense matrix
+    \param drop_tol the elements with |M(i,j)| <= drop_tol are dropped (default 0.0 = only the exact zeros)
+  */
+  CSR_Matrix(const TooN::Matrix<>& M, double drop_tol = 0.0)
+    : rows_(M.num_rows()), cols_(M.num_cols()), row_ptr_(M.num_rows() + 1, 0)
+  {
+    if (drop_tol < 0.0)
+    {
+      throw std::invalid_argument("[CSR_Matrix] The drop tolerance has to be non negative");
+    }
+    for (int i = 0; i < rows_; i++)
+    {
+      for (int j = 0; j < cols_; j++)
+      {
+        if (std::fabs(M(i, j)) > drop_tol)
+        {
+          col_idx_.push_back(j);
+          values_.push_back(M(i, j));
+        }
+      }
+      row_ptr_[i + 1] = values_.size();
+    }
+  }
+
+  //! Copy Constructor
+  CSR_Matrix(const CSR_Matrix& M) = default;
+
+  //! Destructor
+  virtual ~CSR_Matrix() = default;
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  inline int num_rows() const
+  {
+    return rows_;
+  }
+
+  inline int num_cols() const
+  {
+    return cols_;
+  }
+
+  //! Number of stored (non zero) elements
+  inline int nnz() const
+  {
+    return values_.size();
+  }
+
+  //! nnz / (rows*cols)
+  inline double density() const
+  {
+    return (rows_ * cols_ == 0) ? 0.0 : (double)nnz() / ((double)rows_ * (double)cols_);
+  }
+
+  inline const std::vector<int>& getRowPtr() const
+  {
+    return row_ptr_;
+  }
+
+  inline const std::vector<int>& getColIdx() const
+  {
+    return col_idx_;
+  }
+
+  inline const std::vector<double>& getValues() const
+  {
+    return values_;
+  }
+
+  //! Element (i,j), 0 if not stored
+  double operator()(int i, int j) const
+  {
+    for (int e = row_ptr_[i]; e < row_ptr_[i + 1]; e++)
+    {
+      if (col_idx_[e] == j)
+      {
+        return values_[e];
+      }
+    }
+    return 0.0;
+  }
+
+  //! Dense copy of the matrix
+  TooN::Matrix<> toDense() const
+  {
+    TooN::Matrix<> M(rows_, cols_);
+    toDense_into(M);
+    return M;
+  }
+
+  //! Dense copy of the matrix in caller provided storage (rows x cols)
+  void toDense_into(TooN::Matrix<>& M) const
+  {
+    for (int i = 0; i < rows_; i++)
+    {
+      for (int j = 0; j < cols_; j++)
+      {
+        M(i, j) = 0.0;
+      }
+      for (int e = row_ptr_[i]; e < row_ptr_[i + 1]; e++)
+      {
+        M(i, col_idx_[e]) = values_[e];
+      }
+    }
+  }
+
+  /*==============================================*/
+
+  /*=============KERNELS==========================*/
+
+  //! y = M*x (raw data, y must not overlap x)
+  inline void multiply(const double* x, double* y) const
+  {
+    const int* row_ptr = row_ptr_.data();
+    const int* col_idx = col_idx_.data();
+    const double* values = values_.data();
+    for (int i = 0; i < rows_; i++)
+    {
+      double acc = 0.0;
+      for (int e = row_ptr[i]; e < row_ptr[i + 1]; e++)
+      {
+        acc += values[e] * x[col_idx[e]];
+      }
+      y[i] = acc;
+    }
+  }
+
+  //! y += M*x (raw data, y must not overlap x)
+  inline void multiplyAdd(const double* x, double* y) const
+  {
+    const int* row_ptr = row_ptr_.data();
+    const int* col_idx = col_idx_.data();
+    const double* values = values_.data();
+    for (int i = 0; i < rows_; i++)
+    {
+      double acc = 0.0;
+      for (int e = row_ptr[i]; e < row_ptr[i + 1]; e++)
+      {
+        acc += values[e] * x[col_idx[e]];
+      }
+      y[i] += acc;
+    }
+  }
+
+  //! y = M*x
+  inline void multiply(const TooN::Vector<>& x, TooN::Vector<>& y) const
+  {
+    multiply(x.get_data_ptr(), y.get_data_ptr());
+  }
+
+  //! y += M*x
+  inline void multiplyAdd(const TooN::Vector<>& x, TooN::Vector<>& y) const
+  {
+    multiplyAdd(x.get_data_ptr(), y.get_data_ptr());
+  }
+
+  //! M*x
+  TooN::Vector<> operator*(const TooN::Vector<>& x) const
+  {
+    TooN::Vector<> y(rows_);
+    multiply(x, y);
+    return y;
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  //! Display the matrix on the std out (sizes and non zero elements)
+  void display() const
+  {
+    std::cout << "CSR_Matrix " << rows_ << "x" << cols_ << ", nnz= " << nnz() << std::endl;
+    for (int i = 0; i < rows_; i++)
+    {
+      for (int e = row_ptr_[i]; e < row_ptr_[i + 1]; e++)
+      {
+        std::cout << "   (" << i << "," << col_idx_[e] << ") " << values_[e] << std::endl;
+      }
+    }
+  }
+
+  /*==============================================*/
+};
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,359 @@
+/*
+    Dense_Kernels, allocation free kernels on TooN vectors and matrices
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DENSE_KERNELS_H
+#define DENSE_KERNELS_H
+
+/*! \file Dense_Kernels.h
+    \brief Allocation free kernels on TooN vectors and matrices
+*/
+
+#include <TooN/TooN.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace sun
+{
+//!  Dense_Kernels class: static allocation free kernels on dynamic TooN vectors and matrices.
+/*!
+    The results are written in caller provided storage of the right size, no temporaries are created.
+    The output must not be one of the inputs.
+
+    \sa SS_Interface::state_fcn_into()
+*/
+class Dense_Kernels
+{
+private:
+  Dense_Kernels();
+
+public:
+  //! y = A*x
+  inline static void multiply(const TooN::Matrix<>& A, const TooN::Vector<>& x, TooN::Vector<>& y)
+  {
+    for (int i = 0; i < A.num_rows(); i++)
+    {
+      double acc = 0.0;
+      for (int j = 0; j < A.num_cols(); j++)
+      {
+        acc += A(i, j) * x[j];
+      }
+      y[i] = acc;
+    }
+  }
+
+  //! y += A*x
+  inline static void multiplyAdd(const TooN::Matrix<>& A, const TooN::Vector<>& x, TooN::Vector<>& y)
+  {
+    for (int i = 0; i < A.num_rows(); i++)
+    {
+      double acc = 0.0;
+      for (int j = 0; j < A.num_cols(); j++)
+      {
+        acc += A(i, j) * x[j];
+      }
+      y[i] += acc;
+    }
+  }
+
+  //! y += A^T*x
+  inline static void multiplyTransposeAdd(const TooN::Matrix<>& A, const TooN::Vector<>& x, TooN::Vector<>& y)
+  {
+    for (int j = 0; j < A.num_cols(); j++)
+    {
+      double acc = 0.0;
+      for (int i = 0; i < A.num_rows(); i++)
+      {
+        acc += A(i, j) * x[i];
+      }
+      y[j] += acc;
+    }
+  }
+
+  //! y = M*z on a row-major block of rows x cols with leading dimension ld (raw data)
+  /*!
+    Register blocked on 4 rows (each z[j] is loaded once for 4 independent accumulators) and cache blocked on
+    256 columns (the slice of z stays in L1 while the 4 rows stream).
+    The accumulation order of a row does not depend on the row blocking: computing a subset of the rows of M gives the
+    same values of the full product.
+    y must not overlap M or z.
+  */
+  inline static void multiplyBlocked(const double* M, int ld, int rows, int cols, const double* z, double* y)
+  {
+    const int block_cols = 256;
+    for (int j0 = 0; j0 < cols || j0 == 0; j0 += block_cols)
+    {
+      const int j1 = std::min(cols, j0 + block_cols);
+      int i = 0;
+      for (; i + 4 <= rows; i += 4)
+      {
+        const double* m0 = M + i * ld;
+        const double* m1 = m0 + ld;
+        const double* m2 = m1 + ld;
+        const double* m3 = m2 + ld;
+        double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+        for (int j = j0; j < j1; j++)
+        {
+          const double zj = z[j];
+          acc0 += m0[j] * zj;
+          acc1 += m1[j] * zj;
+          acc2 += m2[j] * zj;
+          acc3 += m3[j] * zj;
+        }
+        if (j0 == 0)
+        {
+          y[i] = acc0;
+          y[i + 1] = acc1;
+          y[i + 2] = acc2;
+          y[i + 3] = acc3;
+        }
+        else
+        {
+          y[i] += acc0;
+          y[i + 1] += acc1;
+          y[i + 2] += acc2;
+          y[i + 3] += acc3;
+        }
+      }
+      for (; i < rows; i++)
+      {
+        const double* mi = M + i * ld;
+        double acc = 0.0;
+        for (int j = j0; j < j1; j++)
+        {
+          acc += mi[j] * z[j];
+        }
+        y[i] = (j0 == 0) ? acc : y[i] + acc;
+      }
+    }
+  }
+
+  //! y_k = M*[z1_k; z2_k] on count operands given in two parts, the rows of Z1 and Z2 (raw data)
+  /*!
+    z1_k = Z1 + k*ldz1 (n1 elements), z2_k = Z2 + k*ldz2 (n2 elements), y_k = Y + k*ldy (rows elements), M is a
+    row-major block of rows x (n1 + n2) with leading dimension ld.
+    Same blocking and accumulation order of multiplyBlocked(): each y_k has the same values of multiplyBlocked() on the
+    packed [z1_k; z2_k], so the two parts need no packing (and no workspace). The operands are the inner loop on tiles
+    that fit in L1, so a block of 4 rows of M is loaded once per tile (with count > 1 it is a matrix product
+    Y = [Z1 Z2]*M^T).
+    Y must not overlap M, Z1 or Z2.
+  */
+  inline static void multiplyBlockedSplit(const double* M, int ld, int rows, const double* Z1, int n1, int ldz1,
+                                          const double* Z2, int n2, int ldz2, double* Y, int ldy, std::size_t count)
+  {
+    const int block_cols = 256;
+    const int cols = n1 + n2;
+    // tiles of operands of about 16 KB, they stay in L1 while the blocks of rows of M stream
+    const std::size_t block_ops = std::max(1, 2048 / std::max(1, std::min(cols, block_cols)));
+    for (std::size_t k0 = 0; k0 < count; k0 += block_ops)
+    {
+      const std::size_t k1 = std::min(count, k0 + block_ops);
+      for (int j0 = 0; j0 < cols || j0 == 0; j0 += block_cols)
+      {
+        const int j1 = std::min(cols, j0 + block_cols);
+        // columns [j0, j_split) multiply z1, columns [j_split, j1) multiply z2
+        const int j_split = std::max(j0, std::min(j1, n1));
+        int i = 0;
+        for (; i + 4 <= rows; i += 4)
+        {
+          const double* m0 = M + i * ld;
+          const double* m1 = m0 + ld;
+          const double* m2 = m1 + ld;
+          const double* m3 = m2 + ld;
+          for (std::size_t k = k0; k < k1; k++)
+          {
+            const double* z1 = Z1 + k * ldz1;
+            const double* z2 = Z2 + k * ldz2;
+            double* y = Y + k * ldy;
+            double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+            for (int j = j0; j < j_split; j++)
+            {
+              const double zj = z1[j];
+              acc0 += m0[j] * zj;
+              acc1 += m1[j] * zj;
+              acc2 += m2[j] * zj;
+              acc3 += m3[j] * zj;
+            }
+            for (int j = j_split; j < j1; j++)
+            {
+              const double zj = z2[j - n1];
+              acc0 += m0[j] * zj;
+              acc1 += m1[j] * zj;
+              acc2 += m2[j] * zj;
+              acc3 += m3[j] * zj;
+            }
+            if (j0 == 0)
+            {
+              y[i] = acc0;
+              y[i + 1] = acc1;
+              y[i + 2] = acc2;
+              y[i + 3] = acc3;
+            }
+            else
+            {
+              y[i] += acc0;
+              y[i + 1] += acc1;
+              y[i + 2] += acc2;
+              y[i + 3] += acc3;
+            }
+          }
+        }
+        for (; i < rows; i++)
+        {
+          const double* mi = M + i * ld;
+          for (std::size_t k = k0; k < k1; k++)
+          {
+            const double* z1 = Z1 + k * ldz1;
+            const double* z2 = Z2 + k * ldz2;
+            double* y = Y + k * ldy;
+            double acc = 0.0;
+            for (int j = j0; j < j_split; j++)
+            {
+              acc += mi[j] * z1[j];
+            }
+            for (int j = j_split; j < j1; j++)
+            {
+              acc += mi[j] * z2[j - n1];
+            }
+            y[i] = (j0 == 0) ? acc : y[i] + acc;
+          }
+        }
+      }
+    }
+  }
+
+  //! C = A*B
+  inline static void multiply(const TooN::Matrix<>& A, const TooN::Matrix<>& B, TooN::Matrix<>& C)
+  {
+    for (int i = 0; i < A.num_rows(); i++)
+    {
+      for (int j = 0; j < B.num_cols(); j++)
+      {
+        double acc = 0.0;
+        for (int k = 0; k < A.num_cols(); k++)
+        {
+          acc += A(i, k) * B(k, j);
+        }
+        C(i, j) = acc;
+      }
+    }
+  }
+
+  //! C = A*B^T
+  inline static void multiplyTransposed(const TooN::Matrix<>& A, const TooN::Matrix<>& B, TooN::Matrix<>& C)
+  {
+    for (int i = 0; i < A.num_rows(); i++)
+    {
+      for (int j = 0; j < B.num_rows(); j++)
+      {
+        double acc = 0.0;
+        for (int k = 0; k < A.num_cols(); k++)
+        {
+          acc += A(i, k) * B(j, k);
+        }
+        C(i, j) = acc;
+      }
+    }
+  }
+
+  //! 1-norm of A (max column sum of the absolute values)
+  inline static double norm1(const TooN::Matrix<>& A)
+  {
+    double norm = 0.0;
+    for (int j = 0; j < A.num_cols(); j++)
+    {
+      double col = 0.0;
+      for (int i = 0; i < A.num_rows(); i++)
+      {
+        col += std::fabs(A(i, j));
+      }
+      norm = std::max(norm, col);
+    }
+    return norm;
+  }
+
+  //! In place Cholesky factorization S = L*L^T of a symmetric positive definite matrix
+  /*!
+    Only the lower triangle of S is used, L is stored in the lower triangle (the upper one is not modified).
+    \return false if S is not (numerically) positive definite, S is partially overwritten in this case
+  */
+  inline static bool cholesky(TooN::Matrix<>& S)
+  {
+    const int n = S.num_rows();
+    for (int j = 0; j < n; j++)
+    {
+      double d = S(j, j);
+      for (int k = 0; k < j; k++)
+      {
+        d -= S(j, k) * S(j, k);
+      }
+      if (!(d > 0.0))
+      {
+        return false;
+      }
+      d = std::sqrt(d);
+      S(j, j) = d;
+      for (int i = j + 1; i < n; i++)
+      {
+        double acc = S(i, j);
+        for (int k = 0; k < j; k++)
+        {
+          acc -= S(i, k) * S(j, k);
+        }
+        S(i, j) = acc / d;
+      }
+    }
+    return true;
+  }
+
+  //! Solve S*X = B in place (B is overwritten by X), L is the Cholesky factor of S computed by cholesky()
+  inline static void choleskySolve(const TooN::Matrix<>& L, TooN::Matrix<>& B)
+  {
+    const int n = L.num_rows();
+    for (int c = 0; c < B.num_cols(); c++)
+    {
+      // L*z = b
+      for (int i = 0; i < n; i++)
+      {
+        double acc = B(i, c);
+        for (int k = 0; k < i; k++)
+        {
+          acc -= L(i, k) * B(k, c);
+        }
+        B(i, c) = acc / L(i, i);
+      }
+      // L^T*x = z
+      for (int i = n - 1; i >= 0; i--)
+      {
+        double acc = B(i, c);
+        for (int k = i + 1; k < n; k++)
+        {
+          acc -= L(k, i) * B(k, c);
+        }
+        B(i, c) = acc / L(i, i);
+      }
+    }
+  }
+};
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,520 @@
+/*
+    Eigenvalues, eigenvalues of real square matrices
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef EIGENVALUES_H
+#define EIGENVALUES_H
+
+/*! \file Eigenvalues.h
+    \brief Eigenvalues of real square matrices
+*/
+
+#include <TooN/TooN.h>
+#include <algorithm>
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace sun
+{
+//!  Eigenvalues class: static functions for the eigenvalues of real square matrices.
+/*!
+    The eigenvalues are computed with the Francis double shift QR iteration on an upper Hessenberg matrix.
+    The complex eigenvalues are returned in exact conjugate pairs.
+    The eigenvectors are computed by inverse iteration (eigenvectors()), with an orthonormal basis for each repeated
+    eigenvalue.
+
+    \sa Polynomial
+*/
+class Eigenvalues
+{
+private:
+  Eigenvalues();
+
+public:
+  //! Balance the matrix in place
+  /*!
+    Diagonal similarity transformation (powers of 2, no rounding errors) that makes the norms of the rows and the
+    columns comparable. It improves the accuracy of the eigenvalues, the Hessenberg form is preserved.
+  */
+  inline static void balance(TooN::Matrix<>& a)
+  {
+    const double radix = 2.0;
+    const double sqrdx = radix * radix;
+    const int n = a.num_rows();
+    bool done = false;
+    while (!done)
+    {
+      done = true;
+      for (int i = 0; i < n; i++)
+      {
+        double r = 0.0, c = 0.0;
+        for (int j = 0; j < n; j++)
+        {
+          if (j != i)
+          {
+            c += std::fabs(a(j, i));
+            r += std::fabs(a(i, j));
+          }
+        }
+        if (c == 0.0 || r == 0.0)
+          continue;
+
+        const double s = c + r;
+        double f = 1.0;
+        double g = r / radix;
+        while (c < g)
+        {
+          f *= radix;
+          c *= sqrdx;
+        }
+        g = r * radix;
+        while (c > g)
+        {
+          f /= radix;
+          c /= sqrdx;
+        }
+        if ((c + r) / f < 0.95 * s)
+        {
+          done = false;
+          g = 1.0 / f;
+          for (int j = 0; j < n; j++)
+            a(i, j) *= g;
+          for (int j = 0; j < n; j++)
+            a(j, i) *= f;
+        }
+      }
+    }
+  }
+
+  //! Reduce the matrix in place to upper Hessenberg form
+  /*!
+    Similarity transformation by Gaussian elimination with pivoting, the eigenvalues are preserved.
+    The elements below the subdiagonal are set to zero.
+  */
+  inline static void hessenberg(TooN::Matrix<>& a)
+  {
+    const int n = a.num_rows();
+    for (int m = 1; m < n - 1; m++)
+    {
+      double x = 0.0;
+      int i = m;
+      for (int j = m; j < n; j++)
+      {
+        if (std::fabs(a(j, m - 1)) > std::fabs(x))
+        {
+          x = a(j, m - 1);
+          i = j;
+        }
+      }
+      if (i != m)
+      {
+        for (int j = m - 1; j < n; j++)
+          std::swap(a(i, j), a(m, j));
+        for (int j = 0; j < n; j++)
+          std::swap(a(j, i), a(j, m));
+      }
+      if (x != 0.0)
+      {
+        for (i = m + 1; i < n; i++)
+        {
+          double y = a(i, m - 1);
+          if (y != 0.0)
+          {
+            y /= x;
+            a(i, m - 1) = 0.0;
+            for (int j = m; j < n; j++)
+              a(i, j) -= y * a(m, j);
+            for (int j = 0; j < n; j++)
+              a(j, m) += y * a(j, i);
+          }
+        }
+      }
+    }
+  }
+
+  //! Eigenvalues of a real square matrix
+  /*!
+    The matrix is balanced and reduced to Hessenberg form, then hessenbergEigenvalues() is used.
+    The complex eigenvalues are returned in adjacent conjugate pairs.
+  */
+  inline static std::vector<std::complex<double>> eigenvalues(const TooN::Matrix<>& A)
+  {
+    if (A.num_rows() != A.num_cols())
+    {
+      throw std::invalid_argument("[Eigenvalues::eigenvalues] The matrix has to be square");
+    }
+    TooN::Matrix<> a = A;
+    balance(a);
+    hessenberg(a);
+    return hessenbergEigenvalues(a);
+  }
+
+  //! Eigenvectors of the eigenvalues lambda by inverse iteration
+  /*!
+    One unit eigenvector for each element of lambda, each one solves (A - mu*I)*v_(i+1) = v_i a few times, with mu
+    the eigenvalue perturbed by a relative epsilon.
+    The eigenvalues closer than cluster_tol*max(1, max|A(i,j)|) are a repeated eigenvalue: the eigenvectors of the
+    cluster are computed with the same shift (the mean of the cluster), and at each iteration each one is
+    orthogonalized (Gram-Schmidt, twice) against the ones already found for the cluster. If A is diagonalizable they
+    are an orthonormal basis of the eigenspace. If the eigenvalue is defective they span the generalized eigenspace,
+    so the residual |A*v - lambda*v| has to be checked by the caller.
+
+    \param A real square matrix
+    \param lambda eigenvalues of A, a repeated eigenvalue is given once for each multiplicity
+    \param cluster_tol relative distance of the eigenvalues of a cluster (default 1e-8)
+    \return the eigenvectors, normalized to unit norm, in the order of lambda
+  */
+  inline static std::vector<std::vector<std::complex<double>>>
+  eigenvectors(const TooN::Matrix<>& A, const std::vector<std::complex<double>>& lambda, double cluster_tol = 1.0e-8)
+  {
+    typedef std::complex<double> Complex;
+    const int n = A.num_rows();
+    if (A.num_cols() != n)
+    {
+      throw std::invalid_argument("[Eigenvalues::eigenvectors] The matrix has to be square");
+    }
+    const double eps = std::numeric_limits<double>::epsilon();
+
+    double anorm = 0.0;
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+        anorm = std::max(anorm, std::fabs(A(i, j)));
+    const double cluster_dist = cluster_tol * std::max(anorm, 1.0);
+
+    std::vector<std::vector<Complex>> v(lambda.size());
+    std::vector<bool> done(lambda.size(), false);
+    std::vector<Complex> lu(n * n);
+    std::vector<int> piv(n);
+    for (std::size_t e = 0; e < lambda.size(); e++)
+    {
+      if (done[e])
+        continue;
+
+      // cluster of lambda[e]
+      std::vector<std::size_t> cluster;
+      Complex mean(0.0);
+      for (std::size_t f = e; f < lambda.size(); f++)
+      {
+        if (!done[f] && std::abs(lambda[f] - lambda[e]) <= cluster_dist)
+        {
+          cluster.push_back(f);
+          mean += lambda[f];
+          done[f] = true;
+        }
+      }
+      mean /= (double)cluster.size();
+      const Complex mu = mean + Complex(64.0 * eps * std::max(std::abs(mean), anorm), 0.0);
+      shiftedLU(A, mu, anorm, lu, piv);
+
+      for (std::size_t c = 0; c < cluster.size(); c++)
+      {
+        std::vector<Complex>& x = v[cluster[c]];
+        x = startVector(n, (unsigned int)cluster[c]);
+        for (int it = 0; it < 3; it++)
+        {
+          solveLU(lu, piv, x);
+          for (int pass = 0; pass < 2; pass++)
+          {
+            for (std::size_t d = 0; d < c; d++)
+            {
+              const std::vector<Complex>& u = v[cluster[d]];
+              Complex uhx(0.0);
+              for (int i = 0; i < n; i++)
+                uhx += std::conj(u[i]) * x[i];
+              for (int i = 0; i < n; i++)
+                x[i] -= uhx * u[i];
+            }
+          }
+          double xnorm = 0.0;
+          for (int i = 0; i < n; i++)
+            xnorm += std::norm(x[i]);
+          xnorm = std::sqrt(xnorm);
+          if (xnorm == 0.0)
+          {
+            break;  // the cluster is larger than the eigenspace, T = [v] is singular
+          }
+          for (int i = 0; i < n; i++)
+            x[i] /= xnorm;
+        }
+      }
+    }
+    return v;
+  }
+
+  //! Eigenvalues of an upper Hessenberg matrix
+  /*!
+    \param a upper Hessenberg matrix, it is destroyed
+    \param max_iter maximum number of iterations for each eigenvalue
+    \return the eigenvalues
+  */
+  inline static std::vector<std::complex<double>> hessenbergEigenvalues(TooN::Matrix<>& a, int max_iter = 60)
+  {
+    const int n = a.num_rows();
+    if (a.num_cols() != n)
+    {
+      throw std::invalid_argument("[Eigenvalues::hessenbergEigenvalues] The matrix has to be square");
+    }
+    const double eps = std::numeric_limits<double>::epsilon();
+
+    std::vector<std::complex<double>> w(n);
+
+    double anorm = 0.0;
+    for (int i = 0; i < n; i++)
+      for (int j = std::max(i - 1, 0); j < n; j++)
+        anorm += std::fabs(a(i, j));
+
+    int nn = n - 1;
+    double t = 0.0;  // accumulated exceptional shifts
+    while (nn >= 0)
+    {
+      int its = 0;
+      int l;
+      do
+      {
+        // look for a small subdiagonal element
+        for (l = nn; l > 0; l--)
+        {
+          double s = std::fabs(a(l - 1, l - 1)) + std::fabs(a(l, l));
+          if (s == 0.0)
+            s = anorm;
+          if (std::fabs(a(l, l - 1)) <= eps * s)
+          {
+            a(l, l - 1) = 0.0;
+            break;
+          }
+        }
+
+        double x = a(nn, nn);
+        if (l == nn)
+        {
+          // one root found
+          w[nn--] = x + t;
+        }
+        else
+        {
+          double y = a(nn - 1, nn - 1);
+          double ww = a(nn, nn - 1) * a(nn - 1, nn);
+          if (l == nn - 1)
+          {
+            // two roots found
+            const double p = 0.5 * (y - x);
+            const double q = p * p + ww;
+            double z = std::sqrt(std::fabs(q));
+            x += t;
+            if (q >= 0.0)
+            {
+              z = p + std::copysign(z, p);
+              w[nn - 1] = w[nn] = x + z;
+              if (z != 0.0)
+                w[nn] = x - ww / z;
+            }
+            else
+            {
+              w[nn - 1] = std::complex<double>(x + p, z);
+              w[nn] = std::complex<double>(x + p, -z);
+            }
+            nn -= 2;
+          }
+          else
+          {
+            // no roots found, continue the iteration
+            if (its == max_iter)
+            {
+              throw std::runtime_error("[Eigenvalues::hessenbergEigenvalues] Too many iterations");
+            }
+            if (its == 10 || its == 20)
+            {
+              // exceptional shift
+              t += x;
+              for (int i = 0; i <= nn; i++)
+                a(i, i) -= x;
+              const double s = std::fabs(a(nn, nn - 1)) + std::fabs(a(nn - 1, nn - 2));
+              y = x = 0.75 * s;
+              ww = -0.4375 * s * s;
+            }
+            ++its;
+
+            // look for two consecutive small subdiagonal elements
+            int m;
+            double p = 0.0, q = 0.0, r = 0.0, z = 0.0;
+            for (m = nn - 2; m >= l; m--)
+            {
+              z = a(m, m);
+              r = x - z;
+              const double s0 = y - z;
+              p = (r * s0 - ww) / a(m + 1, m) + a(m, m + 1);
+              q = a(m + 1, m + 1) - z - r - s0;
+              r = a(m + 2, m + 1);
+              const double s = std::fabs(p) + std::fabs(q) + std::fabs(r);
+              p /= s;
+              q /= s;
+              r /= s;
+              if (m == l)
+                break;
+              const double u = std::fabs(a(m, m - 1)) * (std::fabs(q) + std::fabs(r));
+              const double v = std::fabs(p) * (std::fabs(a(m - 1, m - 1)) + std::fabs(z) + std::fabs(a(m + 1, m + 1)));
+              if (u <= eps * v)
+                break;
+            }
+            for (int i = m; i < nn - 1; i++)
+            {
+              a(i + 2, i) = 0.0;
+              if (i != m)
+                a(i + 2, i - 1) = 0.0;
+            }
+
+            // double shift QR step on rows l..nn and columns m..nn
+            for (int k = m; k < nn; k++)
+            {
+              if (k != m)
+              {
+                p = a(k, k - 1);
+                q = a(k + 1, k - 1);
+                r = 0.0;
+                if (k + 1 != nn)
+                  r = a(k + 2, k - 1);
+                if ((x = std::fabs(p) + std::fabs(q) + std::fabs(r)) != 0.0)
+                {
+                  p /= x;
+                  q /= x;
+                  r /= x;
+                }
+              }
+              const double s = std::copysign(std::sqrt(p * p + q * q + r * r), p);
+              if (s == 0.0)
+                continue;
+              if (k == m)
+              {
+                if (l != m)
+                  a(k, k - 1) = -a(k, k - 1);
+              }
+              else
+              {
+                a(k, k - 1) = -s * x;
+              }
+              p += s;
+              x = p / s;
+              y = q / s;
+              z = r / s;
+              q /= p;
+              r /= p;
+              for (int j = k; j <= nn; j++)
+              {
+                p = a(k, j) + q * a(k + 1, j);
+                if (k + 1 != nn)
+                {
+                  p += r * a(k + 2, j);
+                  a(k + 2, j) -= p * z;
+                }
+                a(k + 1, j) -= p * y;
+                a(k, j) -= p * x;
+              }
+              const int mmin = (nn < k + 3) ? nn : k + 3;
+              for (int i = l; i <= mmin; i++)
+              {
+                p = x * a(i, k) + y * a(i, k + 1);
+                if (k + 1 != nn)
+                {
+                  p += z * a(i, k + 2);
+                  a(i, k + 2) -= p * r;
+                }
+                a(i, k + 1) -= p * q;
+                a(i, k) -= p;
+              }
+            }
+          }
+        }
+      } while (l + 1 < nn);
+    }
+
+    return w;
+  }
+
+private:
+  //! INTERNAL LU with partial pivoting of A - mu*I (row-major, the zero pivots are replaced by eps*|A|)
+  inline static void shiftedLU(const TooN::Matrix<>& A, std::complex<double> mu, double anorm,
+                               std::vector<std::complex<double>>& lu, std::vector<int>& piv)
+  {
+    typedef std::complex<double> Complex;
+    const int n = A.num_rows();
+    const double eps = std::numeric_limits<double>::epsilon();
+    for (int i = 0; i < n; i++)
+      for (int j = 0; j < n; j++)
+        lu[i * n + j] = Complex(A(i, j), 0.0) - ((i == j) ? mu : Complex(0.0));
+    for (int c = 0; c < n; c++)
+    {
+      int p = c;
+      for (int r = c + 1; r < n; r++)
+        if (std::abs(lu[r * n + c]) > std::abs(lu[p * n + c]))
+          p = r;
+      piv[c] = p;
+      if (p != c)
+        for (int j = 0; j < n; j++)
+          std::swap(lu[c * n + j], lu[p * n + j]);
+      if (lu[c * n + c] == Complex(0.0))
+        lu[c * n + c] = Complex(eps * std::max(anorm, 1.0), 0.0);
+      for (int r = c + 1; r < n; r++)
+      {
+        const Complex f = lu[r * n + c] / lu[c * n + c];
+        lu[r * n + c] = f;
+        for (int j = c + 1; j < n; j++)
+          lu[r * n + j] -= f * lu[c * n + j];
+      }
+    }
+  }
+
+  //! INTERNAL solve in place (LU)*x = P*x with the factorization of shiftedLU()
+  inline static void solveLU(const std::vector<std::complex<double>>& lu, const std::vector<int>& piv,
+                             std::vector<std::complex<double>>& x)
+  {
+    const int n = x.size();
+    for (int c = 0; c < n; c++)
+      std::swap(x[c], x[piv[c]]);
+    for (int i = 0; i < n; i++)
+      for (int k = 0; k < i; k++)
+        x[i] -= lu[i * n + k] * x[k];
+    for (int i = n - 1; i >= 0; i--)
+    {
+      for (int k = i + 1; k < n; k++)
+        x[i] -= lu[i * n + k] * x[k];
+      x[i] /= lu[i * n + i];
+    }
+  }
+
+  //! INTERNAL deterministic pseudo random start vector of the inverse iteration
+  inline static std::vector<std::complex<double>> startVector(int n, unsigned int seed)
+  {
+    std::vector<std::complex<double>> x(n);
+    unsigned int state = 2654435761u * (seed + 1u);
+    for (int i = 0; i < n; i++)
+    {
+      state = state * 1664525u + 1013904223u;
+      x[i] = std::complex<double>(0.5 + (double)(state >> 8) / (double)(1u << 24), 0.0);
+    }
+    return x;
+  }
+};
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,284 @@
+/*
+    Ensemble_Runner Class, run many copies of a discrete system on a thread pool
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENSEMBLE_RUNNER_H
+#define ENSEMBLE_RUNNER_H
+
+/*! \file Ensemble_Runner.h
+    \brief Ensemble (Monte Carlo) runner of cloned discrete systems on a work-stealing thread pool
+*/
+
+#include <sun_systems_lib/Discrete_System_Interface.h>
+#include "boost/function.hpp"
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sun
+{
+//! Perturbation of an instance: f(instance, system), called once on each clone at construction
+typedef boost::function<void(unsigned int, Discrete_System_Interface&)> ENSEMBLE_PERTURB_FCN;
+//! Input generator: f(instance, k, u_k), writes the input u(k) of the instance (u_k has the size of the input)
+typedef boost::function<void(unsigned int, std::size_t, TooN::Vector<>&)> ENSEMBLE_INPUT_FCN;
+//! Output sink: f(instance, k, y_k), receives the output y(k) of the instance
+typedef boost::function<void(unsigned int, std::size_t, const TooN::Vector<>&)> ENSEMBLE_OUTPUT_FCN;
+
+//!  Ensemble_Runner class: steps N clones of a prototype system on a work-stealing thread pool.
+/*!
+    The instances are independent tasks: each task runs a whole trajectory of an instance,
+
+    \verbatim
+    for (k = 0; k < num_steps; k++)
+    {
+      input_fcn(i, k, u_k);
+      y_k = instance_i.apply(u_k);
+      output_fcn(i, k, y_k);
+    }
+    \endverbatim
+
+    The tasks are distributed in contiguous ranges to the threads, an idle thread steals tasks from the back of the
+    queue of the other threads. The calls of an instance always happen in the same order on a single thread, so the
+    results do not depend on the number of threads as long as the input generator is a function of (instance, k)
+    only (e.g. one random generator per instance) and the output sink writes in per instance storage.
+    The generator and the sink are called concurrently for different instances.
+
+    The clones must not share mutable state (all the systems of this library clone their internals).
+    Link with the threads library (-pthread).
+
+    \sa Discrete_System_Interface::apply_into()
+*/
+class Ensemble_Runner
+{
+private:
+  Ensemble_Runner();
+
+protected:
+  //! The instances
+  std::vector<Discrete_System_Interface_Ptr> instances_;
+
+  //! INTERNAL Task queue of a thread
+  struct Task_Queue
+  {
+    std::mutex mutex;
+    std::deque<unsigned int> tasks;
+  };
+
+  //! INTERNAL Pop a task from the own queue (front) or steal one from the others (back)
+  static bool nextTask(std::vector<Task_Queue>& queues, unsigned int self, unsigned int& task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(queues[self].mutex);
+      if (!queues[self].tasks.empty())
+      {
+        task = queues[self].tasks.front();
+        queues[self].tasks.pop_front();
+        return true;
+      }
+    }
+    for (unsigned int off = 1; off < queues.size(); off++)
+    {
+      Task_Queue& victim = queues[(self + off) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty())
+      {
+        task = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+
+public:
+  /*===============CONSTRUCTORS===================*/
+
+  //! Constructor
+  /*!
+    \param prototype the system to be cloned
+    \param num_instances number of instances N
+    \param perturb_fcn optional perturbation of each clone f(instance, system) (default = NULL)
+  */
+  Ensemble_Runner(const Discrete_System_Interface& prototype, unsigned int num_instances,
+                  const ENSEMBLE_PERTURB_FCN& perturb_fcn = NULL)
+  {
+    instances_.reserve(num_instances);
+    for (unsigned int i = 0; i < num_instances; i++)
+    {
+      instances_.push_back(Discrete_System_Interface_Ptr(prototype.clone()));
+      if (perturb_fcn)
+      {
+        perturb_fcn(i, *instances_.back());
+      }
+    }
+  }
+
+  //! Copy Constructor, the instances are cloned
+  Ensemble_Runner(const Ensemble_Runner& runner)
+  {
+    instances_.reserve(runner.instances_.size());
+    for (const Discrete_System_Interface_Ptr& instance : runner.instances_)
+    {
+      instances_.push_back(Discrete_System_Interface_Ptr(instance->clone()));
+    }
+  }
+
+  virtual ~Ensemble_Runner() = default;
+
+  /*==============================================*/
+
+  /*=============GETTER===========================*/
+
+  //! Number of instances
+  inline unsigned int getNumInstances() const
+  {
+    return instances_.size();
+  }
+
+  //! Get an instance
+  inline Discrete_System_Interface& getInstance(unsigned int i)
+  {
+    return *instances_.at(i);
+  }
+
+  //! Get an instance
+  inline const Discrete_System_Interface& getInstance(unsigned int i) const
+  {
+    return *instances_.at(i);
+  }
+
+  /*==============================================*/
+
+  /*=============RUNNER===========================*/
+
+  //! Run num_steps steps of all the instances
+  /*!
+    The instances keep their state between the calls, use reset() to restart.
+    If a call throws, the remaining tasks are cancelled and the first exception is rethrown after the join.
+    \param num_steps number of steps of each instance
+    \param input_fcn input generator f(instance, k, u_k)
+    \param output_fcn output sink f(instance, k, y_k) (NULL = outputs discarded, use getInstance() for the final
+    state)
+    \param num_threads number of threads (0 = std::thread::hardware_concurrency())
+  */
+  void run(std::size_t num_steps, const ENSEMBLE_INPUT_FCN& input_fcn, const ENSEMBLE_OUTPUT_FCN& output_fcn = NULL,
+           unsigned int num_threads = 0)
+  {
+    if (!input_fcn)
+    {
+      throw std::invalid_argument("[Ensemble_Runner::run] The input generator is NULL");
+    }
+    if (num_threads == 0)
+    {
+      num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = std::max(1u, std::min<unsigned int>(num_threads, instances_.size()));
+
+    // Contiguous ranges: neighbour instances stay on the same thread if there is no stealing
+    std::vector<Task_Queue> queues(num_threads);
+    for (unsigned int t = 0; t < num_threads; t++)
+    {
+      const unsigned int first = (unsigned long)instances_.size() * t / num_threads;
+      const unsigned int last = (unsigned long)instances_.size() * (t + 1) / num_threads;
+      for (unsigned int i = first; i < last; i++)
+      {
+        queues[t].tasks.push_back(i);
+      }
+    }
+
+    std::atomic<bool> cancelled(false);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&](unsigned int self) {
+      try
+      {
+        // Per thread workspaces
+        TooN::Vector<> u_k(TooN::Zeros(instances_.empty() ? 0 : instances_[0]->getSizeInput()));
+        TooN::Vector<> y_k(TooN::Zeros(instances_.empty() ? 0 : instances_[0]->getSizeOutput()));
+        unsigned int task;
+        while (!cancelled.load(std::memory_order_relaxed) && nextTask(queues, self, task))
+        {
+          Discrete_System_Interface& system = *instances_[task];
+          for (std::size_t k = 0; k < num_steps; k++)
+          {
+            input_fcn(task, k, u_k);
+            system.apply_into(u_k, y_k);
+            if (output_fcn)
+            {
+              output_fcn(task, k, y_k);
+            }
+          }
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+        {
+          error = std::current_exception();
+        }
+        cancelled = true;
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (unsigned int t = 1; t < num_threads; t++)
+    {
+      threads.push_back(std::thread(worker, t));
+    }
+    worker(0);
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /*==============================================*/
+
+  /*=============VARIE===========================*/
+
+  //! Reset all the instances
+  void reset()
+  {
+    for (Discrete_System_Interface_Ptr& instance : instances_)
+    {
+      instance->reset();
+    }
+  }
+
+  /*==============================================*/
+};
+
+using Ensemble_Runner_Ptr = std::unique_ptr<Ensemble_Runner>;
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,153 @@
+/*
+    FFT, radix-2 fast Fourier transform
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FFT_H
+#define FFT_H
+
+/*! \file FFT.h
+    \brief Radix-2 fast Fourier transform
+*/
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+
+namespace sun
+{
+//!  FFT class: radix-2 fast Fourier transform of a fixed size.
+/*!
+    The object is a plan: the twiddle factors and the bit reversal permutation are computed at construction,
+    the transforms are in place and do not allocate memory.
+
+    \verbatim
+    forward:  X[k] = sum_j x[j]*exp(-2*pi*i*j*k/N)
+    inverse:  x[j] = (1/N) * sum_k X[k]*exp(2*pi*i*j*k/N)
+    \endverbatim
+*/
+class FFT
+{
+protected:
+  //! Size N of the transform
+  unsigned int size_;
+  //! Twiddle factors exp(-2*pi*i*k/N), k = 0 ... N/2-1
+  std::vector<std::complex<double>> twiddle_;
+  //! Bit reversal permutation
+  std::vector<unsigned int> bit_reverse_;
+
+  //! INTERNAL in place transform, the twiddle factors are conjugated if inverse
+  void transform(std::complex<double>* data, bool inverse) const
+  {
+    for (unsigned int i = 0; i < size_; i++)
+    {
+      const unsigned int j = bit_reverse_[i];
+      if (i < j)
+      {
+        std::swap(data[i], data[j]);
+      }
+    }
+    for (unsigned int len = 2; len <= size_; len <<= 1)
+    {
+      const unsigned int half = len >> 1;
+      const unsigned int step = size_ / len;
+      for (unsigned int start = 0; start < size_; start += len)
+      {
+        for (unsigned int k = 0; k < half; k++)
+        {
+          const std::complex<double> w = inverse ? std::conj(twiddle_[k * step]) : twiddle_[k * step];
+          const std::complex<double> t = w * data[start + k + half];
+          data[start + k + half] = data[start + k] - t;
+          data[start + k] += t;
+        }
+      }
+    }
+  }
+
+public:
+  //! Smallest power of 2 greater or equal to n
+  static unsigned int nextPowerOfTwo(unsigned int n)
+  {
+    unsigned int p = 1;
+    while (p < n)
+    {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  //! Constructor
+  /*!
+    \param size size of the transform, power of 2 (0 for an empty plan)
+  */
+  FFT(unsigned int size = 0) : size_(size), twiddle_(size / 2), bit_reverse_(size)
+  {
+    if (size != 0 && nextPowerOfTwo(size) != size)
+    {
+      throw std::invalid_argument("[FFT] The size has to be a power of 2");
+    }
+    const double pi = std::acos(-1.0);
+    for (unsigned int k = 0; k < size / 2; k++)
+    {
+      twiddle_[k] = std::polar(1.0, -2.0 * pi * k / size);
+    }
+    unsigned int bits = 0;
+    while ((1u << bits) < size)
+    {
+      bits++;
+    }
+    for (unsigned int i = 0; i < size; i++)
+    {
+      unsigned int r = 0;
+      for (unsigned int b = 0; b < bits; b++)
+      {
+        r |= ((i >> b) & 1u) << (bits - 1 - b);
+      }
+      bit_reverse_[i] = r;
+    }
+  }
+
+  //! Size of the transform
+  unsigned int getSize() const
+  {
+    return size_;
+  }
+
+  //! In place forward transform of size getSize()
+  void forward(std::complex<double>* data) const
+  {
+    transform(data, false);
+  }
+
+  //! In place inverse transform of size getSize(), scaled by 1/getSize()
+  void inverse(std::complex<double>* data) const
+  {
+    transform(data, true);
+    const double scale = 1.0 / size_;
+    for (unsigned int i = 0; i < size_; i++)
+    {
+      data[i] *= scale;
+    }
+  }
+};
+
+}  // namespace sun
+
+#endif
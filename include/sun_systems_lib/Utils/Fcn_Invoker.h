@@ -0,0 +1,89 @@
+/*
+    Fcn_Invoker Class, static dispatch of the system functions given as callables
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FCN_INVOKER_H
+#define FCN_INVOKER_H
+
+/*! \file Fcn_Invoker.h
+    \brief Static dispatch of the system functions given as callables (lambdas, functors)
+*/
+
+#include <TooN/TooN.h>
+#include <stdexcept>
+
+namespace sun
+{
+//!  No_Jacobian class: placeholder of a Jacobian function that is not defined, the call throws.
+class No_Jacobian
+{
+public:
+  TooN::Matrix<> operator()(const TooN::Vector<>&, const TooN::Vector<>&) const
+  {
+    throw std::runtime_error("[No_Jacobian] The Jacobian function is not defined");
+  }
+};
+
+//!  Fcn_Invoker class: static functions that call a system function in its allocation free form when available.
+/*!
+    A system function f(x,u) can be given in one of the forms
+
+    \verbatim
+    void f(const TooN::Vector<>& x, const TooN::Vector<>& u, TooN::Vector<>& out)  // allocation free, preferred
+    TooN::Vector<> f(const TooN::Vector<>& x, const TooN::Vector<>& u)              // out = f(x, u)
+    \endverbatim
+
+    (TooN::Matrix<> for the Jacobians). The form is chosen at compile time, the call is direct and can be inlined.
+
+    \sa SS_Template, Continuous_System_Template
+*/
+class Fcn_Invoker
+{
+private:
+  Fcn_Invoker();
+
+  //! INTERNAL Allocation free form f(x, u, out)
+  template <class Fcn, class Out>
+  inline static auto call(const Fcn& fcn, const TooN::Vector<>& x, const TooN::Vector<>& u, Out& out, int)
+      -> decltype(fcn(x, u, out), void())
+  {
+    fcn(x, u, out);
+  }
+
+  //! INTERNAL Returning form out = f(x, u)
+  template <class Fcn, class Out>
+  inline static auto call(const Fcn& fcn, const TooN::Vector<>& x, const TooN::Vector<>& u, Out& out, long)
+      -> decltype(out = fcn(x, u), void())
+  {
+    out = fcn(x, u);
+  }
+
+public:
+  //! out = fcn(x, u), out must have the size of the result
+  template <class Fcn, class Out>
+  inline static void into(const Fcn& fcn, const TooN::Vector<>& x, const TooN::Vector<>& u, Out& out)
+  {
+    call(fcn, x, u, out, 0);
+  }
+};
+
+}  // namespace sun
+
+#endif
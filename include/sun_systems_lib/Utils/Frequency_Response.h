@@ -0,0 +1,466 @@
+/*
+    Frequency_Response Class, frequency response of discrete systems on a grid of frequencies
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FREQUENCY_RESPONSE_H
+#define FREQUENCY_RESPONSE_H
+
+/*! \file Frequency_Response.h
+    \brief Batched frequency response of transfer functions and linear state space systems
+*/
+
+#include <sun_systems_lib/TF/TF_SISO.h>
+#include <sun_systems_lib/TF/TF_SOS.h>
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sun
+{
+//!  Frequency_Response class: static functions for the frequency response of discrete systems.
+/*!
+    The response is evaluated on a grid of N frequencies w (rad/s) on the unit circle z = e^(j*w*Ts).
+    If the sampling time is NaN (the default of TF_SISO) the frequencies are normalized (rad/sample, Ts = 1).
+
+    - TF_SISO and TF_SOS: the polynomials in z^-1 (the sections of a TF_SOS) are evaluated with the Horner scheme on
+      blocks of LANES frequencies stored as structure of arrays, so the inner loops are vectorized by the compiler.
+    - SS_LINEAR: A is reduced once to upper Hessenberg form H = Q^T*A*Q (Householder), then each frequency solves
+      (z*I - H)*X = Q^T*B with an O(n^2) elimination, instead of a O(n^3) factorization.
+      With the convention x(k) = A*x(k-1) + B*u(k), y(k) = C*x(k) + D*u(k) the response is
+      \verbatim
+      G(z) = C*(I - A*z^-1)^-1*B + D = z*C*(z*I - A)^-1*B + D
+      \endverbatim
+
+    The grid is split in contiguous ranges on num_threads threads (0 = std::thread::hardware_concurrency()), the
+    results do not depend on the number of threads. Link with the threads library (-pthread).
+
+    The MIMO responses are stored per frequency, G_k(i,j) = G[k*p*m + i*m + j] (p outputs, m inputs).
+    The magnitude is absolute (not dB), the phase is in radians in (-pi, pi].
+
+    \sa TF_SISO, TF_SOS, SS_LINEAR
+*/
+class Frequency_Response
+{
+public:
+  //! Number of frequencies evaluated together by the Horner kernel
+  static const unsigned int LANES = 8;
+
+private:
+  Frequency_Response();
+
+  //! INTERNAL Pair of polynomials in z^-1, the transfer function is the product of the ratios num/den
+  struct Factor
+  {
+    std::vector<double> num, den;
+  };
+
+  //! INTERNAL Sampling time used for the grid
+  static double gridTs(double Ts)
+  {
+    return std::isnan(Ts) ? 1.0 : Ts;
+  }
+
+  //! INTERNAL Factors of a TF_SISO or a TF_SOS
+  static std::vector<Factor> makeFactors(const SISO_System_Interface& siso, double& Ts)
+  {
+    std::vector<Factor> factors;
+    if (const TF_SISO* tf = dynamic_cast<const TF_SISO*>(&siso))
+    {
+      const TooN::Vector<>& num = tf->getNumeratorCoeff();
+      const TooN::Vector<> den = tf->getDenominatorCoeff();
+      Factor f;
+      for (int i = 0; i < num.size(); i++)
+        f.num.push_back(tf->getInputGain() * num[i]);
+      for (int i = 0; i < den.size(); i++)
+        f.den.push_back(den[i]);
+      factors.push_back(f);
+      Ts = tf->getTs();
+      return factors;
+    }
+    if (const TF_SOS* sos = dynamic_cast<const TF_SOS*>(&siso))
+    {
+      const TooN::Matrix<> S = sos->getSOS();
+      for (int i = 0; i < S.num_rows(); i++)
+      {
+        Factor f;
+        f.num = { S(i, 0), S(i, 1), S(i, 2) };
+        f.den = { S(i, 3), S(i, 4), S(i, 5) };
+        factors.push_back(f);
+      }
+      Ts = sos->getTs();
+      return factors;
+    }
+    throw std::invalid_argument("[Frequency_Response] The system has to be TF_SISO or TF_SOS");
+  }
+
+  //! INTERNAL p = c[0] + c[1]*q + ... + c[n]*q^n on LANES values of q (Horner)
+  static inline void horner(const std::vector<double>& c, const double* qr, const double* qi, double* pr, double* pi)
+  {
+    for (unsigned int l = 0; l < LANES; l++)
+    {
+      pr[l] = c.back();
+      pi[l] = 0.0;
+    }
+    for (int i = (int)c.size() - 2; i >= 0; i--)
+    {
+      const double ci = c[i];
+      for (unsigned int l = 0; l < LANES; l++)
+      {
+        const double tr = pr[l] * qr[l] - pi[l] * qi[l] + ci;
+        pi[l] = pr[l] * qi[l] + pi[l] * qr[l];
+        pr[l] = tr;
+      }
+    }
+  }
+
+  //! INTERNAL Response of the factors at w[first, last)
+  static void evaluateFactors(const std::vector<Factor>& factors, const double* w, double Ts, std::size_t first,
+                              std::size_t last, std::complex<double>* G)
+  {
+    double qr[LANES], qi[LANES], nr[LANES], ni[LANES], dr[LANES], di[LANES], gr[LANES], gi[LANES];
+    const std::size_t lanes = LANES;
+    for (std::size_t k0 = first; k0 < last; k0 += lanes)
+    {
+      const std::size_t count = std::min(lanes, last - k0);
+      // q = z^-1 = e^(-j*w*Ts), the lanes after the end are padded with w = 0
+      for (unsigned int l = 0; l < LANES; l++)
+      {
+        const double theta = (l < count) ? w[k0 + l] * Ts : 0.0;
+        qr[l] = std::cos(theta);
+        qi[l] = -std::sin(theta);
+        gr[l] = 1.0;
+        gi[l] = 0.0;
+      }
+      for (const Factor& f : factors)
+      {
+        horner(f.num, qr, qi, nr, ni);
+        horner(f.den, qr, qi, dr, di);
+        for (unsigned int l = 0; l < LANES; l++)
+        {
+          // g *= n/d
+          const double inv = 1.0 / (dr[l] * dr[l] + di[l] * di[l]);
+          const double rr = (nr[l] * dr[l] + ni[l] * di[l]) * inv;
+          const double ri = (ni[l] * dr[l] - nr[l] * di[l]) * inv;
+          const double tr = gr[l] * rr - gi[l] * ri;
+          gi[l] = gr[l] * ri + gi[l] * rr;
+          gr[l] = tr;
+        }
+      }
+      for (std::size_t l = 0; l < count; l++)
+      {
+        G[k0 + l] = std::complex<double>(gr[l], gi[l]);
+      }
+    }
+  }
+
+  //! INTERNAL Hessenberg form of a SS_LINEAR, H = Q^T*A*Q, QtB = Q^T*B, CQ = C*Q
+  struct Hessenberg_SS
+  {
+    TooN::Matrix<> H, QtB, CQ, D;
+
+    explicit Hessenberg_SS(const SS_LINEAR& ss) : H(ss.getA()), QtB(ss.getB()), CQ(ss.getC()), D(ss.getD())
+    {
+      const int n = H.num_rows();
+      std::vector<double> v(n);
+      for (int k = 0; k + 2 < n; k++)
+      {
+        // Householder reflector P = I - 2*v*v^T that zeroes H(k+2:n, k)
+        double norm = 0.0;
+        for (int i = k + 1; i < n; i++)
+          norm += H(i, k) * H(i, k);
+        norm = std::sqrt(norm);
+        if (norm == 0.0)
+        {
+          continue;
+        }
+        const double alpha = (H(k + 1, k) > 0.0) ? -norm : norm;
+        double v_norm = 0.0;
+        for (int i = k + 1; i < n; i++)
+        {
+          v[i] = H(i, k);
+          if (i == k + 1)
+            v[i] -= alpha;
+          v_norm += v[i] * v[i];
+        }
+        if (v_norm == 0.0)
+        {
+          continue;
+        }
+        v_norm = std::sqrt(v_norm);
+        for (int i = k + 1; i < n; i++)
+          v[i] /= v_norm;
+
+        // H = P*H*P, QtB = P*QtB, CQ = CQ*P
+        applyLeft(H, v, k + 1);
+        applyRight(H, v, k + 1);
+        applyLeft(QtB, v, k + 1);
+        applyRight(CQ, v, k + 1);
+        for (int i = k + 2; i < n; i++)
+          H(i, k) = 0.0;
+      }
+    }
+
+    //! M(i0:, :) = (I - 2*v*v^T)*M(i0:, :)
+    static void applyLeft(TooN::Matrix<>& M, const std::vector<double>& v, int i0)
+    {
+      for (int j = 0; j < M.num_cols(); j++)
+      {
+        double s = 0.0;
+        for (int i = i0; i < M.num_rows(); i++)
+          s += v[i] * M(i, j);
+        s *= 2.0;
+        for (int i = i0; i < M.num_rows(); i++)
+          M(i, j) -= s * v[i];
+      }
+    }
+
+    //! M(:, j0:) = M(:, j0:)*(I - 2*v*v^T)
+    static void applyRight(TooN::Matrix<>& M, const std::vector<double>& v, int j0)
+    {
+      for (int i = 0; i < M.num_rows(); i++)
+      {
+        double s = 0.0;
+        for (int j = j0; j < M.num_cols(); j++)
+          s += M(i, j) * v[j];
+        s *= 2.0;
+        for (int j = j0; j < M.num_cols(); j++)
+          M(i, j) -= s * v[j];
+      }
+    }
+  };
+
+  //! INTERNAL Response of the Hessenberg system at w[first, last)
+  static void evaluateHessenberg(const Hessenberg_SS& hs, const double* w, double Ts, std::size_t first,
+                                 std::size_t last, std::complex<double>* G)
+  {
+    typedef std::complex<double> Complex;
+    const int n = hs.H.num_rows();
+    const int m = hs.QtB.num_cols();
+    const int p = hs.CQ.num_rows();
+
+    // Per thread workspaces, M = z*I - H (row-major) and X = the right hand side
+    std::vector<Complex> M(n * n), X(n * m);
+    for (std::size_t k = first; k < last; k++)
+    {
+      const Complex z = std::polar(1.0, w[k] * Ts);
+      for (int i = 0; i < n; i++)
+      {
+        for (int j = std::max(0, i - 1); j < n; j++)
+          M[i * n + j] = -hs.H(i, j);
+        M[i * n + i] += z;
+        for (int j = 0; j < m; j++)
+          X[i * m + j] = hs.QtB(i, j);
+      }
+
+      // Elimination of the subdiagonal with partial pivoting between adjacent rows
+      for (int r = 0; r + 1 < n; r++)
+      {
+        Complex* row = &M[r * n];
+        Complex* next = &M[(r + 1) * n];
+        if (std::norm(next[r]) > std::norm(row[r]))
+        {
+          for (int j = r; j < n; j++)
+            std::swap(row[j], next[j]);
+          for (int j = 0; j < m; j++)
+            std::swap(X[r * m + j], X[(r + 1) * m + j]);
+        }
+        if (row[r] == 0.0)
+        {
+          continue;
+        }
+        const Complex l = next[r] / row[r];
+        for (int j = r + 1; j < n; j++)
+          next[j] -= l * row[j];
+        for (int j = 0; j < m; j++)
+          X[(r + 1) * m + j] -= l * X[r * m + j];
+      }
+
+      // Back substitution (a pole on the unit circle gives inf/nan)
+      for (int i = n - 1; i >= 0; i--)
+      {
+        for (int j = 0; j < m; j++)
+        {
+          Complex s = X[i * m + j];
+          for (int c = i + 1; c < n; c++)
+            s -= M[i * n + c] * X[c * m + j];
+          X[i * m + j] = s / M[i * n + i];
+        }
+      }
+
+      // G = z*C*Q*X + D
+      Complex* G_k = G + k * p * m;
+      for (int i = 0; i < p; i++)
+      {
+        for (int j = 0; j < m; j++)
+        {
+          Complex s = 0.0;
+          for (int c = 0; c < n; c++)
+            s += hs.CQ(i, c) * X[c * m + j];
+          G_k[i * m + j] = z * s + hs.D(i, j);
+        }
+      }
+    }
+  }
+
+  //! INTERNAL Run fcn(first, last) on contiguous ranges of [0, N), at least min_range elements per thread
+  template <class Range_Fcn>
+  static void parallelFor(std::size_t N, unsigned int num_threads, std::size_t min_range, const Range_Fcn& fcn)
+  {
+    if (num_threads == 0)
+    {
+      num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    num_threads = (unsigned int)std::max<std::size_t>(1, std::min<std::size_t>(num_threads, N / min_range));
+
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&](unsigned int t) {
+      try
+      {
+        fcn(N * t / num_threads, N * (t + 1) / num_threads);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error)
+        {
+          error = std::current_exception();
+        }
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (unsigned int t = 1; t < num_threads; t++)
+    {
+      threads.push_back(std::thread(worker, t));
+    }
+    worker(0);
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
+
+  //! INTERNAL Magnitude and phase of G
+  static void polar(const std::vector<std::complex<double>>& G, std::vector<double>& mag, std::vector<double>& phase)
+  {
+    mag.resize(G.size());
+    phase.resize(G.size());
+    for (std::size_t i = 0; i < G.size(); i++)
+    {
+      mag[i] = std::abs(G[i]);
+      phase[i] = std::arg(G[i]);
+    }
+  }
+
+public:
+  /*=============TRANSFER FUNCTIONS===============*/
+
+  //! Complex frequency response of a TF_SISO or a TF_SOS, the sampling time is getTs()
+  /*!
+    \param siso the system, TF_SISO (the input gain is included) or TF_SOS
+    \param w frequencies [rad/s]
+    \param G response G(e^(j*w[k]*Ts)) (output, resized to w.size())
+    \param num_threads number of threads (0 = std::thread::hardware_concurrency())
+  */
+  static void evaluate(const SISO_System_Interface& siso, const std::vector<double>& w,
+                       std::vector<std::complex<double>>& G, unsigned int num_threads = 0)
+  {
+    double Ts;
+    const std::vector<Factor> factors = makeFactors(siso, Ts);
+    Ts = gridTs(Ts);
+    G.resize(w.size());
+    parallelFor(w.size(), num_threads, 1024,
+                [&](std::size_t first, std::size_t last) { evaluateFactors(factors, w.data(), Ts, first, last, G.data()); });
+  }
+
+  //! Magnitude and phase of a TF_SISO or a TF_SOS, the sampling time is getTs()
+  /*!
+    \param siso the system, TF_SISO (the input gain is included) or TF_SOS
+    \param w frequencies [rad/s]
+    \param mag |G| (output, resized to w.size())
+    \param phase arg(G) [rad] (output, resized to w.size())
+    \param num_threads number of threads (0 = std::thread::hardware_concurrency())
+  */
+  static void bode(const SISO_System_Interface& siso, const std::vector<double>& w, std::vector<double>& mag,
+                   std::vector<double>& phase, unsigned int num_threads = 0)
+  {
+    std::vector<std::complex<double>> G;
+    evaluate(siso, w, G, num_threads);
+    polar(G, mag, phase);
+  }
+
+  /*==============================================*/
+
+  /*=============STATE SPACE======================*/
+
+  //! Complex frequency response of a SS_LINEAR
+  /*!
+    SS_LINEAR does not store the sampling time, it is an argument.
+    \param ss the system
+    \param Ts sampling time (NaN = normalized frequencies)
+    \param w frequencies [rad/s]
+    \param G response, G_k(i,j) = G[k*p*m + i*m + j] (output, resized to w.size()*p*m)
+    \param num_threads number of threads (0 = std::thread::hardware_concurrency())
+  */
+  static void evaluate(const SS_LINEAR& ss, double Ts, const std::vector<double>& w,
+                       std::vector<std::complex<double>>& G, unsigned int num_threads = 0)
+  {
+    const Hessenberg_SS hs(ss);
+    Ts = gridTs(Ts);
+    G.resize(w.size() * ss.getSizeOutput() * ss.getSizeInput());
+    parallelFor(w.size(), num_threads, 64,
+                [&](std::size_t first, std::size_t last) { evaluateHessenberg(hs, w.data(), Ts, first, last, G.data()); });
+  }
+
+  //! Magnitude and phase of a SS_LINEAR
+  /*!
+    \param ss the system
+    \param Ts sampling time (NaN = normalized frequencies)
+    \param w frequencies [rad/s]
+    \param mag |G|, same layout of evaluate() (output)
+    \param phase arg(G) [rad], same layout of evaluate() (output)
+    \param num_threads number of threads (0 = std::thread::hardware_concurrency())
+  */
+  static void bode(const SS_LINEAR& ss, double Ts, const std::vector<double>& w, std::vector<double>& mag,
+                   std::vector<double>& phase, unsigned int num_threads = 0)
+  {
+    std::vector<std::complex<double>> G;
+    evaluate(ss, Ts, w, G, num_threads);
+    polar(G, mag, phase);
+  }
+
+  /*==============================================*/
+};
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,256 @@
+/*
+    Instrumentation Class, per object call counters and timings of the systems
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+/*! \file Instrumentation.h
+    \brief Compile time optional call counters and timings of the systems
+
+    The instrumentation is enabled defining SUN_SYSTEMS_LIB_INSTRUMENTATION for the whole program
+    (e.g. add_definitions(-DSUN_SYSTEMS_LIB_INSTRUMENTATION)), it changes the layout of the system classes so all the
+    translation units must agree.
+    When it is not defined the hooks expand to nothing and the systems carry no extra member.
+*/
+
+#include <iostream>
+
+#ifdef SUN_SYSTEMS_LIB_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#endif
+
+namespace sun
+{
+//!  Instrumentation class: call counters and timings of a system object.
+/*!
+    For each instrumented call the object keeps the number of calls, the cumulative time and the duration of the last
+    call (ns). The counters are atomics (relaxed), so const calls from different threads are counted correctly.
+    The timings are inclusive: the time of apply() includes the time of the state_fcn() called inside.
+
+    The stats belong to an object: a copy (or a clone()) starts from zero.
+    When SUN_SYSTEMS_LIB_INSTRUMENTATION is not defined the class is empty, getStats() returns zeros and display()
+    prints nothing.
+
+    \sa SUN_SYSTEMS_LIB_INSTRUMENT
+*/
+class Instrumentation
+{
+public:
+  //! The instrumented calls
+  enum Call
+  {
+    APPLY = 0,         //!< apply(), apply_into()
+    SIMULATE,          //!< simulate_block(), apply_block() (one call per block)
+    STATE_FCN,         //!< state_fcn(), state_fcn_into(), obs_state_fcn()
+    OUTPUT_FCN,        //!< output_fcn(), output_fcn_into(), obs_output_fcn()
+    JACOB_STATE_FCN,   //!< jacob_state_fcn(), jacob_state_fcn_into()
+    JACOB_OUTPUT_FCN,  //!< jacob_output_fcn(), jacob_output_fcn_into()
+    NUM_CALLS
+  };
+
+  //! Stats of a call
+  struct Call_Stats
+  {
+    unsigned long long count;
+    unsigned long long total_ns;
+    unsigned long long last_ns;
+  };
+
+  //! Name of a call
+  static const char* callName(Call call)
+  {
+    static const char* names[NUM_CALLS] = { "apply", "simulate", "state_fcn", "output_fcn", "jacob_state_fcn",
+                                            "jacob_output_fcn" };
+    return names[call];
+  }
+
+  //! True if the library is compiled with SUN_SYSTEMS_LIB_INSTRUMENTATION
+  static constexpr bool enabled()
+  {
+#ifdef SUN_SYSTEMS_LIB_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+  }
+
+#ifdef SUN_SYSTEMS_LIB_INSTRUMENTATION
+
+private:
+  mutable std::atomic<unsigned long long> count_[NUM_CALLS];
+  mutable std::atomic<unsigned long long> total_ns_[NUM_CALLS];
+  mutable std::atomic<unsigned long long> last_ns_[NUM_CALLS];
+
+public:
+  //! RAII timer of a call, use SUN_SYSTEMS_LIB_INSTRUMENT
+  class Scope
+  {
+  private:
+    const Instrumentation& instrumentation_;
+    const Call call_;
+    const std::chrono::steady_clock::time_point start_;
+
+  public:
+    Scope(const Instrumentation& instrumentation, Call call)
+      : instrumentation_(instrumentation), call_(call), start_(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~Scope()
+    {
+      instrumentation_.record(
+          call_, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    }
+  };
+
+  Instrumentation()
+  {
+    reset();
+  }
+
+  //! Copy constructor, the stats are not copied
+  Instrumentation(const Instrumentation&) : Instrumentation()
+  {
+  }
+
+  //! Assignment, the stats are not copied
+  Instrumentation& operator=(const Instrumentation&)
+  {
+    return *this;
+  }
+
+  //! Record a call of duration ns
+  inline void record(Call call, unsigned long long ns) const
+  {
+    count_[call].fetch_add(1, std::memory_order_relaxed);
+    total_ns_[call].fetch_add(ns, std::memory_order_relaxed);
+    last_ns_[call].store(ns, std::memory_order_relaxed);
+  }
+
+  //! Get the stats of a call
+  Call_Stats getStats(Call call) const
+  {
+    Call_Stats stats;
+    stats.count = count_[call].load(std::memory_order_relaxed);
+    stats.total_ns = total_ns_[call].load(std::memory_order_relaxed);
+    stats.last_ns = last_ns_[call].load(std::memory_order_relaxed);
+    return stats;
+  }
+
+  //! Reset the stats
+  void reset()
+  {
+    for (int i = 0; i < NUM_CALLS; i++)
+    {
+      count_[i] = 0;
+      total_ns_[i] = 0;
+      last_ns_[i] = 0;
+    }
+  }
+
+  //! Display the stats of the called functions on the std out
+  void display() const
+  {
+    std::cout << "   Stats:" << std::endl;
+    for (int i = 0; i < NUM_CALLS; i++)
+    {
+      const Call_Stats stats = getStats((Call)i);
+      if (stats.count == 0)
+      {
+        continue;
+      }
+      std::cout << "   " << std::left << std::setw(17) << callName((Call)i) << std::right
+                << " calls= " << stats.count << " total= " << stats.total_ns << " ns"
+                << " mean= " << stats.total_ns / stats.count << " ns"
+                << " last= " << stats.last_ns << " ns" << std::endl;
+    }
+  }
+
+#else
+
+  //! Get the stats of a call (always zero)
+  Call_Stats getStats(Call) const
+  {
+    Call_Stats stats = { 0, 0, 0 };
+    return stats;
+  }
+
+  //! Reset the stats (no op)
+  void reset()
+  {
+  }
+
+  //! Display the stats (no op)
+  void display() const
+  {
+  }
+
+#endif
+};
+
+}  // namespace sun
+
+#ifdef SUN_SYSTEMS_LIB_INSTRUMENTATION
+
+//! Time the enclosing scope as the call Instrumentation::call of the current object
+#define SUN_SYSTEMS_LIB_INSTRUMENT(call)                                                                               \
+  const sun::Instrumentation::Scope sun_instrumentation_scope_(this->instrumentation_, sun::Instrumentation::call)
+
+//! Declare the instrumentation member and its getters in a system class
+#define SUN_SYSTEMS_LIB_INSTRUMENTATION_MEMBER                                                                         \
+protected:                                                                                                             \
+  sun::Instrumentation instrumentation_;                                                                               \
+                                                                                                                       \
+public:                                                                                                                \
+  /*! Get the call stats of the object */                                                                            \
+  const sun::Instrumentation& getInstrumentation() const                                                               \
+  {                                                                                                                    \
+    return instrumentation_;                                                                                           \
+  }                                                                                                                    \
+  /*! Reset the call stats of the object */                                                                          \
+  void resetInstrumentation()                                                                                          \
+  {                                                                                                                    \
+    instrumentation_.reset();                                                                                          \
+  }
+
+#else
+
+#define SUN_SYSTEMS_LIB_INSTRUMENT(call) ((void)0)
+
+#define SUN_SYSTEMS_LIB_INSTRUMENTATION_MEMBER                                                                         \
+public:                                                                                                                \
+  /*! Get the call stats of the object (always zero, instrumentation disabled) */                                    \
+  const sun::Instrumentation& getInstrumentation() const                                                               \
+  {                                                                                                                    \
+    static const sun::Instrumentation disabled;                                                                        \
+    return disabled;                                                                                                   \
+  }                                                                                                                    \
+  /*! Reset the call stats of the object (no op, instrumentation disabled) */                                        \
+  void resetInstrumentation()                                                                                          \
+  {                                                                                                                    \
+  }
+
+#endif
+
+#endif
@@ -0,0 +1,160 @@
+/*
+    Matrix_Exponential Class, exponential of real square matrices
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MATRIX_EXPONENTIAL_H
+#define MATRIX_EXPONENTIAL_H
+
+/*! \file Matrix_Exponential.h
+    \brief Exponential of real square matrices
+*/
+
+#include <sun_systems_lib/Utils/Dense_Kernels.h>
+#include <TooN/TooN.h>
+#include <TooN/LU.h>
+#include <cmath>
+#include <stdexcept>
+
+namespace sun
+{
+//!  Matrix_Exponential class: static functions for the exponential of real square matrices.
+/*!
+    expm() uses the scaling and squaring method with Padé approximants of order 3, 5, 7, 9 or 13
+    (N. J. Higham, "The scaling and squaring method for the matrix exponential revisited", 2005):
+    the order and the scaling 2^-s are chosen from the 1-norm of the matrix so that the backward error is at the
+    double precision unit roundoff.
+
+    \sa Exact_Discretizator
+*/
+class Matrix_Exponential
+{
+private:
+  Matrix_Exponential();
+
+  //! INTERNAL Padé approximant r_m(A) = (V-U)^-1 (V+U), b are the m+1 coefficients
+  inline static TooN::Matrix<> pade(const TooN::Matrix<>& A, const TooN::Matrix<>& A2, const double* b, int m)
+  {
+    const int n = A.num_rows();
+    const TooN::Matrix<> I = TooN::Identity(n);
+
+    // U = A*(b[m] A^(m-1) + ... + b[3] A^2 + b[1] I), V = b[m-1] A^(m-1) + ... + b[2] A^2 + b[0] I
+    TooN::Matrix<> A2k = I;
+    TooN::Matrix<> U_tmp = b[1] * I;
+    TooN::Matrix<> V = b[0] * I;
+    for (int k = 2; k <= m; k += 2)
+    {
+      A2k = A2k * A2;
+      U_tmp += b[k + 1] * A2k;
+      V += b[k] * A2k;
+    }
+    const TooN::Matrix<> U = A * U_tmp;
+    return solve(V - U, V + U);
+  }
+
+  //! INTERNAL Padé approximant of order 13, same of pade() with the evaluation scheme of Higham
+  inline static TooN::Matrix<> pade13(const TooN::Matrix<>& A)
+  {
+    static const double b[] = { 64764752532480000.0, 32382376266240000.0, 7771770303897600.0,
+                                1187353796428800.0,  129060195264000.0,   10559470521600.0,
+                                670442572800.0,      33522128640.0,       1323241920.0,
+                                40840800.0,          960960.0,            16380.0,
+                                182.0,               1.0 };
+    const int n = A.num_rows();
+    const TooN::Matrix<> I = TooN::Identity(n);
+    const TooN::Matrix<> A2 = A * A;
+    const TooN::Matrix<> A4 = A2 * A2;
+    const TooN::Matrix<> A6 = A2 * A4;
+
+    const TooN::Matrix<> U =
+        A * (A6 * (b[13] * A6 + b[11] * A4 + b[9] * A2) + b[7] * A6 + b[5] * A4 + b[3] * A2 + b[1] * I);
+    const TooN::Matrix<> V = A6 * (b[12] * A6 + b[10] * A4 + b[8] * A2) + b[6] * A6 + b[4] * A4 + b[2] * A2 + b[0] * I;
+    return solve(V - U, V + U);
+  }
+
+  //! INTERNAL X = P^-1 Q
+  inline static TooN::Matrix<> solve(const TooN::Matrix<>& P, const TooN::Matrix<>& Q)
+  {
+    TooN::LU<> lu(P);
+    if (lu.get_info() != 0)
+    {
+      throw std::runtime_error("[Matrix_Exponential] Singular Padé denominator");
+    }
+    return lu.backsub(Q);
+  }
+
+public:
+  //! Exponential of the square matrix A
+  /*!
+    \param A square matrix
+    \return e^A
+  */
+  static TooN::Matrix<> expm(const TooN::Matrix<>& A)
+  {
+    if (A.num_rows() != A.num_cols())
+    {
+      throw std::invalid_argument("[Matrix_Exponential::expm] The matrix has to be square");
+    }
+    if (A.num_rows() == 0)
+    {
+      return A;
+    }
+
+    static const double theta[] = { 1.495585217958292e-2, 2.539398330063230e-1, 9.504178996162932e-1,
+                                    2.097847961257068e0 };
+    static const int order[] = { 3, 5, 7, 9 };
+    static const double b3[] = { 120.0, 60.0, 12.0, 1.0 };
+    static const double b5[] = { 30240.0, 15120.0, 3360.0, 420.0, 30.0, 1.0 };
+    static const double b7[] = { 17297280.0, 8648640.0, 1995840.0, 277200.0, 25200.0, 1512.0, 56.0, 1.0 };
+    static const double b9[] = { 17643225600.0, 8821612800.0, 2075673600.0, 302702400.0, 30270240.0,
+                                 2162160.0,     110880.0,     3960.0,       90.0,        1.0 };
+    static const double* b[] = { b3, b5, b7, b9 };
+    const double theta13 = 5.371920351148152e0;
+
+    const double A_norm = Dense_Kernels::norm1(A);
+    if (!std::isfinite(A_norm))
+    {
+      throw std::invalid_argument("[Matrix_Exponential::expm] The matrix has non finite elements");
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+      if (A_norm <= theta[i])
+      {
+        return pade(A, A * A, b[i], order[i]);
+      }
+    }
+
+    int s = 0;
+    if (A_norm > theta13)
+    {
+      s = (int)std::ceil(std::log2(A_norm / theta13));
+    }
+    TooN::Matrix<> E = pade13(std::ldexp(1.0, -s) * A);
+    for (int i = 0; i < s; i++)
+    {
+      E = E * E;
+    }
+    return E;
+  }
+};
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,290 @@
+/*
+    Polynomial, utility functions on real polynomials
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+
+/*! \file Polynomial.h
+    \brief Utility functions on real polynomials
+*/
+
+#include "sun_systems_lib/Utils/Eigenvalues.h"
+#include <complex>
+#include <vector>
+#include <cmath>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+namespace sun
+{
+//!  Polynomial class: static utility functions on real polynomials.
+/*!
+    A polynomial is stored as the vector of its coefficients in ascending powers:
+
+    \verbatim
+    p(x) = c[0] + c[1]*x + c[2]*x^2 + ... + c[n]*x^n
+    \endverbatim
+
+    This is the same ordering of the TF_SISO coefficients in the variable z^-1.
+
+    \sa TF_SOS, Eigenvalues
+*/
+class Polynomial
+{
+private:
+  Polynomial();
+
+public:
+  //! Effective degree of the polynomial (the trailing zero coefficients are ignored)
+  /*!
+    \return the degree, -1 for the zero polynomial
+  */
+  inline static int degree(const TooN::Vector<>& coeff)
+  {
+    int deg = coeff.size() - 1;
+    while (deg >= 0 && coeff[deg] == 0.0)
+    {
+      deg--;
+    }
+    return deg;
+  }
+
+  //! Evaluate the polynomial in x (Horner)
+  inline static std::complex<double> evaluate(const TooN::Vector<>& coeff, const std::complex<double>& x)
+  {
+    std::complex<double> res = 0.0;
+    for (int i = coeff.size() - 1; i >= 0; i--)
+    {
+      res = res * x + coeff[i];
+    }
+    return res;
+  }
+
+  //! Product of two polynomials
+  inline static TooN::Vector<> multiply(const TooN::Vector<>& a, const TooN::Vector<>& b)
+  {
+    if (a.size() == 0 || b.size() == 0)
+    {
+      return TooN::Vector<>(0);
+    }
+    TooN::Vector<> res = TooN::Zeros(a.size() + b.size() - 1);
+    for (int i = 0; i < a.size(); i++)
+    {
+      for (int j = 0; j < b.size(); j++)
+      {
+        res[i + j] += a[i] * b[j];
+      }
+    }
+    return res;
+  }
+
+  //! Roots of the polynomial
+  /*!
+    The roots are the eigenvalues of the balanced companion matrix (the complex roots are in exact conjugate
+    pairs), then the clusters of roots around a multiple root are replaced by the multiple root.
+    The roots in x = 0 (leading zero coefficients) are returned exactly.
+    \param coeff coefficients in ascending powers
+    \return the roots, the number of roots is the effective degree of the polynomial
+  */
+  inline static std::vector<std::complex<double>> roots(const TooN::Vector<>& coeff)
+  {
+    const int deg = degree(coeff);
+    if (deg < 0)
+    {
+      throw std::domain_error("[Polynomial::roots] Zero polynomial");
+    }
+
+    std::vector<std::complex<double>> res;
+
+    // roots in zero
+    int first = 0;
+    while (coeff[first] == 0.0)
+    {
+      res.push_back(0.0);
+      first++;
+    }
+
+    const int n = deg - first;
+    if (n == 0)
+    {
+      return res;
+    }
+
+    // monic polynomial without the roots in zero
+    TooN::Vector<> p = coeff.slice(first, n + 1) / coeff[deg];
+
+    // eigenvalues of the balanced companion matrix
+    TooN::Matrix<> companion = TooN::Zeros(n, n);
+    for (int j = 0; j < n; j++)
+    {
+      companion(0, j) = -p[n - 1 - j];
+    }
+    for (int i = 1; i < n; i++)
+    {
+      companion(i, i - 1) = 1.0;
+    }
+    Eigenvalues::balance(companion);
+    std::vector<std::complex<double>> z = Eigenvalues::hessenbergEigenvalues(companion);
+
+    mergeMultipleRoots(p, z);
+
+    for (int k = 0; k < n; k++)
+    {
+      res.push_back(z[k]);
+    }
+
+    return res;
+  }
+
+  //! INTERNAL relative backward error of the roots z of the monic polynomial p
+  /*!
+    \return max|coeff(prod(x - z_i)) - p| / max|p|
+  */
+  inline static double backwardError(const TooN::Vector<>& p, const std::vector<std::complex<double>>& z)
+  {
+    const int n = z.size();
+    // coefficients of prod(x - z_i) in ascending powers
+    std::vector<std::complex<double>> c(n + 1, 0.0);
+    c[0] = 1.0;
+    for (int i = 0; i < n; i++)
+    {
+      for (int j = i + 1; j >= 0; j--)
+      {
+        c[j] = ((j > 0) ? c[j - 1] : 0.0) - z[i] * c[j];
+      }
+    }
+    double err = 0.0, scale = 0.0;
+    for (int i = 0; i <= n; i++)
+    {
+      err = std::max(err, std::abs(c[i] - p[i]));
+      scale = std::max(scale, std::fabs(p[i]));
+    }
+    return err / scale;
+  }
+
+  //! INTERNAL rounding error bound of the Horner evaluation of p in a point of modulus abs_x
+  inline static double roundingBound(const TooN::Vector<>& p, double abs_x)
+  {
+    double res = 0.0;
+    for (int i = p.size() - 1; i >= 0; i--)
+    {
+      res = res * abs_x + std::fabs(p[i]);
+    }
+    return 4.0 * p.size() * std::numeric_limits<double>::epsilon() * res;
+  }
+
+  //! INTERNAL derivative of the given order of the polynomial
+  inline static TooN::Vector<> derivative(const TooN::Vector<>& p, unsigned int order)
+  {
+    TooN::Vector<> res(p.size() - order);
+    for (int i = 0; i < res.size(); i++)
+    {
+      // p[i+order] * (i+order)! / i!
+      double c = p[i + order];
+      for (unsigned int j = 1; j <= order; j++)
+      {
+        c *= (i + j);
+      }
+      res[i] = c;
+    }
+    return res;
+  }
+
+  //! INTERNAL replace the clusters of roots around a multiple root with the multiple root
+  /*!
+    A root of multiplicity k is returned by the iteration as a cluster of k roots at a distance of about eps^(1/k).
+    The multiple root is a simple root of the (k-1)-th derivative, it is refined with Newton starting from the
+    centroid of the cluster.
+    The clusters are searched with increasing radius, a cluster is merged only if the backward error of the merged
+    roots is small.
+  */
+  inline static void mergeMultipleRoots(const TooN::Vector<>& p, std::vector<std::complex<double>>& z)
+  {
+    const int n = z.size();
+    const double max_err = std::max(backwardError(p, z), 100.0 * n * std::numeric_limits<double>::epsilon());
+    for (double radius = 1E-8; radius < 0.5; radius *= 4.0)
+    {
+      std::vector<bool> visited(n, false);
+      for (int i = 0; i < n; i++)
+      {
+        if (visited[i])
+          continue;
+        // connected component of the roots closer than radius
+        std::vector<int> cluster(1, i);
+        visited[i] = true;
+        for (unsigned int c = 0; c < cluster.size(); c++)
+        {
+          for (int j = 0; j < n; j++)
+          {
+            if (!visited[j] && std::abs(z[j] - z[cluster[c]]) < radius * (1.0 + std::abs(z[cluster[c]])))
+            {
+              visited[j] = true;
+              cluster.push_back(j);
+            }
+          }
+        }
+        if (cluster.size() < 2)
+          continue;
+
+        std::complex<double> root = 0.0;
+        for (int j : cluster)
+          root += z[j];
+        root /= double(cluster.size());
+
+        const TooN::Vector<> dp = derivative(p, cluster.size() - 1);
+        for (int iter = 0; iter < 20; iter++)
+        {
+          std::complex<double> dpz, ddpz;
+          evaluateWithDerivative(dp, root, dpz, ddpz);
+          if (std::abs(dpz) <= roundingBound(dp, std::abs(root)) || ddpz == 0.0)
+            break;
+          root -= dpz / ddpz;
+        }
+
+        std::vector<std::complex<double>> z_merged(z);
+        for (int j : cluster)
+          z_merged[j] = root;
+        if (backwardError(p, z_merged) <= max_err)
+        {
+          z = z_merged;
+        }
+      }
+    }
+  }
+
+  //! INTERNAL evaluate the polynomial and its derivative in x (Horner)
+  inline static void evaluateWithDerivative(const TooN::Vector<>& coeff, const std::complex<double>& x,
+                                            std::complex<double>& p, std::complex<double>& dp)
+  {
+    p = 0.0;
+    dp = 0.0;
+    for (int i = coeff.size() - 1; i >= 0; i--)
+    {
+      dp = dp * x + p;
+      p = p * x + coeff[i];
+    }
+  }
+};
+
+}  // namespace sun
+
+#endif
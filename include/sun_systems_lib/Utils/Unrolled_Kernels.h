@@ -0,0 +1,142 @@
+/*
+    Unrolled_Kernels, compile-time unrolled kernels for fixed size arrays
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef UNROLLED_KERNELS_H
+#define UNROLLED_KERNELS_H
+
+/*! \file Unrolled_Kernels.h
+    \brief Compile-time unrolled kernels for fixed size arrays
+*/
+
+namespace sun
+{
+//!  Unrolled_Kernels struct: compile-time unrolled kernels on arrays of size N.
+/*!
+    The recursion is resolved at compile time, so the kernels are fully unrolled.
+
+    The dot product sums the terms in the same order of a plain loop:
+
+    \verbatim
+    dot(a,b) = ((0 + a[0]*b[0]) + a[1]*b[1]) + ... + a[N-1]*b[N-1]
+    \endverbatim
+
+    The matrix-vector product works on N rows of a row-major block with COLS columns and leading dimension LD, each
+    row is an unrolled dot product.
+
+    \sa TF_SISO_Static, SS_LINEAR_Static
+*/
+template <int N>
+struct Unrolled_Kernels
+{
+  //! Dot product a^T*b
+  inline static double dot(const double* a, const double* b)
+  {
+    return Unrolled_Kernels<N - 1>::dot(a, b) + a[N - 1] * b[N - 1];
+  }
+
+  //! Shift the array by one position: v[i] = v[i-1], v[0] is left unchanged
+  inline static void shift(double* v)
+  {
+    v[N - 1] = v[N - 2];
+    Unrolled_Kernels<N - 1>::shift(v);
+  }
+
+  //! Set all the elements to value
+  inline static void fill(double* v, double value)
+  {
+    v[N - 1] = value;
+    Unrolled_Kernels<N - 1>::fill(v, value);
+  }
+
+  //! Copy the array: dst[i] = src[i]
+  inline static void copy(const double* src, double* dst)
+  {
+    dst[N - 1] = src[N - 1];
+    Unrolled_Kernels<N - 1>::copy(src, dst);
+  }
+
+  //! y = M*x, M is a row-major block of N rows x COLS with leading dimension LD
+  template <int COLS, int LD = COLS>
+  inline static void multiply(const double* M, const double* x, double* y)
+  {
+    Unrolled_Kernels<N - 1>::template multiply<COLS, LD>(M, x, y);
+    y[N - 1] = Unrolled_Kernels<COLS>::dot(M + (N - 1) * LD, x);
+  }
+};
+
+template <>
+struct Unrolled_Kernels<1>
+{
+  inline static double dot(const double* a, const double* b)
+  {
+    return 0.0 + a[0] * b[0];
+  }
+
+  inline static void shift(double* v)
+  {
+  }
+
+  inline static void fill(double* v, double value)
+  {
+    v[0] = value;
+  }
+
+  inline static void copy(const double* src, double* dst)
+  {
+    dst[0] = src[0];
+  }
+
+  template <int COLS, int LD = COLS>
+  inline static void multiply(const double* M, const double* x, double* y)
+  {
+    y[0] = Unrolled_Kernels<COLS>::dot(M, x);
+  }
+};
+
+template <>
+struct Unrolled_Kernels<0>
+{
+  inline static double dot(const double* a, const double* b)
+  {
+    return 0.0;
+  }
+
+  inline static void shift(double* v)
+  {
+  }
+
+  inline static void fill(double* v, double value)
+  {
+  }
+
+  inline static void copy(const double* src, double* dst)
+  {
+  }
+
+  template <int COLS, int LD = COLS>
+  inline static void multiply(const double* M, const double* x, double* y)
+  {
+  }
+};
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,108 @@
+/*
+    Allocation_Counter, count the heap allocations of the process
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+/*! \file Allocation_Counter.h
+    \brief Replacement of the global operator new that counts the heap allocations
+
+    This header replaces the global allocation functions, include it in exactly one translation unit of an
+    executable (benchmarks and test harnesses only, never in the library headers).
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace sun
+{
+//!  Allocation_Counter class: number of calls to the global operator new (all threads).
+class Allocation_Counter
+{
+private:
+  Allocation_Counter();
+
+public:
+  //! INTERNAL counter
+  static std::atomic<unsigned long>& counter()
+  {
+    static std::atomic<unsigned long> count(0);
+    return count;
+  }
+
+  //! Number of allocations since the start of the process
+  static unsigned long get()
+  {
+    return counter().load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace sun
+
+void* operator new(std::size_t size)
+{
+  sun::Allocation_Counter::counter().fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size ? size : 1);
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  sun::Allocation_Counter::counter().fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+#endif
@@ -0,0 +1,295 @@
+/*
+    Latency_Harness Class, step latency and jitter of a discrete system at a fixed period
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LATENCY_HARNESS_H
+#define LATENCY_HARNESS_H
+
+/*! \file Latency_Harness.h
+    \brief Step latency and jitter of a discrete system run at a fixed period
+
+    It uses Allocation_Counter to flag the steps that allocate: include Allocation_Counter.h in the executable.
+*/
+
+#include "Allocation_Counter.h"
+#include <sun_systems_lib/Discrete_System_Interface.h>
+#include "boost/function.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace sun
+{
+//! Input generator of the harness: f(k, u_k), writes the input u(k)
+typedef boost::function<void(std::size_t, TooN::Vector<>&)> LATENCY_INPUT_FCN;
+
+//!  Latency_Harness class: runs a Discrete_System_Interface at a fixed period and records the latency of each step.
+/*!
+    Each period the harness waits the absolute deadline t0 + k*period on the steady clock, then times
+
+    \verbatim
+    input_fcn(k, u_k);
+    system.apply_into(u_k, y_k);
+    \endverbatim
+
+    The latency of each step and the wake up jitter (start - deadline) are kept (the buffers are allocated before
+    the run), the report gives the percentiles p50/p99/p99.9/max and a log2 histogram.
+    The steps that allocate memory (global operator new) or throw are flagged, a thrown exception does not stop the
+    run.
+
+    The calling thread can be pinned to a CPU and moved to the SCHED_FIFO policy (Linux only).
+*/
+class Latency_Harness
+{
+public:
+  //! A flagged step
+  struct Flagged_Step
+  {
+    std::size_t step;
+    double latency_ns;
+    unsigned long allocations;
+    std::string error;
+  };
+
+  //! Result of a run
+  struct Report
+  {
+    std::size_t num_steps = 0;
+    double period_ns = 0.0;
+    //! Latency of each step [ns]
+    std::vector<double> latency_ns;
+    //! Wake up jitter of each step [ns]
+    std::vector<double> jitter_ns;
+    //! Steps that allocated or threw
+    std::vector<Flagged_Step> flagged;
+    //! Number of steps that allocated
+    std::size_t num_allocating_steps = 0;
+    //! Number of steps that threw
+    std::size_t num_throwing_steps = 0;
+    //! Number of steps that ended after the next deadline
+    std::size_t num_overruns = 0;
+  };
+
+private:
+  Latency_Harness();
+
+public:
+  //! Pin the calling thread to a cpu, optionally with the SCHED_FIFO policy
+  /*!
+    \return false if not supported or not permitted (e.g. SCHED_FIFO needs CAP_SYS_NICE)
+  */
+  static bool pinThread(int cpu, int fifo_priority = 0)
+  {
+#ifdef __linux__
+    bool ok = true;
+    if (cpu >= 0)
+    {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      ok = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 && ok;
+    }
+    if (fifo_priority > 0)
+    {
+      sched_param param;
+      param.sched_priority = fifo_priority;
+      ok = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0 && ok;
+    }
+    return ok;
+#else
+    return cpu < 0 && fifo_priority <= 0;
+#endif
+  }
+
+  //! Run the system at a fixed period
+  /*!
+    \param system the system under test
+    \param input_fcn input generator f(k, u_k)
+    \param num_steps number of steps
+    \param period_ns period [ns], 0 = back to back steps (no wait)
+    \param max_flagged maximum number of flagged steps kept in the report (all are counted)
+  */
+  static Report run(Discrete_System_Interface& system, const LATENCY_INPUT_FCN& input_fcn, std::size_t num_steps,
+                    double period_ns, std::size_t max_flagged = 100)
+  {
+    typedef std::chrono::steady_clock Clock;
+
+    Report report;
+    report.num_steps = num_steps;
+    report.period_ns = period_ns;
+    report.latency_ns.assign(num_steps, 0.0);
+    report.jitter_ns.assign(num_steps, 0.0);
+    report.flagged.reserve(max_flagged);
+    TooN::Vector<> u_k(TooN::Zeros(system.getSizeInput()));
+    TooN::Vector<> y_k(TooN::Zeros(system.getSizeOutput()));
+
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double, std::nano>(period_ns));
+    const Clock::time_point t0 = Clock::now() + period;
+
+    for (std::size_t k = 0; k < num_steps; k++)
+    {
+      const Clock::time_point deadline = t0 + period * k;
+      if (period_ns > 0.0)
+      {
+        std::this_thread::sleep_until(deadline);
+      }
+
+      const unsigned long allocs_before = Allocation_Counter::get();
+      const Clock::time_point start = Clock::now();
+      std::exception_ptr error;
+      try
+      {
+        input_fcn(k, u_k);
+        system.apply_into(u_k, y_k);
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+      }
+      const Clock::time_point end = Clock::now();
+      const unsigned long allocs = Allocation_Counter::get() - allocs_before;
+
+      report.latency_ns[k] = std::chrono::duration<double, std::nano>(end - start).count();
+      report.jitter_ns[k] = (period_ns > 0.0) ? std::chrono::duration<double, std::nano>(start - deadline).count() : 0.0;
+      if (period_ns > 0.0 && end > deadline + period)
+      {
+        report.num_overruns++;
+      }
+      if (allocs != 0)
+      {
+        report.num_allocating_steps++;
+      }
+      if (error)
+      {
+        report.num_throwing_steps++;
+      }
+      if ((allocs != 0 || error) && report.flagged.size() < max_flagged)
+      {
+        Flagged_Step f;
+        f.step = k;
+        f.latency_ns = report.latency_ns[k];
+        f.allocations = allocs;
+        f.error = error ? errorMessage(error) : std::string();
+        report.flagged.push_back(f);
+      }
+    }
+    return report;
+  }
+
+  //! Message of a captured exception (outside of the measured window, it may allocate)
+  static std::string errorMessage(const std::exception_ptr& error)
+  {
+    try
+    {
+      std::rethrow_exception(error);
+    }
+    catch (const std::exception& e)
+    {
+      return e.what();
+    }
+    catch (...)
+    {
+      return "unknown exception";
+    }
+  }
+
+  //! Percentile p in [0, 100] of the samples (nearest rank)
+  static double percentile(std::vector<double> samples, double p)
+  {
+    if (samples.empty())
+    {
+      return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    std::size_t rank = (std::size_t)(p / 100.0 * samples.size());
+    if (rank >= samples.size())
+    {
+      rank = samples.size() - 1;
+    }
+    return samples[rank];
+  }
+
+  //! Print the report on the std out
+  static void print(const Report& report, const std::string& name)
+  {
+    std::printf("%s: %lu steps, period %.0f ns\n", name.c_str(), (unsigned long)report.num_steps, report.period_ns);
+    std::printf("  latency [ns]  p50 %10.0f  p99 %10.0f  p99.9 %10.0f  max %10.0f\n",
+                percentile(report.latency_ns, 50.0), percentile(report.latency_ns, 99.0),
+                percentile(report.latency_ns, 99.9), percentile(report.latency_ns, 100.0));
+    if (report.period_ns > 0.0)
+    {
+      std::printf("  jitter  [ns]  p50 %10.0f  p99 %10.0f  p99.9 %10.0f  max %10.0f  overruns %lu\n",
+                  percentile(report.jitter_ns, 50.0), percentile(report.jitter_ns, 99.0),
+                  percentile(report.jitter_ns, 99.9), percentile(report.jitter_ns, 100.0),
+                  (unsigned long)report.num_overruns);
+    }
+
+    // log2 histogram of the latency
+    std::vector<std::size_t> histogram(64, 0);
+    for (double l : report.latency_ns)
+    {
+      unsigned int bin = 0;
+      while (bin < 63 && (double)(1ull << (bin + 1)) <= l)
+      {
+        bin++;
+      }
+      histogram[bin]++;
+    }
+    std::printf("  histogram [ns]\n");
+    for (unsigned int bin = 0; bin < 64; bin++)
+    {
+      if (histogram[bin] != 0)
+      {
+        // the last bin is open ended, 1ull << 64 would be undefined
+        if (bin == 63)
+        {
+          std::printf("    [%10llu,        inf) %10lu\n", 1ull << bin, (unsigned long)histogram[bin]);
+        }
+        else
+        {
+          std::printf("    [%10llu, %10llu) %10lu\n", 1ull << bin, 1ull << (bin + 1), (unsigned long)histogram[bin]);
+        }
+      }
+    }
+
+    std::printf("  allocating steps %lu, throwing steps %lu\n", (unsigned long)report.num_allocating_steps,
+                (unsigned long)report.num_throwing_steps);
+    for (const Flagged_Step& f : report.flagged)
+    {
+      std::printf("    step %lu: %.0f ns, %lu allocations%s%s\n", (unsigned long)f.step, f.latency_ns, f.allocations,
+                  f.error.empty() ? "" : ", threw: ", f.error.c_str());
+    }
+  }
+};
+
+}  // namespace sun
+
+#endif
@@ -0,0 +1,556 @@
+/*
+    sun_systems_lib benchmark, ns/step and allocations/step of the system classes
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*! \file benchmark.cpp
+    \brief Microbenchmark of the system classes, JSON output and comparison against a saved baseline
+
+    \verbatim
+    sun_systems_lib_benchmark [--output results.json] [--baseline baseline.json] [--threshold 0.10]
+                              [--min-time 0.2] [--filter substring]
+    \endverbatim
+
+    --output      write the results as JSON (one result object per line)
+    --baseline    compare with a JSON file written by --output, the exit code is 1 if a case regressed
+    --threshold   relative ns/step increase that is a regression (default 0.10), any allocations/step increase
+                  is a regression
+    --min-time    seconds per measurement (default 0.2)
+    --filter      run only the cases whose name contains the substring
+*/
+
+#include "Allocation_Counter.h"
+
+#include <sun_systems_lib/TF/TF_SISO.h>
+#include <sun_systems_lib/TF/TF_MIMO.h>
+#include <sun_systems_lib/TF/TF_MIMO_DIAGONAL.h>
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <sun_systems_lib/SS/SS_LINEAR_SPARSE.h>
+#include <sun_systems_lib/SS/SS_LINEAR_Static.h>
+#include <sun_systems_lib/SS/SS.h>
+#include <sun_systems_lib/Continuous/Continuous_System.h>
+#include <sun_systems_lib/Discretization/RK4.h>
+#include <sun_systems_lib/Discretization/RK4_Template.h>
+#include <sun_systems_lib/Continuous/Continuous_System_Template.h>
+#include <sun_systems_lib/Observers/Luenberger_Observer.h>
+#include <sun_systems_lib/Observers/Kalman_Filter.h>
+#include <sun_systems_lib/Utils/Polynomial.h>
+#include <sun_systems_lib/Composition/Composition.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace sun;
+
+namespace
+{
+//! Result of a benchmark case
+struct Bench_Result
+{
+  std::string name;
+  double ns_per_step;
+  double allocs_per_step;
+  unsigned long steps;
+};
+
+//! Benchmark configuration
+struct Bench_Config
+{
+  double min_time = 0.2;
+  std::string filter;
+  std::string output;
+  std::string baseline;
+  double threshold = 0.10;
+};
+
+//! Number of precomputed inputs, the step k uses the input k % NUM_INPUTS
+const unsigned int NUM_INPUTS = 64;
+
+//! Sink of the outputs, it keeps the compiler from removing the steps
+volatile double g_sink = 0.0;
+
+std::mt19937 g_gen(42);
+
+//! Random matrix with entries in [-scale, scale]
+TooN::Matrix<> randomMatrix(int rows, int cols, double scale)
+{
+  std::uniform_real_distribution<double> dist(-scale, scale);
+  TooN::Matrix<> M(rows, cols);
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++)
+      M(i, j) = dist(g_gen);
+  return M;
+}
+
+//! NUM_INPUTS random input vectors of size n
+std::vector<TooN::Vector<>> randomInputs(int n)
+{
+  std::normal_distribution<double> dist;
+  std::vector<TooN::Vector<>> inputs;
+  for (unsigned int k = 0; k < NUM_INPUTS; k++)
+  {
+    TooN::Vector<> u(n);
+    for (int i = 0; i < n; i++)
+      u[i] = dist(g_gen);
+    inputs.push_back(u);
+  }
+  return inputs;
+}
+
+//! (1 - 0.5 z^-1)^order
+TooN::Vector<> stableDenominator(unsigned int order)
+{
+  if (order == 0)
+    return TooN::makeVector(1.0);
+  return Polynomial::multiply(stableDenominator(order - 1), TooN::makeVector(1.0, -0.5));
+}
+
+//! Stable random transfer function of order n, the poles are in 0.5
+TF_SISO randomTF(unsigned int order)
+{
+  const TooN::Vector<> den = stableDenominator(order);
+  TooN::Vector<> num(order + 1);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  for (unsigned int i = 0; i <= order; i++)
+    num[i] = dist(g_gen);
+  return TF_SISO(num, den);
+}
+
+//! Time per step of step(k), the median of 5 measurements of about min_time/5 seconds
+template <class Step_Fcn>
+Bench_Result measure(const std::string& name, Step_Fcn step, const Bench_Config& config)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  // Warm up and calibration
+  unsigned long k = 0;
+  for (; k < 100; k++)
+    step(k);
+  unsigned long batch = 16;
+  while (true)
+  {
+    const Clock::time_point t0 = Clock::now();
+    for (unsigned long i = 0; i < batch; i++, k++)
+      step(k);
+    const double elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    if (elapsed > config.min_time / 5.0 || batch > (1ul << 40))
+      break;
+    batch *= 2;
+  }
+
+  std::vector<double> ns;
+  ns.reserve(5);
+  const unsigned long allocs_before = Allocation_Counter::get();
+  for (int rep = 0; rep < 5; rep++)
+  {
+    const Clock::time_point t0 = Clock::now();
+    for (unsigned long i = 0; i < batch; i++, k++)
+      step(k);
+    ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / batch);
+  }
+  const unsigned long allocs = Allocation_Counter::get() - allocs_before;
+  std::sort(ns.begin(), ns.end());
+
+  Bench_Result res;
+  res.name = name;
+  res.ns_per_step = ns[ns.size() / 2];
+  res.allocs_per_step = double(allocs) / (5.0 * batch);
+  res.steps = 5 * batch;
+  return res;
+}
+
+//! Run a case if it matches the filter
+template <class Step_Fcn>
+void runCase(std::vector<Bench_Result>& results, const std::string& name, Step_Fcn step, const Bench_Config& config)
+{
+  if (!config.filter.empty() && name.find(config.filter) == std::string::npos)
+    return;
+  results.push_back(measure(name, step, config));
+  const Bench_Result& r = results.back();
+  std::printf("%-36s %12.1f ns/step %10.3f allocs/step\n", r.name.c_str(), r.ns_per_step, r.allocs_per_step);
+  std::fflush(stdout);
+}
+
+/*=============CASES===========================*/
+
+void benchTF(std::vector<Bench_Result>& results, const Bench_Config& config)
+{
+  const std::vector<TooN::Vector<>> u = randomInputs(1);
+  for (unsigned int order : { 1u, 2u, 4u, 8u, 16u, 32u })
+  {
+    TF_SISO tf = randomTF(order);
+    runCase(results, "TF_SISO/order=" + std::to_string(order),
+            [&](unsigned long k) { g_sink = tf.apply(u[k % NUM_INPUTS][0]); }, config);
+  }
+
+  for (unsigned int dim : { 2u, 4u, 8u })
+  {
+    TF_MIMO mimo(dim, dim);
+    for (unsigned int i = 0; i < dim; i++)
+      for (unsigned int j = 0; j < dim; j++)
+        mimo.setSISO(i, j, randomTF(2));
+    const std::vector<TooN::Vector<>> u_d = randomInputs(dim);
+    runCase(results, "TF_MIMO/dim=" + std::to_string(dim),
+            [&](unsigned long k) { g_sink = mimo.apply(u_d[k % NUM_INPUTS])[0]; }, config);
+  }
+
+  for (unsigned int dim : { 2u, 8u, 32u })
+  {
+    TF_MIMO_DIAGONAL mimo(dim, randomTF(2));
+    const std::vector<TooN::Vector<>> u_d = randomInputs(dim);
+    runCase(results, "TF_MIMO_DIAGONAL/dim=" + std::to_string(dim),
+            [&](unsigned long k) { g_sink = mimo.apply(u_d[k % NUM_INPUTS])[0]; }, config);
+  }
+}
+
+//! SS_LINEAR_Static<N, 2, 2> case, same matrices of the SS_LINEAR/n=N case
+template <int N>
+void benchSSStatic(std::vector<Bench_Result>& results, const Bench_Config& config, const TooN::Matrix<>& A,
+                   const TooN::Matrix<>& B, const TooN::Matrix<>& C, const TooN::Matrix<>& D,
+                   const std::vector<TooN::Vector<>>& u)
+{
+  SS_LINEAR_Static<N, 2, 2> sys(A, B, C, D);
+  TooN::Vector<> y_k(2);
+  runCase(results, "SS_LINEAR_Static/n=" + std::to_string(N), [&](unsigned long k) {
+    sys.apply_into(u[k % NUM_INPUTS], y_k);
+    g_sink = y_k[0];
+  }, config);
+}
+
+void benchSS(std::vector<Bench_Result>& results, const Bench_Config& config)
+{
+  const int m = 2, p = 2;
+  const std::vector<TooN::Vector<>> u = randomInputs(m);
+  const std::vector<TooN::Vector<>> y = randomInputs(p);
+  for (int n : { 2, 8, 32 })
+  {
+    const std::string dim = "/n=" + std::to_string(n);
+    const TooN::Matrix<> A = randomMatrix(n, n, 0.9 / n), B = randomMatrix(n, m, 1.0);
+    const TooN::Matrix<> C = randomMatrix(p, n, 1.0), D = randomMatrix(p, m, 1.0);
+    const SS_LINEAR ss_linear(A, B, C, D);
+
+    {
+      SS_LINEAR sys(ss_linear);
+      TooN::Vector<> y_k(p);
+      runCase(results, "SS_LINEAR" + dim, [&](unsigned long k) {
+        sys.apply_into(u[k % NUM_INPUTS], y_k);
+        g_sink = y_k[0];
+      }, config);
+    }
+
+    if (n == 2)
+      benchSSStatic<2>(results, config, A, B, C, D, u);
+    else if (n == 8)
+      benchSSStatic<8>(results, config, A, B, C, D, u);
+
+    {
+      SS sys(n, p, m, [A, B](const TooN::Vector<>& x, const TooN::Vector<>& u_k) -> TooN::Vector<> { return A * x + B * u_k; },
+             [C, D](const TooN::Vector<>& x, const TooN::Vector<>& u_k) -> TooN::Vector<> { return C * x + D * u_k; });
+      TooN::Vector<> y_k(p);
+      runCase(results, "SS" + dim, [&](unsigned long k) {
+        sys.apply_into(u[k % NUM_INPUTS], y_k);
+        g_sink = y_k[0];
+      }, config);
+    }
+
+    {
+      // x_dot = (A - I) x + B u, allocation free functors
+      TooN::Matrix<> Ac = A;
+      for (int i = 0; i < n; i++)
+        Ac(i, i) -= 1.0;
+      Continuous_System cs(n, p, m, [Ac, B](const TooN::Vector<>& x, const TooN::Vector<>& u_k) -> TooN::Vector<> { return Ac * x + B * u_k; },
+                           [C, D](const TooN::Vector<>& x, const TooN::Vector<>& u_k) -> TooN::Vector<> { return C * x + D * u_k; });
+      cs.setFcnsInto(
+          [Ac, B](const TooN::Vector<>& x, const TooN::Vector<>& u_k, TooN::Vector<>& x_dot) {
+            Dense_Kernels::multiply(Ac, x, x_dot);
+            Dense_Kernels::multiplyAdd(B, u_k, x_dot);
+          },
+          [C, D](const TooN::Vector<>& x, const TooN::Vector<>& u_k, TooN::Vector<>& y_k) {
+            Dense_Kernels::multiply(C, x, y_k);
+            Dense_Kernels::multiplyAdd(D, u_k, y_k);
+          });
+      RK4 sys(cs, 0.001);
+      TooN::Vector<> y_k(p);
+      runCase(results, "RK4" + dim, [&](unsigned long k) {
+        sys.apply_into(u[k % NUM_INPUTS], y_k);
+        g_sink = y_k[0];
+      }, config);
+    }
+
+    {
+      // Same system with the functors inlined in the integrator
+      TooN::Matrix<> Ac = A;
+      for (int i = 0; i < n; i++)
+        Ac(i, i) -= 1.0;
+      auto cs = makeContinuousSystem(
+          n, p, m,
+          [Ac, B](const TooN::Vector<>& x, const TooN::Vector<>& u_k, TooN::Vector<>& x_dot) {
+            Dense_Kernels::multiply(Ac, x, x_dot);
+            Dense_Kernels::multiplyAdd(B, u_k, x_dot);
+          },
+          [C, D](const TooN::Vector<>& x, const TooN::Vector<>& u_k, TooN::Vector<>& y_k) {
+            Dense_Kernels::multiply(C, x, y_k);
+            Dense_Kernels::multiplyAdd(D, u_k, y_k);
+          });
+      auto sys = makeRK4(cs, 0.001);
+      TooN::Vector<> y_k(p);
+      runCase(results, "RK4_Template" + dim, [&](unsigned long k) {
+        sys.apply_into(u[k % NUM_INPUTS], y_k);
+        g_sink = y_k[0];
+      }, config);
+    }
+
+    {
+      Luenberger_Observer obs(ss_linear, randomMatrix(n, p, 0.1));
+      runCase(results, "Luenberger_Observer" + dim, [&](unsigned long k) {
+        g_sink = obs.obs_apply(u[k % NUM_INPUTS], y[k % NUM_INPUTS])[0];
+      }, config);
+    }
+
+    {
+      TooN::Matrix<> W = TooN::Zeros(n, n), V = TooN::Zeros(p, p);
+      for (int i = 0; i < n; i++)
+        W(i, i) = 1e-3;
+      for (int i = 0; i < p; i++)
+        V(i, i) = 1e-2;
+      Kalman_Filter kf(ss_linear, W, V);
+      runCase(results, "Kalman_Filter" + dim, [&](unsigned long k) {
+        g_sink = kf.obs_apply(u[k % NUM_INPUTS], y[k % NUM_INPUTS])[0];
+      }, config);
+    }
+  }
+
+  // Banded (sparse) plant, dense vs CSR storage
+  for (int n : { 128, 512 })
+  {
+    const std::string dim = "/n=" + std::to_string(n);
+    TooN::Matrix<> A = TooN::Zeros(n, n);
+    for (int i = 0; i < n; i++)
+      for (int j = std::max(0, i - 2); j <= std::min(n - 1, i + 2); j++)
+        A(i, j) = 0.9 / 5.0;
+    const TooN::Matrix<> B = randomMatrix(n, m, 1.0), C = randomMatrix(p, n, 1.0), D = randomMatrix(p, m, 1.0);
+
+    {
+      SS_LINEAR sys(A, B, C, D);
+      TooN::Vector<> y_k(p);
+      runCase(results, "SS_LINEAR/banded" + dim, [&](unsigned long k) {
+        sys.apply_into(u[k % NUM_INPUTS], y_k);
+        g_sink = y_k[0];
+      }, config);
+    }
+
+    {
+      SS_LINEAR_SPARSE sys(A, B, C, D);
+      TooN::Vector<> y_k(p);
+      runCase(results, "SS_LINEAR_SPARSE/banded" + dim, [&](unsigned long k) {
+        sys.apply_into(u[k % NUM_INPUTS], y_k);
+        g_sink = y_k[0];
+      }, config);
+    }
+  }
+
+  // Series of two linear systems, chained vs fused in one SS_LINEAR
+  for (int n : { 2, 8 })
+  {
+    const std::string dim = "/n=" + std::to_string(n);
+    const SS_LINEAR sys1(randomMatrix(n, n, 0.9 / n), randomMatrix(n, m, 1.0), randomMatrix(p, n, 1.0),
+                         randomMatrix(p, m, 1.0));
+    const SS_LINEAR sys2(randomMatrix(n, n, 0.9 / n), randomMatrix(n, p, 1.0), randomMatrix(p, n, 1.0),
+                         randomMatrix(p, p, 1.0));
+
+    {
+      Composite_System sys(Composite_System::SERIES, sys1, sys2);
+      TooN::Vector<> y_k(p);
+      runCase(results, "Composite_System/series" + dim, [&](unsigned long k) {
+        sys.apply_into(u[k % NUM_INPUTS], y_k);
+        g_sink = y_k[0];
+      }, config);
+    }
+
+    {
+      SS_LINEAR sys = Composition::series(sys1, sys2);
+      TooN::Vector<> y_k(p);
+      runCase(results, "Composition::series" + dim, [&](unsigned long k) {
+        sys.apply_into(u[k % NUM_INPUTS], y_k);
+        g_sink = y_k[0];
+      }, config);
+    }
+  }
+}
+
+/*=============JSON===========================*/
+
+void writeJSON(const std::string& file, const std::vector<Bench_Result>& results)
+{
+  std::ofstream out(file.c_str());
+  if (!out)
+  {
+    throw std::runtime_error("[benchmark] Unable to write " + file);
+  }
+  out << "{\n  \"benchmark\": \"sun_systems_lib\",\n  \"results\": [\n";
+  char line[512];
+  for (std::size_t i = 0; i < results.size(); i++)
+  {
+    std::snprintf(line, sizeof(line),
+                  "    {\"name\": \"%s\", \"ns_per_step\": %.3f, \"allocs_per_step\": %.6f, \"steps\": %lu}%s\n",
+                  results[i].name.c_str(), results[i].ns_per_step, results[i].allocs_per_step, results[i].steps,
+                  (i + 1 < results.size()) ? "," : "");
+    out << line;
+  }
+  out << "  ]\n}\n";
+}
+
+//! INTERNAL number after "key": in line
+bool parseNumber(const std::string& line, const std::string& key, double& value)
+{
+  const std::string pattern = "\"" + key + "\":";
+  const std::size_t pos = line.find(pattern);
+  if (pos == std::string::npos)
+    return false;
+  value = std::strtod(line.c_str() + pos + pattern.size(), NULL);
+  return true;
+}
+
+//! Read a file written by writeJSON()
+std::map<std::string, Bench_Result> readJSON(const std::string& file)
+{
+  std::ifstream in(file.c_str());
+  if (!in)
+  {
+    throw std::runtime_error("[benchmark] Unable to read " + file);
+  }
+  std::map<std::string, Bench_Result> results;
+  std::string line;
+  while (std::getline(in, line))
+  {
+    const std::string pattern = "\"name\": \"";
+    const std::size_t pos = line.find(pattern);
+    if (pos == std::string::npos)
+      continue;
+    const std::size_t end = line.find('"', pos + pattern.size());
+    Bench_Result r;
+    r.name = line.substr(pos + pattern.size(), end - pos - pattern.size());
+    double steps = 0.0;
+    if (!parseNumber(line, "ns_per_step", r.ns_per_step) || !parseNumber(line, "allocs_per_step", r.allocs_per_step))
+    {
+      throw std::runtime_error("[benchmark] Invalid result in " + file + ": " + line);
+    }
+    parseNumber(line, "steps", steps);
+    r.steps = steps;
+    results[r.name] = r;
+  }
+  return results;
+}
+
+//! Compare with the baseline, return the number of regressions
+int compare(const std::vector<Bench_Result>& results, const std::map<std::string, Bench_Result>& baseline,
+            double threshold)
+{
+  int regressions = 0;
+  std::printf("\n%-36s %12s %12s %8s %s\n", "case", "base ns", "ns", "ratio", "");
+  for (const Bench_Result& r : results)
+  {
+    std::map<std::string, Bench_Result>::const_iterator it = baseline.find(r.name);
+    if (it == baseline.end())
+    {
+      std::printf("%-36s %12s %12.1f %8s NEW\n", r.name.c_str(), "-", r.ns_per_step, "-");
+      continue;
+    }
+    const Bench_Result& b = it->second;
+    const double ratio = r.ns_per_step / b.ns_per_step;
+    const bool slower = ratio > 1.0 + threshold;
+    const bool more_allocs = r.allocs_per_step > b.allocs_per_step + 1e-9;
+    const char* status = (slower || more_allocs) ? (more_allocs ? "REGRESSION (allocs)" : "REGRESSION") :
+                                                   (ratio < 1.0 - threshold ? "faster" : "ok");
+    std::printf("%-36s %12.1f %12.1f %8.3f %s\n", r.name.c_str(), b.ns_per_step, r.ns_per_step, ratio, status);
+    if (slower || more_allocs)
+      regressions++;
+  }
+  return regressions;
+}
+
+void usage(const char* name)
+{
+  std::printf("usage: %s [--output results.json] [--baseline baseline.json] [--threshold 0.10] [--min-time 0.2] "
+              "[--filter substring]\n",
+              name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  Bench_Config config;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "--output" && has_value)
+      config.output = argv[++i];
+    else if (arg == "--baseline" && has_value)
+      config.baseline = argv[++i];
+    else if (arg == "--threshold" && has_value)
+      config.threshold = std::atof(argv[++i]);
+    else if (arg == "--min-time" && has_value)
+      config.min_time = std::atof(argv[++i]);
+    else if (arg == "--filter" && has_value)
+      config.filter = argv[++i];
+    else
+    {
+      usage(argv[0]);
+      return (arg == "--help" || arg == "-h") ? 0 : 2;
+    }
+  }
+
+  try
+  {
+    std::map<std::string, Bench_Result> baseline;
+    if (!config.baseline.empty())
+      baseline = readJSON(config.baseline);
+
+    std::vector<Bench_Result> results;
+    benchTF(results, config);
+    benchSS(results, config);
+
+    if (!config.output.empty())
+      writeJSON(config.output, results);
+
+    if (!config.baseline.empty())
+    {
+      const int regressions = compare(results, baseline, config.threshold);
+      std::printf("\n%d regression(s)\n", regressions);
+      return regressions == 0 ? 0 : 1;
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+  return 0;
+}
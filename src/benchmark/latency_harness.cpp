@@ -0,0 +1,223 @@
+/*
+    sun_systems_lib latency harness, tail latency and jitter of a system at a fixed period
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*! \file latency_harness.cpp
+    \brief Run a system built by a factory at a fixed period and report the step latency distribution
+
+    \verbatim
+    sun_systems_lib_latency [--system kalman] [--n 8] [--steps 10000] [--period-us 1000] [--cpu 0] [--fifo 80]
+    sun_systems_lib_latency --list
+    \endverbatim
+
+    --system     name of the factory (see --list)
+    --n          state dimension / order of the system
+    --steps      number of steps
+    --period-us  period in microseconds (0 = back to back steps)
+    --cpu        pin the thread to the cpu (default -1 = no pinning)
+    --fifo       SCHED_FIFO priority (default 0 = not changed)
+
+    The exit code is 1 if some steps allocated or threw.
+*/
+
+#include "Allocation_Counter.h"
+#include "Latency_Harness.h"
+
+#include <sun_systems_lib/TF/TF_SISO.h>
+#include <sun_systems_lib/TF/TF_MIMO.h>
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <sun_systems_lib/Continuous/Continuous_System.h>
+#include <sun_systems_lib/Discretization/RK4.h>
+#include <sun_systems_lib/Observers/Luenberger_Observer.h>
+#include <sun_systems_lib/Observers/Kalman_Filter.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+
+using namespace sun;
+
+namespace
+{
+//! Factory of a system under test of dimension n
+typedef boost::function<Discrete_System_Interface*(unsigned int)> SYSTEM_FACTORY;
+
+//! Random matrix with entries in [-scale, scale]
+TooN::Matrix<> randomMatrix(int rows, int cols, double scale)
+{
+  static std::mt19937 gen(42);
+  std::uniform_real_distribution<double> dist(-scale, scale);
+  TooN::Matrix<> M(rows, cols);
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++)
+      M(i, j) = dist(gen);
+  return M;
+}
+
+//! Stable plant with 2 inputs and 2 outputs
+SS_LINEAR plant(unsigned int n)
+{
+  return SS_LINEAR(randomMatrix(n, n, 0.9 / n), randomMatrix(n, 2, 1.0), randomMatrix(2, n, 1.0),
+                   randomMatrix(2, 2, 1.0));
+}
+
+//! Continuous plant x_dot = (A - I) x + B u with allocation free functors
+Continuous_System continuousPlant(unsigned int n)
+{
+  TooN::Matrix<> A = randomMatrix(n, n, 0.9 / n);
+  for (unsigned int i = 0; i < n; i++)
+    A(i, i) -= 1.0;
+  const TooN::Matrix<> B = randomMatrix(n, 2, 1.0), C = randomMatrix(2, n, 1.0);
+  Continuous_System cs(n, 2, 2, [A, B](const TooN::Vector<>& x, const TooN::Vector<>& u) -> TooN::Vector<> { return A * x + B * u; },
+                       [C](const TooN::Vector<>& x, const TooN::Vector<>& u) -> TooN::Vector<> { return C * x; },
+                       [A](const TooN::Vector<>& x, const TooN::Vector<>& u) -> TooN::Matrix<> { return A; },
+                       [C](const TooN::Vector<>& x, const TooN::Vector<>& u) -> TooN::Matrix<> { return C; });
+  cs.setFcnsInto(
+      [A, B](const TooN::Vector<>& x, const TooN::Vector<>& u, TooN::Vector<>& x_dot) {
+        Dense_Kernels::multiply(A, x, x_dot);
+        Dense_Kernels::multiplyAdd(B, u, x_dot);
+      },
+      [C](const TooN::Vector<>& x, const TooN::Vector<>& u, TooN::Vector<>& y) { Dense_Kernels::multiply(C, x, y); });
+  return cs;
+}
+
+TooN::Matrix<> scaledIdentity(unsigned int n, double s)
+{
+  TooN::Matrix<> M = TooN::Zeros(n, n);
+  for (unsigned int i = 0; i < n; i++)
+    M(i, i) = s;
+  return M;
+}
+
+//! The available systems
+std::map<std::string, SYSTEM_FACTORY> factories()
+{
+  std::map<std::string, SYSTEM_FACTORY> f;
+  f["tf_siso"] = [](unsigned int n) -> Discrete_System_Interface* {
+    TooN::Vector<> num(n + 1), den(TooN::Zeros(n + 1));
+    for (unsigned int i = 0; i <= n; i++)
+      num[i] = 1.0 / (i + 1);
+    den[0] = 1.0;
+    den[1] = -0.5;
+    return new TF_SISO(num, den);
+  };
+  f["tf_mimo"] = [](unsigned int n) -> Discrete_System_Interface* {
+    TF_MIMO* mimo = new TF_MIMO(n, n);
+    for (unsigned int i = 0; i < n; i++)
+      for (unsigned int j = 0; j < n; j++)
+        mimo->setSISO(i, j, TF_SISO(TooN::makeVector(0.1 * (i + 1), 0.05 * (j + 1)), TooN::makeVector(1.0, -0.8)));
+    return mimo;
+  };
+  f["ss_linear"] = [](unsigned int n) -> Discrete_System_Interface* { return new SS_LINEAR(plant(n)); };
+  f["rk4"] = [](unsigned int n) -> Discrete_System_Interface* { return new RK4(continuousPlant(n), 0.001); };
+  f["luenberger"] = [](unsigned int n) -> Discrete_System_Interface* {
+    return new Luenberger_Observer(plant(n), randomMatrix(n, 2, 0.1));
+  };
+  f["kalman"] = [](unsigned int n) -> Discrete_System_Interface* {
+    return new Kalman_Filter(plant(n), scaledIdentity(n, 1e-3), scaledIdentity(2, 1e-2));
+  };
+  f["ekf_rk4"] = [](unsigned int n) -> Discrete_System_Interface* {
+    return new Kalman_Filter(RK4(continuousPlant(n), 0.001), scaledIdentity(n, 1e-3), scaledIdentity(2, 1e-2));
+  };
+  return f;
+}
+
+void usage(const char* name)
+{
+  std::cout << "usage: " << name
+            << " [--system kalman] [--n 8] [--steps 10000] [--period-us 1000] [--cpu -1] [--fifo 0] [--list]"
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  std::string system_name = "kalman";
+  unsigned int n = 8;
+  std::size_t steps = 10000;
+  double period_us = 1000.0;
+  int cpu = -1;
+  int fifo = 0;
+
+  const std::map<std::string, SYSTEM_FACTORY> f = factories();
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "--system" && has_value)
+      system_name = argv[++i];
+    else if (arg == "--n" && has_value)
+      n = std::atoi(argv[++i]);
+    else if (arg == "--steps" && has_value)
+      steps = std::strtoul(argv[++i], NULL, 10);
+    else if (arg == "--period-us" && has_value)
+      period_us = std::atof(argv[++i]);
+    else if (arg == "--cpu" && has_value)
+      cpu = std::atoi(argv[++i]);
+    else if (arg == "--fifo" && has_value)
+      fifo = std::atoi(argv[++i]);
+    else if (arg == "--list")
+    {
+      for (const auto& entry : f)
+        std::cout << entry.first << std::endl;
+      return 0;
+    }
+    else
+    {
+      usage(argv[0]);
+      return (arg == "--help" || arg == "-h") ? 0 : 2;
+    }
+  }
+
+  const std::map<std::string, SYSTEM_FACTORY>::const_iterator factory = f.find(system_name);
+  if (factory == f.end() || n == 0)
+  {
+    std::cerr << "unknown system " << system_name << " (see --list) or n = 0" << std::endl;
+    return 2;
+  }
+
+  try
+  {
+    Discrete_System_Interface_Ptr system(factory->second(n));
+    if (!Latency_Harness::pinThread(cpu, fifo))
+    {
+      std::cerr << "WARNING: unable to pin the thread (cpu " << cpu << ", fifo " << fifo << ")" << std::endl;
+    }
+
+    // Deterministic inputs without allocations
+    LATENCY_INPUT_FCN input = [](std::size_t k, TooN::Vector<>& u) {
+      for (int i = 0; i < u.size(); i++)
+        u[i] = std::sin(0.001 * k * (i + 1));
+    };
+
+    const Latency_Harness::Report report = Latency_Harness::run(*system, input, steps, 1000.0 * period_us);
+    Latency_Harness::print(report, system_name + "/n=" + std::to_string(n));
+    return (report.num_allocating_steps == 0 && report.num_throwing_steps == 0) ? 0 : 1;
+  }
+  catch (const std::exception& e)
+  {
+    std::cerr << e.what() << std::endl;
+    return 2;
+  }
+}
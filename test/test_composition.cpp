@@ -0,0 +1,139 @@
+/*
+    Tests of Composition, feedback of linear and generic systems
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+#include <sun_systems_lib/Composition/Composition.h>
+#include <sun_systems_lib/SS/SS.h>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+const double REL_TOL = 1e-12;
+
+double testInput(int k)
+{
+  return std::sin(0.2 * k) + 0.3 * std::cos(0.7 * k);
+}
+
+//! Free response (zero input) and feedthrough gain of the next step of a SISO linear system
+void nextStepResponse(const sun::TF_SISO& sys, double& free_response, double& gain)
+{
+  sun::TF_SISO probe_zero(sys), probe_one(sys);
+  free_response = probe_zero.apply(0.0);
+  gain = probe_one.apply(1.0) - free_response;
+}
+
+sun::SS nonlinearSystem()
+{
+  return sun::SS(
+      1, 1, 1,
+      [](const TooN::Vector<>& x, const TooN::Vector<>& u) {
+        return TooN::Vector<>(TooN::makeVector(0.5 * std::sin(x[0]) + u[0]));
+      },
+      [](const TooN::Vector<>& x, const TooN::Vector<>& u) { return TooN::Vector<>(TooN::makeVector(x[0] * x[0])); });
+}
+}  // namespace
+
+// The fused loop is compared with a reference that solves the algebraic loop at each step, u1 = u + sign*y2:
+// y1 = f1 + g1*u1, y2 = f2 + g2*y1  =>  u1 = (u + sign*(f2 + g2*f1)) / (1 - sign*g2*g1)
+TEST(Composition, FeedbackOfLinearSystemsIsTheExactLoop)
+{
+  // feedthrough on both paths
+  sun::TF_SISO fwd(TooN::makeVector(0.5, 0.2, -0.1), TooN::makeVector(1.0, -0.3, 0.1));
+  sun::TF_SISO bwd(TooN::makeVector(0.4, 0.1), TooN::makeVector(1.0, -0.4));
+
+  for (double sign : { -1.0, 1.0 })
+  {
+    sun::Discrete_System_Interface_Ptr loop = sun::Composition::makeFeedback(fwd, bwd, sign);
+    ASSERT_NE(dynamic_cast<sun::SS_LINEAR*>(loop.get()), nullptr);
+
+    sun::TF_SISO ref_fwd(fwd), ref_bwd(bwd);
+    for (int k = 0; k < 100; k++)
+    {
+      const double u = testInput(k);
+      double f1, g1, f2, g2;
+      nextStepResponse(ref_fwd, f1, g1);
+      nextStepResponse(ref_bwd, f2, g2);
+      const double u1 = (u + sign * (f2 + g2 * f1)) / (1.0 - sign * g2 * g1);
+      const double y1 = ref_fwd.apply(u1);
+      ref_bwd.apply(y1);
+
+      const double y = loop->apply(TooN::makeVector(u))[0];
+      EXPECT_NEAR(y, y1, REL_TOL * (1.0 + std::fabs(y1))) << "sign " << sign << " step " << k;
+    }
+  }
+}
+
+TEST(Composition, SeriesAndParallelOfLinearSystems)
+{
+  sun::TF_SISO sys1(TooN::makeVector(0.5, 0.2, -0.1), TooN::makeVector(1.0, -0.3, 0.1));
+  sun::TF_SISO sys2(TooN::makeVector(0.4, 0.1), TooN::makeVector(1.0, -0.4));
+
+  sun::Discrete_System_Interface_Ptr series = sun::Composition::makeSeries(sys1, sys2);
+  sun::Discrete_System_Interface_Ptr parallel = sun::Composition::makeParallel(sys1, sys2);
+  ASSERT_NE(dynamic_cast<sun::SS_LINEAR*>(series.get()), nullptr);
+  ASSERT_NE(dynamic_cast<sun::SS_LINEAR*>(parallel.get()), nullptr);
+
+  sun::TF_SISO series1(sys1), series2(sys2), parallel1(sys1), parallel2(sys2);
+  for (int k = 0; k < 100; k++)
+  {
+    const double u = testInput(k);
+    const double y_series = series2.apply(series1.apply(u));
+    const double y_parallel = parallel1.apply(u) + parallel2.apply(u);
+
+    EXPECT_NEAR(series->apply(TooN::makeVector(u))[0], y_series, REL_TOL * (1.0 + std::fabs(y_series))) << k;
+    EXPECT_NEAR(parallel->apply(TooN::makeVector(u))[0], y_parallel, REL_TOL * (1.0 + std::fabs(y_parallel))) << k;
+  }
+}
+
+TEST(Composition, FeedbackOfNonlinearSystemsThrows)
+{
+  sun::TF_SISO linear(TooN::makeVector(0.5, 0.2), TooN::makeVector(1.0, -0.3));
+  sun::SS nonlinear = nonlinearSystem();
+
+  EXPECT_THROW(sun::Composition::makeFeedback(linear, nonlinear), std::invalid_argument);
+  EXPECT_THROW(sun::Composition::makeFeedback(nonlinear, linear), std::invalid_argument);
+}
+
+// makeFeedbackDelayed() builds the delayed loop for any system, linear systems included
+TEST(Composition, DelayedFeedback)
+{
+  sun::TF_SISO fwd(TooN::makeVector(0.5, 0.2), TooN::makeVector(1.0, -0.3));
+  sun::TF_SISO bwd(TooN::makeVector(0.1), TooN::makeVector(1.0, -0.4));
+
+  sun::Discrete_System_Interface_Ptr loop = sun::Composition::makeFeedbackDelayed(fwd, bwd, -1.0);
+  ASSERT_NE(dynamic_cast<sun::Composite_System*>(loop.get()), nullptr);
+
+  sun::TF_SISO ref_fwd(fwd), ref_bwd(bwd);
+  double y2_prev = 0.0;
+  for (int k = 0; k < 50; k++)
+  {
+    const double u = std::sin(0.2 * k);
+    const double y1 = ref_fwd.apply(u - y2_prev);
+    y2_prev = ref_bwd.apply(y1);
+    EXPECT_DOUBLE_EQ(loop->apply(TooN::makeVector(u))[0], y1);
+  }
+
+  sun::SS nonlinear = nonlinearSystem();
+  sun::Discrete_System_Interface_Ptr nonlinear_loop = sun::Composition::makeFeedbackDelayed(fwd, nonlinear);
+  EXPECT_NE(dynamic_cast<sun::Composite_System*>(nonlinear_loop.get()), nullptr);
+}
@@ -0,0 +1,115 @@
+/*
+    Tests of Ensemble_Runner, results independent of the threads and exceptions
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <sun_systems_lib/Utils/Ensemble_Runner.h>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+const unsigned int NUM_INSTANCES = 37;
+const std::size_t NUM_STEPS = 200;
+
+sun::SS_LINEAR prototype()
+{
+  TooN::Matrix<> A = TooN::Zeros(3, 3), B = TooN::Zeros(3, 2), C = TooN::Zeros(2, 3), D = TooN::Zeros(2, 2);
+  A(0, 0) = 0.9;
+  A(0, 1) = 0.2;
+  A(1, 1) = 0.7;
+  A(2, 0) = -0.3;
+  A(2, 2) = 0.5;
+  B(0, 0) = 1.0;
+  B(1, 1) = 0.5;
+  B(2, 0) = 0.2;
+  C(0, 0) = 1.0;
+  C(1, 2) = 2.0;
+  D(1, 0) = 0.1;
+  return sun::SS_LINEAR(A, B, C, D);
+}
+
+//! Runs the ensemble with num_threads threads: random inputs with one generator per instance, per instance sinks
+std::vector<std::vector<double>> runEnsemble(unsigned int num_threads, std::vector<TooN::Vector<>>& final_states)
+{
+  // perturbation: initial state depending on the instance
+  sun::Ensemble_Runner runner(prototype(), NUM_INSTANCES, [](unsigned int i, sun::Discrete_System_Interface& sys) {
+    dynamic_cast<sun::SS_Interface&>(sys).setState(TooN::makeVector(0.1 * i, -0.05 * i, 1.0));
+  });
+
+  std::vector<std::mt19937> generators;
+  for (unsigned int i = 0; i < NUM_INSTANCES; i++)
+    generators.push_back(std::mt19937(1000 + i));
+  std::vector<std::vector<double>> outputs(NUM_INSTANCES, std::vector<double>(2 * NUM_STEPS));
+
+  runner.run(
+      NUM_STEPS,
+      [&generators](unsigned int i, std::size_t, TooN::Vector<>& u_k) {
+        std::normal_distribution<double> dist;
+        u_k[0] = dist(generators[i]);
+        u_k[1] = dist(generators[i]);
+      },
+      [&outputs](unsigned int i, std::size_t k, const TooN::Vector<>& y_k) {
+        outputs[i][2 * k] = y_k[0];
+        outputs[i][2 * k + 1] = y_k[1];
+      },
+      num_threads);
+
+  final_states.clear();
+  for (unsigned int i = 0; i < NUM_INSTANCES; i++)
+    final_states.push_back(dynamic_cast<const sun::SS_Interface&>(runner.getInstance(i)).getState());
+  return outputs;
+}
+}  // namespace
+
+// Same outputs and final states (bit by bit) with 1 thread and with more threads than cores
+TEST(Ensemble_Runner, ResultsDoNotDependOnTheThreads)
+{
+  std::vector<TooN::Vector<>> states_ref, states;
+  const std::vector<std::vector<double>> outputs_ref = runEnsemble(1, states_ref);
+  for (unsigned int num_threads : { 2u, 4u, 8u })
+  {
+    const std::vector<std::vector<double>> outputs = runEnsemble(num_threads, states);
+    for (unsigned int i = 0; i < NUM_INSTANCES; i++)
+    {
+      EXPECT_EQ(outputs[i], outputs_ref[i]) << "threads " << num_threads << " instance " << i;
+      for (int j = 0; j < states_ref[i].size(); j++)
+        EXPECT_EQ(states[i][j], states_ref[i][j]) << "threads " << num_threads << " instance " << i;
+    }
+  }
+}
+
+// An exception of the input generator reaches the caller, the other tasks are cancelled
+TEST(Ensemble_Runner, GeneratorExceptionPropagates)
+{
+  sun::Ensemble_Runner runner(prototype(), NUM_INSTANCES);
+  const auto throwing_input = [](unsigned int i, std::size_t k, TooN::Vector<>& u_k) {
+    if (i == 23 && k == 17)
+      throw std::runtime_error("generator failure");
+    u_k = TooN::Zeros;
+  };
+  for (unsigned int num_threads : { 1u, 4u })
+  {
+    EXPECT_THROW(runner.run(NUM_STEPS, throwing_input, NULL, num_threads), std::runtime_error)
+        << "threads " << num_threads;
+  }
+}
@@ -0,0 +1,185 @@
+/*
+    Tests of SS_LINEAR, fused [A B; C D] kernel against the reference products
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+#include <sun_systems_lib/SS/SS_LINEAR.h>
+#include <sun_systems_lib/SS/SS_LINEAR_Static.h>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+//! Relative tolerance of the fused kernel w.r.t. the reference products
+const double REL_TOL = 1.0e-12;
+
+TooN::Matrix<> randomMatrix(int rows, int cols, double scale, std::mt19937& gen)
+{
+  std::uniform_real_distribution<double> dist(-scale, scale);
+  TooN::Matrix<> M(rows, cols);
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++)
+      M(i, j) = dist(gen);
+  return M;
+}
+
+//! |a - b| <= REL_TOL * max(1, |b|) on each element
+void expectRelNear(const TooN::Vector<>& a, const TooN::Vector<>& b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (int i = 0; i < a.size(); i++)
+  {
+    EXPECT_LE(std::fabs(a[i] - b[i]), REL_TOL * std::max(1.0, std::fabs(b[i]))) << "element " << i;
+  }
+}
+
+struct Dimensions
+{
+  int n, m, p;
+};
+
+//! Random stable system of dimensions d and a random input trajectory (one sample per row of U)
+struct Random_System
+{
+  std::mt19937 gen;
+  TooN::Matrix<> A, B, C, D, U;
+
+  Random_System(const Dimensions& d, int num_samples)
+    : gen(7 * d.n + d.m)
+    , A(randomMatrix(d.n, d.n, 0.9 / std::sqrt((double)d.n), gen))
+    , B(randomMatrix(d.n, d.m, 1.0, gen))
+    , C(randomMatrix(d.p, d.n, 1.0, gen))
+    , D(randomMatrix(d.p, d.m, 1.0, gen))
+    , U(randomMatrix(num_samples, d.m, 1.0, gen))
+  {
+  }
+};
+
+//! More than two chunks of simulate_block()
+const int NUM_SAMPLES = 600;
+
+class SS_LINEAR_Test : public ::testing::TestWithParam<Dimensions>
+{
+};
+
+}  // namespace
+
+// apply() and the *_fcn_into() functions against x(k) = A*x(k-1) + B*u(k), y(k) = C*x(k) + D*u(k)
+TEST_P(SS_LINEAR_Test, FusedKernelMatchesReference)
+{
+  const Dimensions d = GetParam();
+  const Random_System rs(d, NUM_SAMPLES);
+  sun::SS_LINEAR sys(rs.A, rs.B, rs.C, rs.D);
+  TooN::Vector<> x_ref = TooN::Zeros(d.n);
+  TooN::Vector<> x_k(d.n), y_k(d.p);
+  for (int k = 0; k < NUM_SAMPLES; k++)
+  {
+    const TooN::Vector<> u_k = rs.U[k];
+
+    sys.state_fcn_into(x_ref, u_k, x_k);
+    const TooN::Vector<> x_next = rs.A * x_ref + rs.B * u_k;
+    expectRelNear(x_k, x_next);
+    sys.output_fcn_into(x_next, u_k, y_k);
+    const TooN::Vector<> y_ref = rs.C * x_next + rs.D * u_k;
+    expectRelNear(y_k, y_ref);
+
+    expectRelNear(sys.apply(u_k), y_ref);
+    expectRelNear(sys.getState(), x_next);
+    x_ref = sys.getState();
+  }
+}
+
+// simulate_block() runs in chunks, it has to give the same values of apply()
+TEST_P(SS_LINEAR_Test, SimulateBlockMatchesApply)
+{
+  const Dimensions d = GetParam();
+  const Random_System rs(d, NUM_SAMPLES);
+  sun::SS_LINEAR sys(rs.A, rs.B, rs.C, rs.D), sys_block(rs.A, rs.B, rs.C, rs.D);
+  std::vector<double> U(NUM_SAMPLES * d.m), Y(NUM_SAMPLES * d.p);
+  for (int k = 0; k < NUM_SAMPLES; k++)
+    for (int j = 0; j < d.m; j++)
+      U[k * d.m + j] = rs.U(k, j);
+
+  sys_block.simulate_block(U.data(), Y.data(), NUM_SAMPLES);
+  for (int k = 0; k < NUM_SAMPLES; k++)
+  {
+    const TooN::Vector<>& y_k = sys.apply(rs.U[k]);
+    for (int i = 0; i < d.p; i++)
+      ASSERT_EQ(Y[k * d.p + i], y_k[i]) << "sample " << k << " element " << i;
+  }
+  for (int i = 0; i < d.n; i++)
+    EXPECT_EQ(sys_block.getState()[i], sys.getState()[i]);
+}
+
+// The const functions must not change the system
+TEST_P(SS_LINEAR_Test, ConstFunctionsKeepTheState)
+{
+  const Dimensions d = GetParam();
+  const Random_System rs(d, NUM_SAMPLES);
+  sun::SS_LINEAR sys(rs.A, rs.B, rs.C, rs.D);
+  sys.apply(rs.U[0]);
+  const TooN::Vector<> x = sys.getState();
+  TooN::Vector<> x_k(d.n), y_k(d.p);
+  sys.state_fcn_into(x, rs.U[1], x_k);
+  sys.output_fcn_into(x, rs.U[1], y_k);
+  for (int i = 0; i < d.n; i++)
+    EXPECT_EQ(sys.getState()[i], x[i]);
+  // the next step is the same of a system that did not call them
+  sun::SS_LINEAR sys_ref(rs.A, rs.B, rs.C, rs.D);
+  sys_ref.apply(rs.U[0]);
+  const TooN::Vector<> y_ref = sys_ref.apply(rs.U[1]);
+  const TooN::Vector<>& y = sys.apply(rs.U[1]);
+  for (int i = 0; i < d.p; i++)
+    EXPECT_EQ(y[i], y_ref[i]);
+}
+
+// Sizes below and above the 4 row register block and the 256 column cache block of the kernel
+INSTANTIATE_TEST_CASE_P(Sizes, SS_LINEAR_Test,
+                        ::testing::Values(Dimensions{ 1, 1, 1 }, Dimensions{ 2, 1, 1 }, Dimensions{ 8, 2, 2 },
+                                          Dimensions{ 33, 3, 5 }, Dimensions{ 300, 4, 6 }));
+
+// The raw data kernels do not check the sizes, apply() and advance() reject a wrong input size
+TEST(SS_LINEAR_Input, WrongInputSizeThrows)
+{
+  Random_System rs(Dimensions{ 3, 2, 1 }, 1);
+  sun::SS_LINEAR sys(rs.A, rs.B, rs.C, rs.D);
+  EXPECT_THROW(sys.apply(TooN::makeVector(1.0)), std::invalid_argument);
+  EXPECT_THROW(sys.apply(TooN::makeVector(1.0, 2.0, 3.0)), std::invalid_argument);
+  EXPECT_THROW(sys.advance(5, TooN::makeVector(1.0)), std::invalid_argument);
+  for (int i = 0; i < 3; i++)
+    EXPECT_EQ(sys.getState()[i], 0.0);
+}
+
+TEST(SS_LINEAR_Input, StaticWrongInputSizeThrows)
+{
+  TooN::Matrix<2, 2> A = TooN::Zeros;
+  A(0, 0) = 0.5;
+  A(1, 1) = 0.3;
+  TooN::Matrix<2, 1> B = TooN::Zeros;
+  B(0, 0) = 1.0;
+  TooN::Matrix<1, 2> C = TooN::Zeros;
+  C(0, 1) = 1.0;
+  const TooN::Matrix<1, 1> D = TooN::Zeros;
+  sun::SS_LINEAR_Static<2, 1, 1> sys(A, B, C, D);
+  EXPECT_THROW(sys.apply(TooN::makeVector(1.0, 2.0)), std::invalid_argument);
+  EXPECT_NO_THROW(sys.apply(TooN::makeVector(1.0)));
+}
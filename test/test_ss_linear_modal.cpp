@@ -0,0 +1,173 @@
+/*
+    Tests of SS_LINEAR_MODAL, modal form of matrices with repeated eigenvalues
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+#include <sun_systems_lib/SS/SS_LINEAR_MODAL.h>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+TooN::Matrix<> randomMatrix(int rows, int cols, std::mt19937& gen)
+{
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  TooN::Matrix<> M(rows, cols);
+  for (int i = 0; i < rows; i++)
+    for (int j = 0; j < cols; j++)
+      M(i, j) = dist(gen);
+  return M;
+}
+
+TooN::Matrix<> diagonal(const std::vector<double>& d)
+{
+  const int n = d.size();
+  TooN::Matrix<> A = TooN::Zeros(n, n);
+  for (int i = 0; i < n; i++)
+    A(i, i) = d[i];
+  return A;
+}
+
+//! S*A*S^-1 with a random well conditioned S
+TooN::Matrix<> randomSimilarity(const TooN::Matrix<>& A, std::mt19937& gen)
+{
+  const int n = A.num_rows();
+  TooN::Matrix<> S = randomMatrix(n, n, gen);
+  for (int i = 0; i < n; i++)
+    S(i, i) += n;
+  TooN::LU<> lu(S);
+  return S * A * lu.backsub(TooN::Matrix<>(TooN::Identity(n)));
+}
+
+//! Steps SS_LINEAR_MODAL and SS_LINEAR on the same random input, the outputs and the states have to match
+void expectSameOfSS_LINEAR(const TooN::Matrix<>& A)
+{
+  std::mt19937 gen(A.num_rows());
+  const int n = A.num_rows();
+  const TooN::Matrix<> B = randomMatrix(n, 2, gen), C = randomMatrix(3, n, gen), D = randomMatrix(3, 2, gen);
+  sun::SS_LINEAR_MODAL modal(A, B, C, D);
+  sun::SS_LINEAR ss(A, B, C, D);
+
+  const TooN::Matrix<> L = modal.getModalA();
+  const TooN::Matrix<> AT = A * modal.getT();
+  const TooN::Matrix<> TL = modal.getT() * L;
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      EXPECT_NEAR(AT(i, j), TL(i, j), 1e-9) << "A*T != T*L at " << i << "," << j;
+
+  for (int k = 0; k < 100; k++)
+  {
+    const TooN::Vector<> u = randomMatrix(1, 2, gen)[0];
+    const TooN::Vector<> y_modal = modal.apply(u);
+    const TooN::Vector<> y = ss.apply(u);
+    for (int i = 0; i < 3; i++)
+      EXPECT_NEAR(y_modal[i], y[i], 1e-9 * (1.0 + std::fabs(y[i])));
+  }
+  for (int i = 0; i < n; i++)
+    EXPECT_NEAR(modal.getState()[i], ss.getState()[i], 1e-9 * (1.0 + std::fabs(ss.getState()[i])));
+}
+
+}  // namespace
+
+// Real eigenvalues with multiplicity 3 and 5
+TEST(SS_LINEAR_MODAL_Test, RepeatedRealEigenvalues)
+{
+  expectSameOfSS_LINEAR(diagonal({ 1.0, 1.0, 1.0, 0.5, 0.5, 0.5, 0.5, 0.5 }));
+  expectSameOfSS_LINEAR(diagonal({ 0.0, 0.1, 0.0, 0.1, 0.0, 0.1 }));
+  std::mt19937 gen(1);
+  expectSameOfSS_LINEAR(randomSimilarity(diagonal({ 0.9, 0.9, 0.9, -0.3, -0.3, 0.2 }), gen));
+}
+
+// Complex pair with multiplicity 3, a repeated real eigenvalue and a simple one
+TEST(SS_LINEAR_MODAL_Test, RepeatedComplexEigenvalues)
+{
+  const double a = 0.6, b = 0.7;
+  TooN::Matrix<> A = TooN::Zeros(8, 8);
+  for (int i = 0; i < 6; i += 2)
+  {
+    A(i, i) = A(i + 1, i + 1) = a;
+    A(i, i + 1) = b;
+    A(i + 1, i) = -b;
+  }
+  A(6, 6) = A(7, 7) = -0.4;
+  expectSameOfSS_LINEAR(A);
+  std::mt19937 gen(2);
+  expectSameOfSS_LINEAR(randomSimilarity(A, gen));
+}
+
+// A Jordan block is not diagonalizable
+TEST(SS_LINEAR_MODAL_Test, DefectiveEigenvalueThrows)
+{
+  TooN::Matrix<> A = diagonal({ 0.5, 0.5, 0.5, 0.2 });
+  A(0, 1) = 1.0;
+  const TooN::Matrix<> B = TooN::Zeros(4, 1), C = TooN::Zeros(1, 4), D = TooN::Zeros(1, 1);
+  EXPECT_THROW(sun::SS_LINEAR_MODAL(A, B, C, D), std::runtime_error);
+}
+
+// getState() is the physical state after apply(), simulate_block(), setState() and reset()
+TEST(SS_LINEAR_MODAL_Test, PhysicalStateIsUpdated)
+{
+  std::mt19937 gen(3);
+  const TooN::Matrix<> A = randomSimilarity(diagonal({ 0.9, 0.5, 0.5, -0.2 }), gen);
+  const TooN::Matrix<> B = randomMatrix(4, 1, gen), C = randomMatrix(1, 4, gen), D = randomMatrix(1, 1, gen);
+  sun::SS_LINEAR_MODAL modal(A, B, C, D);
+  sun::SS_LINEAR ss(A, B, C, D);
+
+  std::vector<double> U(50), Y(50);
+  for (std::size_t k = 0; k < U.size(); k++)
+    U[k] = std::sin(0.3 * k);
+  modal.simulate_block(U.data(), Y.data(), U.size());
+  ss.simulate_block(U.data(), Y.data(), U.size());
+  for (int i = 0; i < 4; i++)
+    EXPECT_NEAR(modal.getState()[i], ss.getState()[i], 1e-9);
+
+  const TooN::Vector<> x = randomMatrix(1, 4, gen)[0];
+  modal.setState(x);
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(modal.getState()[i], x[i]);
+
+  modal.reset();
+  for (int i = 0; i < 4; i++)
+    EXPECT_EQ(modal.getState()[i], 0.0);
+
+  // the physical state is computed lazily, it is read after some steps only
+  ss.reset();
+  for (int k = 0; k < 10; k++)
+  {
+    const TooN::Vector<> u = TooN::makeVector(std::cos(0.2 * k));
+    modal.apply(u);
+    ss.apply(u);
+    if (k % 3 != 0)
+      continue;
+    for (int i = 0; i < 4; i++)
+      EXPECT_NEAR(modal.getState()[i], ss.getState()[i], 1e-9) << "step " << k;
+  }
+}
+
+TEST(SS_LINEAR_MODAL_Test, WrongInputSizeThrows)
+{
+  std::mt19937 gen(5);
+  const TooN::Matrix<> A = diagonal({ 0.9, 0.5, -0.2 });
+  sun::SS_LINEAR_MODAL modal(A, randomMatrix(3, 2, gen), randomMatrix(1, 3, gen), randomMatrix(1, 2, gen));
+  EXPECT_THROW(modal.apply(TooN::makeVector(1.0)), std::invalid_argument);
+  EXPECT_THROW(modal.apply(TooN::makeVector(1.0, 2.0, 3.0)), std::invalid_argument);
+}
@@ -0,0 +1,68 @@
+/*
+    Tests of TF_MIMO, state of the elements run by the banks
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+#include <sun_systems_lib/TF/TF_MIMO.h>
+#include <cmath>
+
+namespace
+{
+double testInput(int k, int j)
+{
+  return std::sin(0.3 * k + j) + 0.1 * j;
+}
+}  // namespace
+
+// The ZERO elements are not summed, but their input history has to follow the inputs
+TEST(TF_MIMO, ZeroElementsKeepTheInputHistory)
+{
+  sun::TF_SISO zero(TooN::makeVector(0.0, 0.0, 0.0), TooN::makeVector(1.0));
+  sun::TF_SISO filter(TooN::makeVector(0.2, 0.3), TooN::makeVector(1.0, -0.5));
+
+  sun::TF_MIMO mimo(2, 2);
+  mimo.setSISO(0, 0, zero);
+  mimo.setSISO(0, 1, filter);
+  mimo.setSISO(1, 0, filter);
+  mimo.setSISO(1, 1, zero);
+
+  sun::TF_SISO ref_zero(zero), ref_filter_0(filter), ref_filter_1(filter);
+  for (int k = 0; k < 20; k++)
+  {
+    const TooN::Vector<> u = TooN::makeVector(testInput(k, 0), testInput(k, 1));
+    const TooN::Vector<> y = mimo.apply(u);
+    ref_zero.apply(u[0]);
+    EXPECT_EQ(y[0], ref_filter_1.apply(u[1]));
+    EXPECT_EQ(y[1], ref_filter_0.apply(u[0]));
+
+    // the state is read at different steps, the history is rebuilt from the inputs stored after the last read
+    if (k % 4 == 1)
+    {
+      continue;
+    }
+    const TooN::Vector<> expected = ref_zero.getInputHistory();
+    const TooN::Vector<> history = static_cast<const sun::TF_SISO&>(mimo.getSISO(0, 0)).getInputHistory();
+    ASSERT_EQ(history.size(), expected.size());
+    for (int i = 0; i < expected.size(); i++)
+    {
+      EXPECT_EQ(history[i], expected[i]);
+    }
+  }
+}
@@ -0,0 +1,72 @@
+/*
+    Tests of TF_SISO, FFT block mode
+
+    Copyright 2021 Università della Campania Luigi Vanvitelli
+
+    Author: Marco Costanzo <marco.costanzo@unicampania.it>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <gtest/gtest.h>
+#include <sun_systems_lib/TF/TF_SISO.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+const double ABS_TOL = 1e-10;
+
+TooN::Vector<> randomTaps(int num_taps, std::mt19937& gen)
+{
+  std::normal_distribution<double> dist;
+  TooN::Vector<> b(num_taps);
+  for (int i = 0; i < num_taps; i++)
+    b[i] = dist(gen) / std::sqrt(num_taps);
+  return b;
+}
+}  // namespace
+
+// apply_block() in FFT block mode with out == in, compared with apply(double), then the step after the blocks
+TEST(TF_SISO, FFTBlockModeInPlace)
+{
+  std::mt19937 gen(11);
+  std::normal_distribution<double> dist;
+  for (int num_taps : { 1, 20, 257 })
+  {
+    const TooN::Vector<> b = randomTaps(num_taps, gen);
+    sun::TF_SISO ref(b, TooN::makeVector(1.0));
+    sun::TF_SISO fft(b, TooN::makeVector(1.0));
+    fft.setFFTBlockMode();
+    ASSERT_TRUE(fft.isFFTBlockMode());
+
+    for (std::size_t n : { 3u, 500u, 5000u })
+    {
+      std::vector<double> x(n);
+      for (auto& v : x)
+        v = dist(gen);
+      std::vector<double> expected(n);
+      for (std::size_t i = 0; i < n; i++)
+        expected[i] = ref.apply(x[i]);
+
+      fft.apply_block(x.data(), x.data(), n);
+      for (std::size_t i = 0; i < n; i++)
+        EXPECT_NEAR(x[i], expected[i], ABS_TOL) << "taps " << num_taps << " n " << n << " i " << i;
+
+      const double u = dist(gen);
+      EXPECT_NEAR(fft.apply(u), ref.apply(u), ABS_TOL) << "taps " << num_taps << " n " << n;
+    }
+  }
+}